@@ -22,6 +22,7 @@
  *
  */
 
+#include <string.h>
 #include <glib.h>
 
 #include "gdk-pixbuf.h"
@@ -44,7 +45,9 @@ struct _GdkPixbufScaledAnim
 	gdouble yscale;
 	gdouble tscale;
 
-	GdkPixbuf *current;
+	/* Scaled frames, most recently used first */
+	GList *frames;
+	gsize frames_size;
 };
 
 struct _GdkPixbufScaledAnimIterClass
@@ -63,6 +66,22 @@ struct _GdkPixbufScaledAnimIter
 typedef struct _GdkPixbufScaledAnimIter GdkPixbufScaledAnimIter;
 typedef struct _GdkPixbufScaledAnimIterClass GdkPixbufScaledAnimIterClass;
 
+/* Upper bound on the memory used by cached scaled frames */
+#define SCALED_FRAMES_BUDGET (16 * 1024 * 1024)
+
+typedef struct _ScaledFrame ScaledFrame;
+
+struct _ScaledFrame
+{
+	/* Hash of the source image contents */
+	guint64 hash;
+
+	/* Copy of the source image, to rule out hash collisions */
+	GdkPixbuf *source;
+
+	GdkPixbuf *pixbuf;
+};
+
 GdkPixbufScaledAnim *
 _gdk_pixbuf_scaled_anim_new (GdkPixbufAnimation *anim,
                              gdouble             xscale,
@@ -91,6 +110,29 @@ gdk_pixbuf_scaled_anim_init (GdkPixbufScaledAnim *scaled)
 	scaled->tscale = 1.0;
 }
 
+static gsize
+frame_size (GdkPixbuf *pixbuf)
+{
+	return gdk_pixbuf_get_rowstride (pixbuf) * gdk_pixbuf_get_height (pixbuf);
+}
+
+static void
+drop_last_frame (GdkPixbufScaledAnim *scaled)
+{
+	GList *last;
+	ScaledFrame *frame;
+
+	last = g_list_last (scaled->frames);
+	frame = last->data;
+
+	scaled->frames = g_list_delete_link (scaled->frames, last);
+	scaled->frames_size -= frame_size (frame->source) + frame_size (frame->pixbuf);
+
+	g_object_unref (frame->source);
+	g_object_unref (frame->pixbuf);
+	g_slice_free (ScaledFrame, frame);
+}
+
 static void
 gdk_pixbuf_scaled_anim_finalize (GObject *object)
 {
@@ -101,10 +143,8 @@ gdk_pixbuf_scaled_anim_finalize (GObject *object)
 		scaled->anim = NULL;
 	}
 
-	if (scaled->current) {
-		g_object_unref (scaled->current);
-		scaled->current = NULL;
-	}
+	while (scaled->frames)
+		drop_last_frame (scaled);
 
 	G_OBJECT_CLASS (gdk_pixbuf_scaled_anim_parent_class)->finalize (object);
 }
@@ -117,15 +157,94 @@ is_static_image (GdkPixbufAnimation *anim)
 	return gdk_pixbuf_animation_is_static_image (scaled->anim);
 }	
 
+/* Frames are looked up by content rather than by pixbuf, since
+ * animations may draw every frame into the same pixbuf. The hash
+ * only narrows the search; same_pixels() confirms a match.
+ */
+static guint64
+hash_pixbuf (GdkPixbuf *pixbuf)
+{
+	guint64 hash;
+	const guchar *row;
+	gint width, height, rowstride, row_bytes;
+	gint x, y;
+
+	width = gdk_pixbuf_get_width (pixbuf);
+	height = gdk_pixbuf_get_height (pixbuf);
+	rowstride = gdk_pixbuf_get_rowstride (pixbuf);
+
+	/* 64-bit FNV-1a */
+	hash = G_GUINT64_CONSTANT (14695981039346656037);
+	hash = (hash ^ (guint) width) * G_GUINT64_CONSTANT (1099511628211);
+	hash = (hash ^ (guint) height) * G_GUINT64_CONSTANT (1099511628211);
+
+	row_bytes = width * gdk_pixbuf_get_n_channels (pixbuf);
+	row = gdk_pixbuf_get_pixels (pixbuf);
+	for (y = 0; y < height; y++) {
+		for (x = 0; x < row_bytes; x++)
+			hash = (hash ^ row[x]) * G_GUINT64_CONSTANT (1099511628211);
+		row += rowstride;
+	}
+
+	return hash;
+}
+
+static gboolean
+same_pixels (GdkPixbuf *a,
+             GdkPixbuf *b)
+{
+	const guchar *row_a, *row_b;
+	gint height, row_bytes;
+	gint y;
+
+	if (gdk_pixbuf_get_width (a) != gdk_pixbuf_get_width (b) ||
+	    gdk_pixbuf_get_height (a) != gdk_pixbuf_get_height (b) ||
+	    gdk_pixbuf_get_n_channels (a) != gdk_pixbuf_get_n_channels (b) ||
+	    gdk_pixbuf_get_has_alpha (a) != gdk_pixbuf_get_has_alpha (b))
+		return FALSE;
+
+	height = gdk_pixbuf_get_height (a);
+	row_bytes = gdk_pixbuf_get_width (a) * gdk_pixbuf_get_n_channels (a);
+	row_a = gdk_pixbuf_get_pixels (a);
+	row_b = gdk_pixbuf_get_pixels (b);
+	for (y = 0; y < height; y++) {
+		if (memcmp (row_a, row_b, row_bytes) != 0)
+			return FALSE;
+		row_a += gdk_pixbuf_get_rowstride (a);
+		row_b += gdk_pixbuf_get_rowstride (b);
+	}
+
+	return TRUE;
+}
+
 static GdkPixbuf *
 get_scaled_pixbuf (GdkPixbufScaledAnim *scaled, 
                    GdkPixbuf           *pixbuf)
 {
 	GQuark  quark;
 	gchar **options;
-
-	if (scaled->current) 
-		g_object_unref (scaled->current);
+	GdkPixbuf *result;
+	ScaledFrame *frame;
+	guint64 hash;
+	GList *l;
+
+	if (pixbuf == NULL)
+		return NULL;
+
+	/* A looping animation shows the same frames over and over,
+	 * so reuse the result of scaling them the first time.
+	 */
+	hash = hash_pixbuf (pixbuf);
+	for (l = scaled->frames; l; l = l->next) {
+		frame = l->data;
+
+		if (frame->hash == hash && same_pixels (frame->source, pixbuf)) {
+			scaled->frames = g_list_remove_link (scaled->frames, l);
+			scaled->frames = g_list_concat (l, scaled->frames);
+
+			return frame->pixbuf;
+		}
+	}
 
 	/* Preserve the options associated with the original pixbuf 
 	   (if present), mostly so that client programs can use the
@@ -138,17 +257,41 @@ get_scaled_pixbuf (GdkPixbufScaledAnim *scaled,
 	options = g_object_get_qdata (G_OBJECT (pixbuf), quark);
 
 	/* Get a new scaled pixbuf */
-	scaled->current  = gdk_pixbuf_scale_simple (pixbuf, 
+	result = gdk_pixbuf_scale_simple (pixbuf, 
 			(int) (gdk_pixbuf_get_width (pixbuf) * scaled->xscale + .5),
 			(int) (gdk_pixbuf_get_height (pixbuf) * scaled->yscale + .5),
 			GDK_INTERP_BILINEAR);
 
+	if (result == NULL)
+		return NULL;
+
 	/* Copy the original pixbuf options to the scaled pixbuf */
-        if (options && scaled->current)
-	          g_object_set_qdata_full (G_OBJECT (scaled->current), quark, 
+        if (options)
+	          g_object_set_qdata_full (G_OBJECT (result), quark, 
                                            g_strdupv (options), (GDestroyNotify) g_strfreev);
 
-	return scaled->current;
+	frame = g_slice_new (ScaledFrame);
+	frame->hash = hash;
+	frame->source = gdk_pixbuf_copy (pixbuf);
+	frame->pixbuf = result;
+
+	if (frame->source == NULL) {
+		g_object_unref (result);
+		g_slice_free (ScaledFrame, frame);
+		return NULL;
+	}
+
+	scaled->frames = g_list_prepend (scaled->frames, frame);
+	scaled->frames_size += frame_size (frame->source) + frame_size (result);
+
+	/* Evict the least recently used frames, but always keep
+	 * the one we are returning.
+	 */
+	while (scaled->frames_size > SCALED_FRAMES_BUDGET &&
+	       scaled->frames->next != NULL)
+		drop_last_frame (scaled);
+
+	return result;
 }
 
 static GdkPixbuf *
@@ -27,7 +27,14 @@
 #include "gdk-pixbuf-private.h"
 #include "io-gif-animation.h"
 
+/* Keep the composite of every this many frames to begin with */
+#define CHECKPOINT_INTERVAL 8
+
+/* Upper bound on the memory used by checkpoint composites */
+#define CHECKPOINT_BUDGET (8 * 1024 * 1024)
+
 static void gdk_pixbuf_gif_anim_class_init (GdkPixbufGifAnimClass *klass);
+static void gdk_pixbuf_gif_anim_init       (GdkPixbufGifAnim      *gif_anim);
 static void gdk_pixbuf_gif_anim_finalize   (GObject        *object);
 
 static gboolean                gdk_pixbuf_gif_anim_is_static_image  (GdkPixbufAnimation *animation);
@@ -59,7 +66,7 @@ gdk_pixbuf_gif_anim_get_type (void)
                         NULL,           /* class_data */
                         sizeof (GdkPixbufGifAnim),
                         0,              /* n_preallocs */
-                        (GInstanceInitFunc) NULL,
+                        (GInstanceInitFunc) gdk_pixbuf_gif_anim_init,
                 };
                 
                 object_type = g_type_register_static (GDK_TYPE_PIXBUF_ANIMATION,
@@ -86,6 +93,12 @@ gdk_pixbuf_gif_anim_class_init (GdkPixbufGifAnimClass *klass)
         anim_class->get_iter = gdk_pixbuf_gif_anim_get_iter;
 }
 
+static void
+gdk_pixbuf_gif_anim_init (GdkPixbufGifAnim *gif_anim)
+{
+        gif_anim->checkpoint_interval = CHECKPOINT_INTERVAL;
+}
+
 static void
 gdk_pixbuf_gif_anim_finalize (GObject *object)
 {
@@ -105,6 +118,9 @@ gdk_pixbuf_gif_anim_finalize (GObject *object)
         }
         
         g_list_free (gif_anim->frames);
+
+        if (gif_anim->canvas)
+                g_object_unref (gif_anim->canvas);
         
         G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -250,6 +266,9 @@ gdk_pixbuf_gif_anim_iter_finalize (GObject *object)
 
         iter_clear (iter);
 
+        if (iter->canvas)
+                g_object_unref (iter->canvas);
+
         g_object_unref (iter->gif_anim);
         
         G_OBJECT_CLASS (iter_parent_class)->finalize (object);
@@ -352,243 +371,274 @@ gdk_pixbuf_gif_anim_iter_get_delay_time (GdkPixbufAnimationIter *anim_iter)
                 return -1; /* show last frame forever */
 }
 
-void
-gdk_pixbuf_gif_anim_frame_composite (GdkPixbufGifAnim *gif_anim,
-                                     GdkPixbufFrame   *frame)
-{  
-        GList *link;
+static void
+add_checkpoint (GdkPixbufGifAnim *gif_anim,
+                GdkPixbufFrame   *frame,
+                GdkPixbuf        *canvas)
+{
+        gsize size;
         GList *tmp;
-        
-        link = g_list_find (gif_anim->frames, frame);
-        
-        if (frame->need_recomposite || frame->composited == NULL) {
-                /* For now, to composite we start with the last
-                 * composited frame and composite everything up to
-                 * here.
-                 */
 
-                /* Rewind to last composited frame. */
-                tmp = link;
-                while (tmp != NULL) {
+        frame->composited = gdk_pixbuf_copy (canvas);
+        if (frame->composited == NULL)
+                return;
+
+        gif_anim->n_checkpoints++;
+
+        /* Thin out the checkpoints until they fit the budget again;
+         * frame 0 is always kept so that looping stays cheap.
+         */
+        size = gdk_pixbuf_get_rowstride (canvas) * gdk_pixbuf_get_height (canvas);
+        while (gif_anim->n_checkpoints > 1 &&
+               gif_anim->n_checkpoints * size > CHECKPOINT_BUDGET) {
+                gif_anim->checkpoint_interval *= 2;
+
+                for (tmp = gif_anim->frames; tmp != NULL; tmp = tmp->next) {
                         GdkPixbufFrame *f = tmp->data;
-                        
-                        if (f->need_recomposite) {
-                                if (f->composited) {
-                                        g_object_unref (f->composited);
-                                        f->composited = NULL;
-                                }
-                        }
 
-                        if (f->composited != NULL)
-                                break;
-                        
-                        tmp = tmp->prev;
+                        if (f->composited != NULL &&
+                            f->index % gif_anim->checkpoint_interval != 0) {
+                                g_object_unref (f->composited);
+                                f->composited = NULL;
+                                gif_anim->n_checkpoints--;
+                        }
                 }
+        }
+}
 
-                /* Go forward, compositing all frames up to the current frame */
-                if (tmp == NULL)
-                        tmp = gif_anim->frames;
-                
-                while (tmp != NULL) {
-                        GdkPixbufFrame *f = tmp->data;
-                        gint clipped_width, clipped_height;
+/* Draws the frame at @link onto @canvas, which holds the composite
+ * of the previous frame (its contents are ignored for the first frame).
+ */
+static gboolean
+composite_frame (GdkPixbufGifAnim *gif_anim,
+                 GList            *link,
+                 GdkPixbuf        *canvas)
+{
+        GdkPixbufFrame *f = link->data;
+        gint clipped_width, clipped_height;
 
-                        if (f->pixbuf == NULL)
-                                return;
+        if (f->pixbuf == NULL)
+                return FALSE;
 
-                        clipped_width = MIN (gif_anim->width - f->x_offset, gdk_pixbuf_get_width (f->pixbuf));
-                        clipped_height = MIN (gif_anim->height - f->y_offset, gdk_pixbuf_get_height (f->pixbuf));
-  
-                        if (f->need_recomposite) {
-                                if (f->composited) {
-                                        g_object_unref (f->composited);
-                                        f->composited = NULL;
-                                }
-                        }
-                        
-                        if (f->composited != NULL)
-                                goto next;
-
-                        if (tmp->prev == NULL) {
-                                /* First frame may be smaller than the whole image;
-                                 * if so, we make the area outside it full alpha if the
-                                 * image has alpha, and background color otherwise.
-                                 * GIF spec doesn't actually say what to do about this.
-                                 */
-                                f->composited = gdk_pixbuf_new (GDK_COLORSPACE_RGB,
-                                                                TRUE,
-                                                                8, gif_anim->width, gif_anim->height);
-
-                                if (f->composited == NULL)
-                                        return;
-
-                                /* alpha gets dumped if f->composited has no alpha */
-                                
-                                gdk_pixbuf_fill (f->composited,
+        clipped_width = MIN (gif_anim->width - f->x_offset, gdk_pixbuf_get_width (f->pixbuf));
+        clipped_height = MIN (gif_anim->height - f->y_offset, gdk_pixbuf_get_height (f->pixbuf));
+
+        if (link->prev == NULL) {
+                /* First frame may be smaller than the whole image;
+                 * if so, we make the area outside it full alpha if the
+                 * image has alpha, and background color otherwise.
+                 * GIF spec doesn't actually say what to do about this.
+                 */
+                gdk_pixbuf_fill (canvas,
+                                 (gif_anim->bg_red << 24) |
+                                 (gif_anim->bg_green << 16) |
+                                 (gif_anim->bg_blue << 8));
+
+                if (f->action == GDK_PIXBUF_FRAME_REVERT)
+                        g_warning ("First frame of GIF has bad dispose mode, GIF loader should not have loaded this image");
+        } else {
+                GdkPixbufFrame *prev_frame;
+                gint prev_clipped_width;
+                gint prev_clipped_height;
+
+                prev_frame = link->prev->data;
+
+                prev_clipped_width = MIN (gif_anim->width - prev_frame->x_offset, gdk_pixbuf_get_width (prev_frame->pixbuf));
+                prev_clipped_height = MIN (gif_anim->height - prev_frame->y_offset, gdk_pixbuf_get_height (prev_frame->pixbuf));
+
+                /* Turn the canvas into what we should have after the
+                 * previous frame
+                 */
+
+                if (prev_frame->action == GDK_PIXBUF_FRAME_RETAIN) {
+                        /* Nothing to do */
+                } else if (prev_frame->action == GDK_PIXBUF_FRAME_DISPOSE) {
+                        if (prev_clipped_width > 0 && prev_clipped_height > 0) {
+                                /* Clear area of previous frame to background */
+                                GdkPixbuf *area;
+
+                                area = gdk_pixbuf_new_subpixbuf (canvas,
+                                                                 prev_frame->x_offset,
+                                                                 prev_frame->y_offset,
+                                                                 prev_clipped_width,
+                                                                 prev_clipped_height);
+
+                                if (area == NULL)
+                                        return FALSE;
+
+                                gdk_pixbuf_fill (area,
                                                  (gif_anim->bg_red << 24) |
                                                  (gif_anim->bg_green << 16) |
                                                  (gif_anim->bg_blue << 8));
 
-                                if (clipped_width > 0 && clipped_height > 0)
-                                        gdk_pixbuf_composite (f->pixbuf,
-                                                              f->composited,
-                                                              f->x_offset,
-                                                              f->y_offset,
-                                                              clipped_width,
-                                                              clipped_height,
-                                                              f->x_offset, f->y_offset,
-                                                              1.0, 1.0,
-                                                              GDK_INTERP_BILINEAR,
-                                                              255);
-                                
-                                if (f->action == GDK_PIXBUF_FRAME_REVERT)
-                                        g_warning ("First frame of GIF has bad dispose mode, GIF loader should not have loaded this image");
-
-                                f->need_recomposite = FALSE;
-                        } else {
-                                GdkPixbufFrame *prev_frame;
-                                gint prev_clipped_width;
-                                gint prev_clipped_height;
-                                
-                                prev_frame = tmp->prev->data;
-
-                                prev_clipped_width = MIN (gif_anim->width - prev_frame->x_offset, gdk_pixbuf_get_width (prev_frame->pixbuf));
-                                prev_clipped_height = MIN (gif_anim->height - prev_frame->y_offset, gdk_pixbuf_get_height (prev_frame->pixbuf));
-
-                                /* Init f->composited with what we should have after the previous
-                                 * frame
-                                 */
-                                
-                                if (prev_frame->action == GDK_PIXBUF_FRAME_RETAIN) {
-                                        f->composited = gdk_pixbuf_copy (prev_frame->composited);
-
-                                        if (f->composited == NULL)
-                                                return;
-                                        
-                                } else if (prev_frame->action == GDK_PIXBUF_FRAME_DISPOSE) {
-                                        f->composited = gdk_pixbuf_copy (prev_frame->composited);
-
-                                        if (f->composited == NULL)
-                                                return;
-
-                                        if (prev_clipped_width > 0 && prev_clipped_height > 0) {
-                                                /* Clear area of previous frame to background */
-                                                GdkPixbuf *area;
-
-                                                area = gdk_pixbuf_new_subpixbuf (f->composited,
-                                                                                 prev_frame->x_offset,
-                                                                                 prev_frame->y_offset,
-                                                                                 prev_clipped_width,
-                                                                                 prev_clipped_height);
-
-                                                if (area == NULL)
-                                                        return;
-                                                
-                                                gdk_pixbuf_fill (area,
-                                                                 (gif_anim->bg_red << 24) |
-                                                                 (gif_anim->bg_green << 16) |
-                                                                 (gif_anim->bg_blue << 8));
-                                                
-                                                g_object_unref (area);
-                                        }                                        
-                                } else if (prev_frame->action == GDK_PIXBUF_FRAME_REVERT) {
-                                        f->composited = gdk_pixbuf_copy (prev_frame->composited);
-
-                                        if (f->composited == NULL)
-                                                return;
-
-                                        if (prev_frame->revert != NULL &&
-                                            prev_clipped_width > 0 && prev_clipped_height > 0) {
-                                                /* Copy in the revert frame */
-                                                gdk_pixbuf_copy_area (prev_frame->revert,
-                                                                      0, 0,
-                                                                      gdk_pixbuf_get_width (prev_frame->revert),
-                                                                      gdk_pixbuf_get_height (prev_frame->revert),
-                                                                      f->composited,
-                                                                      prev_frame->x_offset,
-                                                                      prev_frame->y_offset);
-                                        }
-                                } else {
-                                        g_warning ("Unknown revert action for GIF frame");
-                                }
-
-                                if (f->revert == NULL &&
-                                    f->action == GDK_PIXBUF_FRAME_REVERT) {
-                                        if (clipped_width > 0 && clipped_height > 0) {
-                                                /* We need to save the contents before compositing */
-                                                GdkPixbuf *area;
-                                                
-                                                area = gdk_pixbuf_new_subpixbuf (f->composited,
-                                                                                 f->x_offset,
-                                                                                 f->y_offset,
-                                                                                 clipped_width,
-                                                                                 clipped_height);
-                                            
-                                                if (area == NULL)
-                                                        return;
-                                                
-                                                f->revert = gdk_pixbuf_copy (area);
-
-                                                g_object_unref (area);
-
-                                                if (f->revert == NULL)
-                                                        return;
-                                        }
-                                }
-
-                                if (clipped_width > 0 && clipped_height > 0 &&
-                                    f->pixbuf != NULL && f->composited != NULL) {
-                                        /* Put current frame onto f->composited */
-                                        gdk_pixbuf_composite (f->pixbuf,
-                                                              f->composited,
-                                                              f->x_offset,
-                                                              f->y_offset,
-                                                              clipped_width,
-                                                              clipped_height,
-                                                              f->x_offset, f->y_offset,
-                                                              1.0, 1.0,
-                                                              GDK_INTERP_NEAREST,
-                                                              255);
-                                }
-                        
-                                f->need_recomposite = FALSE;
+                                g_object_unref (area);
+                        }
+                } else if (prev_frame->action == GDK_PIXBUF_FRAME_REVERT) {
+                        if (prev_frame->revert != NULL &&
+                            prev_clipped_width > 0 && prev_clipped_height > 0) {
+                                /* Copy in the revert frame */
+                                gdk_pixbuf_copy_area (prev_frame->revert,
+                                                      0, 0,
+                                                      gdk_pixbuf_get_width (prev_frame->revert),
+                                                      gdk_pixbuf_get_height (prev_frame->revert),
+                                                      canvas,
+                                                      prev_frame->x_offset,
+                                                      prev_frame->y_offset);
+                        }
+                } else {
+                        g_warning ("Unknown revert action for GIF frame");
+                }
+
+                if (f->revert == NULL &&
+                    f->action == GDK_PIXBUF_FRAME_REVERT) {
+                        if (clipped_width > 0 && clipped_height > 0) {
+                                /* We need to save the contents before compositing */
+                                GdkPixbuf *area;
+
+                                area = gdk_pixbuf_new_subpixbuf (canvas,
+                                                                 f->x_offset,
+                                                                 f->y_offset,
+                                                                 clipped_width,
+                                                                 clipped_height);
+
+                                if (area == NULL)
+                                        return FALSE;
+
+                                f->revert = gdk_pixbuf_copy (area);
+
+                                g_object_unref (area);
+
+                                if (f->revert == NULL)
+                                        return FALSE;
                         }
-                        
-                next:
-                        if (tmp == link)
-                                break;
-                        
-                        tmp = tmp->next;
                 }
         }
+
+        if (clipped_width > 0 && clipped_height > 0) {
+                /* Put current frame onto the canvas */
+                gdk_pixbuf_composite (f->pixbuf,
+                                      canvas,
+                                      f->x_offset,
+                                      f->y_offset,
+                                      clipped_width,
+                                      clipped_height,
+                                      f->x_offset, f->y_offset,
+                                      1.0, 1.0,
+                                      GDK_INTERP_NEAREST,
+                                      255);
+        }
+
+        return TRUE;
+}
+
+/* Returns the composite image for the frame at @link. Unless the
+ * frame is a checkpoint, this is *canvas, which is brought forward
+ * from its previous contents (*canvas_link) or from the nearest
+ * checkpoint, and created if needed. Returns NULL if out of memory.
+ */
+GdkPixbuf *
+gdk_pixbuf_gif_anim_frame_composite (GdkPixbufGifAnim *gif_anim,
+                                     GList            *link,
+                                     GdkPixbuf       **canvas,
+                                     GList           **canvas_link)
+{
+        GdkPixbufFrame *frame = link->data;
+        GList *start;
+        GList *tmp;
+
+        if (frame->composited != NULL && !frame->need_recomposite)
+                return frame->composited;
+
+        if (*canvas == NULL) {
+                *canvas = gdk_pixbuf_new (GDK_COLORSPACE_RGB,
+                                          TRUE,
+                                          8, gif_anim->width, gif_anim->height);
+                *canvas_link = NULL;
+
+                if (*canvas == NULL)
+                        return NULL;
+        }
+
+        if (*canvas_link == link)
+                return *canvas;
+
+        /* Rewind to whichever is closer: the frame already on the
+         * canvas, or the last checkpoint.
+         */
+        start = link;
+        for (tmp = link; tmp != NULL; tmp = tmp->prev) {
+                GdkPixbufFrame *f = tmp->data;
+
+                if (tmp == *canvas_link)
+                        break;
+
+                if (f->need_recomposite && f->composited != NULL) {
+                        g_object_unref (f->composited);
+                        f->composited = NULL;
+                        gif_anim->n_checkpoints--;
+                }
+
+                if (f->composited != NULL) {
+                        gdk_pixbuf_copy_area (f->composited,
+                                              0, 0,
+                                              gif_anim->width, gif_anim->height,
+                                              *canvas, 0, 0);
+                        break;
+                }
+
+                start = tmp;
+        }
+
+        /* Go forward, compositing all frames up to the requested one */
+        *canvas_link = NULL;
+        for (tmp = start; ; tmp = tmp->next) {
+                GdkPixbufFrame *f = tmp->data;
+
+                if (!composite_frame (gif_anim, tmp, *canvas))
+                        return NULL;
+
+                f->need_recomposite = FALSE;
+
+                if (f->index % gif_anim->checkpoint_interval == 0)
+                        add_checkpoint (gif_anim, f, *canvas);
+
+                if (tmp == link)
+                        break;
+        }
+
+        /* The frame still being loaded will change under us */
+        if (!(gif_anim->loading && link->next == NULL))
+                *canvas_link = link;
+
+        return *canvas;
 }
 
 GdkPixbuf*
 gdk_pixbuf_gif_anim_iter_get_pixbuf (GdkPixbufAnimationIter *anim_iter)
 {
         GdkPixbufGifAnimIter *iter;
-        GdkPixbufFrame *frame;
+        GList *link;
         
         iter = GDK_PIXBUF_GIF_ANIM_ITER (anim_iter);
 
-        frame = iter->current_frame ? iter->current_frame->data : g_list_last (iter->gif_anim->frames)->data;
+        link = iter->current_frame ? iter->current_frame : g_list_last (iter->gif_anim->frames);
 
 #if 0
-        if (FALSE && frame)
+        if (FALSE && link)
           g_print ("current frame %d dispose mode %d  %d x %d\n",
                    g_list_index (iter->gif_anim->frames,
-                                 frame),
-                   frame->action,
-                   gdk_pixbuf_get_width (frame->pixbuf),
-                   gdk_pixbuf_get_height (frame->pixbuf));
+                                 link->data),
+                   ((GdkPixbufFrame *)link->data)->action,
+                   gdk_pixbuf_get_width (((GdkPixbufFrame *)link->data)->pixbuf),
+                   gdk_pixbuf_get_height (((GdkPixbufFrame *)link->data)->pixbuf));
 #endif
         
-        if (frame == NULL)
+        if (link == NULL)
                 return NULL;
 
-        gdk_pixbuf_gif_anim_frame_composite (iter->gif_anim, frame);
-        
-        return frame->composited;
+        return gdk_pixbuf_gif_anim_frame_composite (iter->gif_anim, link,
+                                                    &iter->canvas,
+                                                    &iter->canvas_link);
 }
 
 static gboolean
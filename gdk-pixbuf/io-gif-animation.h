@@ -79,6 +79,19 @@ struct _GdkPixbufGifAnim {
         
         int loop;
         gboolean loading;
+
+        /* Only every checkpoint_interval'th frame keeps its
+         * composite image; the interval doubles whenever the
+         * checkpoints would exceed the memory budget.
+         */
+        int checkpoint_interval;
+        int n_checkpoints;
+
+        /* Scratch composite used by the loader, holding the
+         * image for canvas_link (or NULL if it is not valid)
+         */
+        GdkPixbuf *canvas;
+        GList *canvas_link;
 };
 
 struct _GdkPixbufGifAnimClass {
@@ -116,6 +129,12 @@ struct _GdkPixbufGifAnimIter {
         GList              *current_frame;
         
         gint                first_loop_slowness;
+
+        /* Composite image for canvas_link, updated in place as
+         * the iterator moves forward
+         */
+        GdkPixbuf          *canvas;
+        GList              *canvas_link;
 };
 
 struct _GdkPixbufGifAnimIterClass {
@@ -135,6 +154,9 @@ struct _GdkPixbufFrame {
         int x_offset;
 	int y_offset;
 
+        /* Position of this frame in the animation */
+        int index;
+
 	/* Frame duration in ms */
 	int delay_time;
 
@@ -152,12 +174,9 @@ struct _GdkPixbufFrame {
         /* TRUE if the background for this frame is transparent */
         gboolean bg_transparent;
         
-        /* The below reflects the "use hell of a lot of RAM"
-         * philosophy of coding
-         */
-        
         /* Cached composite image (the image you actually display
-         * for this frame)
+         * for this frame); only kept for checkpoint frames, other
+         * frames are composited forward from the nearest checkpoint
          */
         GdkPixbuf *composited;
 
@@ -169,7 +188,9 @@ struct _GdkPixbufFrame {
         GdkPixbuf *revert;
 };
 
-void gdk_pixbuf_gif_anim_frame_composite (GdkPixbufGifAnim *gif_anim,
-                                          GdkPixbufFrame   *frame);
+GdkPixbuf *gdk_pixbuf_gif_anim_frame_composite (GdkPixbufGifAnim *gif_anim,
+                                                GList            *link,
+                                                GdkPixbuf       **canvas,
+                                                GList           **canvas_link);
 
 #endif
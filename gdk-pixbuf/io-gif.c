@@ -907,6 +907,7 @@ gif_get_lzw (GifContext *context)
 
                 context->frame->bg_transparent = (context->gif89.transparent == context->background_index);
                 
+                context->frame->index = context->animation->n_frames;
                 context->animation->n_frames ++;
                 context->animation->frames = g_list_append (context->animation->frames, context->frame);
 
@@ -924,17 +925,18 @@ gif_get_lzw (GifContext *context)
                 } else {
                         /* Otherwise init frame with last frame */
                         GList *link;
-                        GdkPixbufFrame *prev_frame;
+                        GdkPixbuf *composited;
                         gint x, y, w, h;
                         
                         link = g_list_find (context->animation->frames, context->frame);
 
-                        prev_frame = link->prev->data;
-
-                        gdk_pixbuf_gif_anim_frame_composite (context->animation, prev_frame);
+                        composited = gdk_pixbuf_gif_anim_frame_composite (context->animation,
+                                                                          link->prev,
+                                                                          &context->animation->canvas,
+                                                                          &context->animation->canvas_link);
 
                         /* Composite failed */
-                        if (prev_frame->composited == NULL) {
+                        if (composited == NULL) {
                                 GdkPixbufFrame *frame = NULL;
                                 link = g_list_first (context->animation->frames);
                                 while (link != NULL) {
@@ -953,6 +955,7 @@ gif_get_lzw (GifContext *context)
                                 
                                 g_list_free (context->animation->frames);
                                 context->animation->frames = NULL;
+                                context->animation->canvas_link = NULL;
                                 
                                 g_set_error_literal (context->error,
                                                      GDK_PIXBUF_ERROR,
@@ -966,7 +969,7 @@ gif_get_lzw (GifContext *context)
                         w = gdk_pixbuf_get_width (context->frame->pixbuf);
                         h = gdk_pixbuf_get_height (context->frame->pixbuf);
                         if (clip_frame (context, &x, &y, &w, &h))
-                                gdk_pixbuf_copy_area (prev_frame->composited,
+                                gdk_pixbuf_copy_area (composited,
                                                       x, y, w, h,
                                                       context->frame->pixbuf,
                                                       0, 0);
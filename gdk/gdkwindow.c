@@ -2503,14 +2503,198 @@ static GSList *update_windows = NULL;
 static guint update_idle = 0;
 static gboolean debug_updates = FALSE;
 
+/* When update_idle is a timeout waiting for a frame clock,
+ * the time at which it fires
+ */
+static gboolean update_idle_is_timeout = FALSE;
+static gdouble update_idle_time = 0.0;
+
+/* Frame clocks
+ *
+ * A toplevel with a frame rate has the updates of its windows
+ * processed at most once per frame interval. Each frame first runs
+ * the layout function registered by GTK+, then paints. Because the
+ * frame is dispatched at GDK_PRIORITY_REDRAW, pending events are
+ * always processed before it.
+ */
+typedef struct _GdkFrameClock GdkFrameClock;
+
+struct _GdkFrameClock
+{
+  gint     rate;
+  gdouble  interval;
+  gdouble  last_frame;
+  gdouble  paint_time;
+  gdouble  total_layout_time;
+  gdouble  total_paint_time;
+  gdouble  total_interval;
+  GdkFrameTimings timings;
+};
+
+static GQuark quark_frame_clock = 0;
+static gint default_frame_rate = 0;
+static GdkFrameLayoutFunc frame_layout_func = NULL;
+static gdouble frame_layout_time = 0.0;
+
+static gdouble
+get_current_time (void)
+{
+  GTimeVal tv;
+
+  g_get_current_time (&tv);
+
+  return tv.tv_sec + tv.tv_usec / (gdouble) G_USEC_PER_SEC;
+}
+
+static void
+frame_clock_update_interval (GdkFrameClock *clock,
+                             GdkWindow     *toplevel)
+{
+  GdkWindowObject *private = (GdkWindowObject *)toplevel;
+  GdkWindowImplIface *iface;
+  gint rate = clock->rate;
+
+  if (rate < 0)
+    {
+      /* Approximate the vertical blank with the refresh rate */
+      rate = 0;
+      iface = GDK_WINDOW_IMPL_GET_IFACE (private->impl);
+      if (iface->get_refresh_rate && !GDK_WINDOW_DESTROYED (toplevel))
+        rate = iface->get_refresh_rate (toplevel);
+      if (rate <= 0)
+        rate = 60;
+    }
+
+  clock->interval = rate > 0 ? 1.0 / rate : 0.0;
+}
+
+static GdkFrameClock *
+frame_clock_get (GdkWindow *window,
+                 gboolean   create)
+{
+  static gboolean initialized = FALSE;
+  GdkWindow *toplevel;
+  GdkFrameClock *clock;
+
+  if (!initialized)
+    {
+      const gchar *rate = g_getenv ("GDK_FRAME_RATE");
+
+      if (rate)
+        default_frame_rate = g_str_equal (rate, "vblank") ?
+          GDK_FRAME_RATE_VBLANK : (gint) g_ascii_strtoll (rate, NULL, 10);
+      quark_frame_clock = g_quark_from_static_string ("gdk-frame-clock");
+      initialized = TRUE;
+    }
+
+  toplevel = gdk_window_get_toplevel (window);
+  clock = g_object_get_qdata (G_OBJECT (toplevel), quark_frame_clock);
+
+  if (!clock && (create || default_frame_rate != 0))
+    {
+      clock = g_new0 (GdkFrameClock, 1);
+      clock->rate = default_frame_rate;
+      frame_clock_update_interval (clock, toplevel);
+      g_object_set_qdata_full (G_OBJECT (toplevel), quark_frame_clock,
+                               clock, g_free);
+    }
+
+  return clock;
+}
+
+/* Returns the time in seconds until the next frame of @clock */
+static gdouble
+frame_clock_get_delay (GdkFrameClock *clock,
+                       gdouble        now)
+{
+  gdouble delay;
+
+  if (!clock || clock->interval == 0.0 || clock->last_frame == 0.0)
+    return 0.0;
+
+  delay = clock->last_frame + clock->interval - now;
+
+  /* Timeouts have millisecond granularity */
+  if (delay < 0.001)
+    return 0.0;
+
+  /* The clock might have been set back */
+  return MIN (delay, clock->interval);
+}
+
+static void
+frame_clock_end_frame (GdkFrameClock *clock,
+                       gdouble        now)
+{
+  GdkFrameTimings *timings = &clock->timings;
+
+  if (clock->last_frame != 0.0 && now > clock->last_frame)
+    clock->total_interval += now - clock->last_frame;
+
+  timings->frame_count++;
+  timings->layout_time = frame_layout_time;
+  timings->paint_time = clock->paint_time;
+
+  clock->total_layout_time += frame_layout_time;
+  clock->total_paint_time += clock->paint_time;
+
+  timings->average_layout_time = clock->total_layout_time / timings->frame_count;
+  timings->average_paint_time = clock->total_paint_time / timings->frame_count;
+  if (timings->frame_count > 1)
+    timings->frame_interval = clock->total_interval / (timings->frame_count - 1);
+
+  clock->last_frame = now;
+  clock->paint_time = 0.0;
+}
+
 static gboolean
 gdk_window_update_idle (gpointer data)
 {
+  gdouble start;
+
+  if (frame_layout_func)
+    {
+      start = get_current_time ();
+      frame_layout_func ();
+      frame_layout_time = get_current_time () - start;
+    }
+
   gdk_window_process_all_updates ();
+  frame_layout_time = 0.0;
   
   return FALSE;
 }
 
+/* Makes sure the update idle runs in @delay seconds at the latest */
+static void
+gdk_window_schedule_update_idle (gdouble delay)
+{
+  gdouble now = get_current_time ();
+
+  if (update_idle)
+    {
+      if (!update_idle_is_timeout || update_idle_time <= now + delay)
+        return;
+
+      g_source_remove (update_idle);
+    }
+
+  if (delay > 0.0)
+    {
+      update_idle = gdk_threads_add_timeout_full (GDK_PRIORITY_REDRAW,
+                                                  (guint) (delay * 1000 + 0.5),
+                                                  gdk_window_update_idle, NULL, NULL);
+      update_idle_is_timeout = TRUE;
+      update_idle_time = now + delay;
+    }
+  else
+    {
+      update_idle = gdk_threads_add_idle_full (GDK_PRIORITY_REDRAW,
+                                               gdk_window_update_idle, NULL, NULL);
+      update_idle_is_timeout = FALSE;
+    }
+}
+
 static gboolean
 gdk_window_is_toplevel_frozen (GdkWindow *window)
 {
@@ -2524,16 +2708,18 @@ gdk_window_is_toplevel_frozen (GdkWindow *window)
 static void
 gdk_window_schedule_update (GdkWindow *window)
 {
+  gdouble delay = 0.0;
+
   if (window &&
       (GDK_WINDOW_OBJECT (window)->update_freeze_count ||
        gdk_window_is_toplevel_frozen (window)))
     return;
 
-  if (!update_idle)
-    {
-      update_idle = gdk_threads_add_idle_full (GDK_PRIORITY_REDRAW,
-				     gdk_window_update_idle, NULL, NULL);
-    }
+  if (window)
+    delay = frame_clock_get_delay (frame_clock_get (window, FALSE),
+                                   get_current_time ());
+
+  gdk_window_schedule_update_idle (delay);
 }
 
 static void
@@ -2643,6 +2829,8 @@ gdk_window_process_all_updates (void)
 {
   GSList *old_update_windows = update_windows;
   GSList *tmp_list = update_windows;
+  GSList *frame_toplevels = NULL;
+  gdouble now, next_frame = 0.0;
 
   if (update_idle)
     g_source_remove (update_idle);
@@ -2652,15 +2840,39 @@ gdk_window_process_all_updates (void)
 
   g_slist_foreach (old_update_windows, (GFunc)g_object_ref, NULL);
   
+  now = get_current_time ();
+
   while (tmp_list)
     {
       GdkWindowObject *private = (GdkWindowObject *)tmp_list->data;
       
       if (!GDK_WINDOW_DESTROYED (tmp_list->data))
         {
+	  GdkFrameClock *clock = frame_clock_get (tmp_list->data, FALSE);
+	  gdouble delay = frame_clock_get_delay (clock, now);
+
 	  if (private->update_freeze_count ||
 	      gdk_window_is_toplevel_frozen (tmp_list->data))
 	    update_windows = g_slist_prepend (update_windows, private);
+	  else if (delay > 0.0)
+	    {
+	      /* Wait for the next frame of the toplevel */
+	      update_windows = g_slist_prepend (update_windows, private);
+	      if (next_frame == 0.0 || delay < next_frame)
+		next_frame = delay;
+	    }
+	  else if (clock)
+	    {
+	      GdkWindow *toplevel = gdk_window_get_toplevel (tmp_list->data);
+	      gdouble start = get_current_time ();
+
+	      if (!g_slist_find (frame_toplevels, toplevel))
+		frame_toplevels = g_slist_prepend (frame_toplevels,
+						   g_object_ref (toplevel));
+
+	      gdk_window_process_updates_internal (tmp_list->data);
+	      clock->paint_time += get_current_time () - start;
+	    }
 	  else
 	    gdk_window_process_updates_internal (tmp_list->data);
 	}
@@ -2671,6 +2883,21 @@ gdk_window_process_all_updates (void)
 
   g_slist_free (old_update_windows);
 
+  for (tmp_list = frame_toplevels; tmp_list; tmp_list = tmp_list->next)
+    {
+      GdkFrameClock *clock;
+
+      clock = g_object_get_qdata (G_OBJECT (tmp_list->data), quark_frame_clock);
+      if (clock)
+	frame_clock_end_frame (clock, now);
+
+      g_object_unref (tmp_list->data);
+    }
+  g_slist_free (frame_toplevels);
+
+  if (next_frame > 0.0)
+    gdk_window_schedule_update_idle (next_frame);
+
   flush_all_displays ();
 }
 
@@ -3068,6 +3295,191 @@ gdk_window_thaw_updates (GdkWindow *window)
     gdk_window_schedule_update (window);
 }
 
+/**
+ * gdk_window_set_frame_rate:
+ * @window: a #GdkWindow
+ * @frames_per_second: the frame rate, 0 or %GDK_FRAME_RATE_VBLANK
+ *
+ * Gives the toplevel of @window a frame clock. Once the toplevel has
+ * a frame rate, the updates of its windows are processed at most
+ * @frames_per_second times per second, including the updates
+ * processed by gdk_window_process_all_updates(). Updates that are
+ * queued in between are painted together at the next frame.
+ * Explicit calls to gdk_window_process_updates() are not delayed.
+ *
+ * %GDK_FRAME_RATE_VBLANK approximates the vertical blank of the
+ * screen with its refresh rate, or 60 frames per second if the
+ * refresh rate is not known. A frame rate of 0 processes updates as
+ * soon as possible, which is the default unless the
+ * <envar>GDK_FRAME_RATE</envar> environment variable gives a frame
+ * rate or the string "vblank".
+ *
+ * The frame clock also keeps the statistics returned by
+ * gdk_window_get_frame_timings().
+ *
+ * Since: 2.14
+ **/
+void
+gdk_window_set_frame_rate (GdkWindow *window,
+                           gint       frames_per_second)
+{
+  GdkFrameClock *clock;
+
+  g_return_if_fail (GDK_IS_WINDOW (window));
+  g_return_if_fail (frames_per_second >= GDK_FRAME_RATE_VBLANK);
+
+  clock = frame_clock_get (window, TRUE);
+  clock->rate = frames_per_second;
+  frame_clock_update_interval (clock, gdk_window_get_toplevel (window));
+
+  if (update_windows)
+    gdk_window_schedule_update (window);
+}
+
+/**
+ * gdk_window_get_frame_rate:
+ * @window: a #GdkWindow
+ *
+ * Gets the frame rate set with gdk_window_set_frame_rate() on the
+ * toplevel of @window.
+ *
+ * Return value: the frame rate, 0 or %GDK_FRAME_RATE_VBLANK
+ *
+ * Since: 2.14
+ **/
+gint
+gdk_window_get_frame_rate (GdkWindow *window)
+{
+  GdkFrameClock *clock;
+
+  g_return_val_if_fail (GDK_IS_WINDOW (window), 0);
+
+  clock = frame_clock_get (window, FALSE);
+
+  return clock ? clock->rate : 0;
+}
+
+/**
+ * gdk_window_get_frame_timings:
+ * @window: a #GdkWindow
+ * @timings: return location for the statistics
+ *
+ * Gets the statistics of the frame clock of the toplevel of @window.
+ * The layout time is the time spent in resizing widgets at the start
+ * of a frame, the paint time is the time spent processing the
+ * updates of the windows of the toplevel. All times are in seconds.
+ *
+ * Return value: %TRUE if the toplevel of @window has a frame clock,
+ *   see gdk_window_set_frame_rate()
+ *
+ * Since: 2.14
+ **/
+gboolean
+gdk_window_get_frame_timings (GdkWindow       *window,
+                              GdkFrameTimings *timings)
+{
+  GdkFrameClock *clock;
+
+  g_return_val_if_fail (GDK_IS_WINDOW (window), FALSE);
+  g_return_val_if_fail (timings != NULL, FALSE);
+
+  clock = frame_clock_get (window, FALSE);
+  if (!clock)
+    return FALSE;
+
+  *timings = clock->timings;
+
+  return TRUE;
+}
+
+/**
+ * gdk_window_set_frame_layout_func_libgtk_only:
+ * @func: the function to run at the start of each frame, or %NULL
+ *
+ * Sets the function that lays out widgets before the windows are
+ * painted in a frame, see gdk_window_set_frame_rate().
+ *
+ * This function is not part of the GDK public API and is only
+ * for use by GTK+.
+ **/
+void
+gdk_window_set_frame_layout_func_libgtk_only (GdkFrameLayoutFunc func)
+{
+  frame_layout_func = func;
+}
+
+/**
+ * gdk_window_schedule_frame_libgtk_only:
+ * @window: a #GdkWindow
+ *
+ * Makes sure a frame of the toplevel of @window is dispatched
+ * even if no window needs to be painted, so that the layout
+ * function runs.
+ *
+ * This function is not part of the GDK public API and is only
+ * for use by GTK+.
+ **/
+void
+gdk_window_schedule_frame_libgtk_only (GdkWindow *window)
+{
+  g_return_if_fail (GDK_IS_WINDOW (window));
+
+  gdk_window_schedule_update_idle (frame_clock_get_delay (frame_clock_get (window, FALSE),
+                                                          get_current_time ()));
+}
+
+/**
+ * gdk_window_begin_geometry_batch:
+ * @window: a #GdkWindow
+ *
+ * Starts collecting the moves and resizes of child windows on the
+ * display of @window, so that they are sent to the windowing system
+ * as one set of requests when gdk_window_end_geometry_batch() is
+ * called. A window that is moved several times within the batch is
+ * only moved once. Requests that depend on the position of a window,
+ * such as showing, raising or scrolling it, still happen in order.
+ *
+ * Batches can be nested; each call must be matched by a call to
+ * gdk_window_end_geometry_batch(). Backends that cannot batch
+ * geometry changes ignore this call.
+ *
+ * Since: 2.14
+ **/
+void
+gdk_window_begin_geometry_batch (GdkWindow *window)
+{
+  GdkWindowObject *private = (GdkWindowObject *)window;
+  GdkWindowImplIface *iface;
+
+  g_return_if_fail (GDK_IS_WINDOW (window));
+
+  iface = GDK_WINDOW_IMPL_GET_IFACE (private->impl);
+  if (iface->begin_geometry_batch)
+    iface->begin_geometry_batch (window);
+}
+
+/**
+ * gdk_window_end_geometry_batch:
+ * @window: a #GdkWindow
+ *
+ * Ends a batch started with gdk_window_begin_geometry_batch(). When
+ * the outermost batch ends, the collected requests are sent.
+ *
+ * Since: 2.14
+ **/
+void
+gdk_window_end_geometry_batch (GdkWindow *window)
+{
+  GdkWindowObject *private = (GdkWindowObject *)window;
+  GdkWindowImplIface *iface;
+
+  g_return_if_fail (GDK_IS_WINDOW (window));
+
+  iface = GDK_WINDOW_IMPL_GET_IFACE (private->impl);
+  if (iface->end_geometry_batch)
+    iface->end_geometry_batch (window);
+}
+
 /**
  * gdk_window_freeze_toplevel_updates_libgtk_only:
  * @window: a #GdkWindow
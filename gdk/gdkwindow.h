@@ -39,6 +39,7 @@ G_BEGIN_DECLS
 
 typedef struct _GdkGeometry           GdkGeometry;
 typedef struct _GdkWindowAttr	      GdkWindowAttr;
+typedef struct _GdkFrameTimings	      GdkFrameTimings;
 typedef struct _GdkPointerHooks	      GdkPointerHooks;
 typedef struct _GdkWindowRedirect     GdkWindowRedirect;
 
@@ -204,6 +205,19 @@ typedef enum
   GDK_WINDOW_EDGE_SOUTH_EAST  
 } GdkWindowEdge;
 
+/* Statistics of a frame clock, see gdk_window_set_frame_rate().
+ * Times are in seconds.
+ */
+struct _GdkFrameTimings
+{
+  guint   frame_count;
+  gdouble frame_interval;
+  gdouble layout_time;
+  gdouble paint_time;
+  gdouble average_layout_time;
+  gdouble average_paint_time;
+};
+
 struct _GdkWindowAttr
 {
   gchar *title;
@@ -614,6 +628,22 @@ GdkRegion *gdk_window_get_update_area     (GdkWindow    *window);
 void       gdk_window_freeze_updates      (GdkWindow    *window);
 void       gdk_window_thaw_updates        (GdkWindow    *window);
 
+void       gdk_window_begin_geometry_batch (GdkWindow   *window);
+void       gdk_window_end_geometry_batch   (GdkWindow   *window);
+
+#define GDK_FRAME_RATE_VBLANK (-1)
+
+void       gdk_window_set_frame_rate      (GdkWindow       *window,
+                                           gint             frames_per_second);
+gint       gdk_window_get_frame_rate      (GdkWindow       *window);
+gboolean   gdk_window_get_frame_timings   (GdkWindow       *window,
+                                           GdkFrameTimings *timings);
+
+typedef void (*GdkFrameLayoutFunc) (void);
+
+void       gdk_window_set_frame_layout_func_libgtk_only (GdkFrameLayoutFunc func);
+void       gdk_window_schedule_frame_libgtk_only        (GdkWindow         *window);
+
 void       gdk_window_freeze_toplevel_updates_libgtk_only (GdkWindow *window);
 void       gdk_window_thaw_toplevel_updates_libgtk_only   (GdkWindow *window);
 #ifdef MAEMO_CHANGES
@@ -114,6 +114,11 @@ struct _GdkWindowImplIface
 
   gboolean     (* set_static_gravities) (GdkWindow       *window,
 				         gboolean         use_static);
+
+  /* Optional */
+  void         (* begin_geometry_batch) (GdkWindow       *window);
+  void         (* end_geometry_batch)   (GdkWindow       *window);
+  gint         (* get_refresh_rate)     (GdkWindow       *window);
 };
 
 /* Interface Functions */
@@ -157,6 +157,7 @@ gdk_display_open (const gchar *display_name)
   gint argc;
   gchar *argv[1];
   const char *sm_client_id;
+  const gchar *cache_size;
   
   XClassHint *class_hint;
   gulong pid;
@@ -180,6 +181,10 @@ gdk_display_open (const gchar *display_name)
 #endif /* MAEMO_CHANGES */
   display_x11->xdisplay = xdisplay;
 
+  cache_size = g_getenv ("GDK_PIXBUF_CACHE_SIZE");
+  if (cache_size)
+    display_x11->pixbuf_cache_max_size = g_ascii_strtoull (cache_size, NULL, 10) * 1024;
+
 #ifdef HAVE_X11R6  
   /* Set up handlers for Xlib internal connections */
   XAddConnectionWatch (xdisplay, gdk_internal_connection_watch, NULL);
@@ -814,6 +819,8 @@ gdk_display_x11_dispose (GObject *object)
   GdkDisplayX11 *display_x11 = GDK_DISPLAY_X11 (object);
   gint           i;
 
+  _gdk_x11_display_free_pixbuf_cache (GDK_DISPLAY_OBJECT (object));
+
   for (i = 0; i < ScreenCount (display_x11->xdisplay); i++)
     _gdk_screen_close (display_x11->screens[i]);
 
@@ -169,6 +169,24 @@ struct _GdkDisplayX11
 
   /* Alpha mask picture format */
   XRenderPictFormat *mask_format;
+
+  /* Server-side pictures of pixbufs drawn with gdk_draw_pixbuf(),
+   * most recently used first, see gdk_x11_display_set_pixbuf_cache_size()
+   */
+  GHashTable *pixbuf_cache;
+  GQueue *pixbuf_cache_lru;
+  gsize pixbuf_cache_size;
+  gsize pixbuf_cache_max_size;
+
+  /* Child window moves held back by gdk_window_begin_geometry_batch(),
+   * in request order, and the number of requests recorded and sent
+   * since the outermost batch was opened.
+   */
+  gint geometry_batch_depth;
+  GQueue *geometry_batch;
+  GHashTable *geometry_batch_windows;
+  guint geometry_requests_queued;
+  guint geometry_requests_sent;
 };
 
 struct _GdkDisplayX11Class
@@ -1185,41 +1185,22 @@ _gdk_x11_convert_to_format (guchar           *src_buf,
     }
 }
 
+/* Converts the pixel data to @format_type and copies it
+ * into the 32 bit pixmap @pix through the scratch images.
+ */
 static void
-draw_with_images (GdkDrawable       *drawable,
-		  GdkGC             *gc,
+upload_to_pixmap (GdkScreen         *screen,
+		  GdkPixmap         *pix,
 		  GdkX11FormatType   format_type,
-		  XRenderPictFormat *format,
-		  XRenderPictFormat *mask_format,
 		  guchar            *src_rgb,
 		  gint               src_rowstride,
-		  gint               dest_x,
-		  gint               dest_y,
 		  gint               width,
 		  gint               height)
 {
-  GdkScreen *screen = GDK_DRAWABLE_IMPL_X11 (drawable)->screen;
-  Display *xdisplay = GDK_SCREEN_XDISPLAY (screen);
   GdkImage *image;
-  GdkPixmap *pix;
   GdkGC *pix_gc;
-  Picture pict;
-  Picture dest_pict;
-  Picture mask = None;
   gint x0, y0;
 
-  pix = gdk_pixmap_new (gdk_screen_get_root_window (screen), width, height, 32);
-						  
-  pict = XRenderCreatePicture (xdisplay, 
-			       GDK_PIXMAP_XID (pix),
-			       format, 0, NULL);
-  if (mask_format)
-    mask = XRenderCreatePicture (xdisplay, 
-				 GDK_PIXMAP_XID (pix),
-				 mask_format, 0, NULL);
-
-  dest_pict = gdk_x11_drawable_get_picture (drawable);  
-  
   pix_gc = _gdk_drawable_get_scratch_gc (pix, FALSE);
 
   for (y0 = 0; y0 < height; y0 += GDK_SCRATCH_IMAGE_HEIGHT)
@@ -1242,6 +1223,42 @@ draw_with_images (GdkDrawable       *drawable,
 			  image, xs0, ys0, x0, y0, width1, height1);
 	}
     }
+}
+
+static void
+draw_with_images (GdkDrawable       *drawable,
+		  GdkGC             *gc,
+		  GdkX11FormatType   format_type,
+		  XRenderPictFormat *format,
+		  XRenderPictFormat *mask_format,
+		  guchar            *src_rgb,
+		  gint               src_rowstride,
+		  gint               dest_x,
+		  gint               dest_y,
+		  gint               width,
+		  gint               height)
+{
+  GdkScreen *screen = GDK_DRAWABLE_IMPL_X11 (drawable)->screen;
+  Display *xdisplay = GDK_SCREEN_XDISPLAY (screen);
+  GdkPixmap *pix;
+  Picture pict;
+  Picture dest_pict;
+  Picture mask = None;
+
+  pix = gdk_pixmap_new (gdk_screen_get_root_window (screen), width, height, 32);
+						  
+  pict = XRenderCreatePicture (xdisplay, 
+			       GDK_PIXMAP_XID (pix),
+			       format, 0, NULL);
+  if (mask_format)
+    mask = XRenderCreatePicture (xdisplay, 
+				 GDK_PIXMAP_XID (pix),
+				 mask_format, 0, NULL);
+
+  dest_pict = gdk_x11_drawable_get_picture (drawable);  
+  
+  upload_to_pixmap (screen, pix, format_type,
+		    src_rgb, src_rowstride, width, height);
   
   XRenderComposite (xdisplay, PictOpOver, pict, mask, dest_pict, 
 		    0, 0, 0, 0, dest_x, dest_y, width, height);
@@ -1377,6 +1394,237 @@ draw_with_pixmaps (GdkDrawable       *drawable,
 }
 #endif
 
+/* Retained pictures for gdk_draw_pixbuf().
+ *
+ * When a display has a pixbuf cache budget, the whole pixbuf is
+ * uploaded once into a server-side pixmap and later draws of it are a
+ * single XRenderComposite(). Entries are dropped when the pixbuf is
+ * finalized, when gdk_x11_pixbuf_invalidate() is called on it, or,
+ * least recently used first, when the budget is exceeded.
+ */
+typedef struct _PixbufPictureInfo PixbufPictureInfo;
+
+struct _PixbufPictureInfo
+{
+  GdkDisplay *display;
+  GdkPixbuf  *pixbuf;
+  GdkScreen  *screen;
+  GdkPixmap  *pix;
+  Picture     pict;
+  Picture     mask;
+  guint       stamp;
+  gsize       size;
+  GList      *link;
+};
+
+static GQuark quark_pixbuf_stamp = 0;
+
+static guint
+get_pixbuf_stamp (GdkPixbuf *pixbuf)
+{
+  if (!quark_pixbuf_stamp)
+    return 0;
+
+  return GPOINTER_TO_UINT (g_object_get_qdata (G_OBJECT (pixbuf),
+					       quark_pixbuf_stamp));
+}
+
+static void pixbuf_picture_finalized (gpointer  data,
+				      GObject  *where_the_object_was);
+
+static void
+pixbuf_picture_info_remove (PixbufPictureInfo *info,
+			    gboolean           weak_unref)
+{
+  GdkDisplayX11 *display_x11 = GDK_DISPLAY_X11 (info->display);
+  Display *xdisplay = display_x11->xdisplay;
+
+  g_hash_table_remove (display_x11->pixbuf_cache, info->pixbuf);
+  g_queue_delete_link (display_x11->pixbuf_cache_lru, info->link);
+  display_x11->pixbuf_cache_size -= info->size;
+
+  if (weak_unref)
+    g_object_weak_unref (G_OBJECT (info->pixbuf),
+			 pixbuf_picture_finalized, info);
+
+  XRenderFreePicture (xdisplay, info->pict);
+  if (info->mask != None)
+    XRenderFreePicture (xdisplay, info->mask);
+  g_object_unref (info->pix);
+
+  g_free (info);
+}
+
+static void
+pixbuf_picture_finalized (gpointer  data,
+			  GObject  *where_the_object_was)
+{
+  pixbuf_picture_info_remove (data, FALSE);
+}
+
+static void
+pixbuf_cache_trim (GdkDisplayX11 *display_x11,
+		   gsize          max_size)
+{
+  while (display_x11->pixbuf_cache_size > max_size &&
+	 !g_queue_is_empty (display_x11->pixbuf_cache_lru))
+    pixbuf_picture_info_remove (g_queue_peek_tail (display_x11->pixbuf_cache_lru),
+				TRUE);
+}
+
+/* Returns NULL if the pixbuf should not be drawn from the cache */
+static PixbufPictureInfo *
+get_pixbuf_picture (GdkDrawable       *drawable,
+		    GdkPixbuf         *pixbuf,
+		    GdkX11FormatType   format_type,
+		    XRenderPictFormat *format,
+		    XRenderPictFormat *mask_format)
+{
+  GdkScreen *screen = GDK_DRAWABLE_IMPL_X11 (drawable)->screen;
+  GdkDisplayX11 *display_x11 = GDK_DISPLAY_X11 (gdk_screen_get_display (screen));
+  PixbufPictureInfo *info;
+  gint width, height;
+  gsize size;
+
+  if (display_x11->pixbuf_cache_max_size == 0)
+    return NULL;
+
+  width = gdk_pixbuf_get_width (pixbuf);
+  height = gdk_pixbuf_get_height (pixbuf);
+  size = (gsize) width * height * 4;
+  if (size > display_x11->pixbuf_cache_max_size)
+    return NULL;
+
+  if (display_x11->pixbuf_cache == NULL)
+    {
+      display_x11->pixbuf_cache = g_hash_table_new (g_direct_hash, g_direct_equal);
+      display_x11->pixbuf_cache_lru = g_queue_new ();
+    }
+
+  info = g_hash_table_lookup (display_x11->pixbuf_cache, pixbuf);
+  if (info &&
+      (info->screen != screen || info->stamp != get_pixbuf_stamp (pixbuf)))
+    {
+      pixbuf_picture_info_remove (info, TRUE);
+      info = NULL;
+    }
+
+  if (info)
+    {
+      /* Move to the front of the LRU list */
+      g_queue_unlink (display_x11->pixbuf_cache_lru, info->link);
+      g_queue_push_head_link (display_x11->pixbuf_cache_lru, info->link);
+
+      return info;
+    }
+
+  pixbuf_cache_trim (display_x11, display_x11->pixbuf_cache_max_size - size);
+
+  info = g_new (PixbufPictureInfo, 1);
+  info->display = GDK_DISPLAY_OBJECT (display_x11);
+  info->pixbuf = pixbuf;
+  info->screen = screen;
+  info->stamp = get_pixbuf_stamp (pixbuf);
+  info->size = size;
+  info->pix = gdk_pixmap_new (gdk_screen_get_root_window (screen),
+			      width, height, 32);
+  info->pict = XRenderCreatePicture (display_x11->xdisplay,
+				     GDK_PIXMAP_XID (info->pix),
+				     format, 0, NULL);
+  if (mask_format)
+    info->mask = XRenderCreatePicture (display_x11->xdisplay,
+				       GDK_PIXMAP_XID (info->pix),
+				       mask_format, 0, NULL);
+  else
+    info->mask = None;
+
+  upload_to_pixmap (screen, info->pix, format_type,
+		    gdk_pixbuf_get_pixels (pixbuf),
+		    gdk_pixbuf_get_rowstride (pixbuf),
+		    width, height);
+
+  g_queue_push_head (display_x11->pixbuf_cache_lru, info);
+  info->link = g_queue_peek_head_link (display_x11->pixbuf_cache_lru);
+  display_x11->pixbuf_cache_size += size;
+  g_hash_table_insert (display_x11->pixbuf_cache, pixbuf, info);
+  g_object_weak_ref (G_OBJECT (pixbuf), pixbuf_picture_finalized, info);
+
+  return info;
+}
+
+void
+_gdk_x11_display_free_pixbuf_cache (GdkDisplay *display)
+{
+  GdkDisplayX11 *display_x11 = GDK_DISPLAY_X11 (display);
+
+  if (display_x11->pixbuf_cache == NULL)
+    return;
+
+  pixbuf_cache_trim (display_x11, 0);
+
+  g_hash_table_destroy (display_x11->pixbuf_cache);
+  display_x11->pixbuf_cache = NULL;
+  g_queue_free (display_x11->pixbuf_cache_lru);
+  display_x11->pixbuf_cache_lru = NULL;
+}
+
+/**
+ * gdk_x11_display_set_pixbuf_cache_size:
+ * @display: a #GdkDisplay
+ * @max_bytes: the budget for cached pixbufs in bytes, or 0
+ *
+ * Lets gdk_draw_pixbuf() keep pixbufs with an alpha channel on
+ * the X server, so that drawing the same pixbuf again does not upload
+ * its pixels again. Pixbufs are retained until they are finalized or
+ * until the total size of the retained pixbufs, at 4 bytes per pixel,
+ * exceeds @max_bytes. A @max_bytes of 0 disables the cache, which is
+ * the default unless the <envar>GDK_PIXBUF_CACHE_SIZE</envar>
+ * environment variable gives a size in kilobytes.
+ *
+ * Applications enabling the cache must call gdk_x11_pixbuf_invalidate()
+ * after modifying the pixels of a pixbuf that has already been drawn.
+ *
+ * Since: 2.14
+ **/
+void
+gdk_x11_display_set_pixbuf_cache_size (GdkDisplay *display,
+				       gsize       max_bytes)
+{
+  GdkDisplayX11 *display_x11;
+
+  g_return_if_fail (GDK_IS_DISPLAY (display));
+
+  display_x11 = GDK_DISPLAY_X11 (display);
+  display_x11->pixbuf_cache_max_size = max_bytes;
+
+  if (max_bytes == 0)
+    _gdk_x11_display_free_pixbuf_cache (display);
+  else if (display_x11->pixbuf_cache)
+    pixbuf_cache_trim (display_x11, max_bytes);
+}
+
+/**
+ * gdk_x11_pixbuf_invalidate:
+ * @pixbuf: a #GdkPixbuf
+ *
+ * Tells GDK that the pixels of @pixbuf have changed, so that a copy
+ * retained by the pixbuf cache is not used for later draws.
+ * See gdk_x11_display_set_pixbuf_cache_size().
+ *
+ * Since: 2.14
+ **/
+void
+gdk_x11_pixbuf_invalidate (GdkPixbuf *pixbuf)
+{
+  g_return_if_fail (GDK_IS_PIXBUF (pixbuf));
+
+  if (!quark_pixbuf_stamp)
+    quark_pixbuf_stamp = g_quark_from_static_string ("gdk-x11-pixbuf-stamp");
+
+  g_object_set_qdata (G_OBJECT (pixbuf), quark_pixbuf_stamp,
+		      GUINT_TO_POINTER (get_pixbuf_stamp (pixbuf) + 1));
+}
+
 static void
 gdk_x11_draw_pixbuf (GdkDrawable     *drawable,
 		     GdkGC           *gc,
@@ -1393,6 +1641,7 @@ gdk_x11_draw_pixbuf (GdkDrawable     *drawable,
 {
   GdkX11FormatType format_type;
   XRenderPictFormat *format, *mask_format;
+  PixbufPictureInfo *info;
   gint rowstride;
 #ifdef USE_SHM  
   gboolean use_pixmaps = TRUE;
@@ -1417,6 +1666,17 @@ gdk_x11_draw_pixbuf (GdkDrawable     *drawable,
 
   gdk_x11_drawable_update_picture_clip (drawable, gc);
 
+  info = get_pixbuf_picture (drawable, pixbuf, format_type, format, mask_format);
+  if (info)
+    {
+      XRenderComposite (GDK_SCREEN_XDISPLAY (info->screen), PictOpOver,
+			info->pict, info->mask,
+			gdk_x11_drawable_get_picture (drawable),
+			src_x, src_y, src_x, src_y,
+			dest_x, dest_y, width, height);
+      return;
+    }
+
   rowstride = gdk_pixbuf_get_rowstride (pixbuf);
 
 #ifdef USE_SHM
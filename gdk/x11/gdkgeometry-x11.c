@@ -142,6 +142,7 @@
 
 typedef struct _GdkWindowQueueItem GdkWindowQueueItem;
 typedef struct _GdkWindowParentPos GdkWindowParentPos;
+typedef struct _GdkWindowGeometryItem GdkWindowGeometryItem;
 
 typedef enum {
   GDK_WINDOW_QUEUE_TRANSLATE,
@@ -165,6 +166,17 @@ struct _GdkWindowQueueItem
   } u;
 };
 
+/* A move or move/resize of a child window held back by
+ * gdk_window_begin_geometry_batch()
+ */
+struct _GdkWindowGeometryItem
+{
+  GdkWindow *window;
+  GdkRectangle pos;
+  guint resize : 1;
+  guint reset_backgrounds : 1;
+};
+
 struct _GdkWindowParentPos
 {
   gint x;
@@ -190,6 +202,7 @@ static void gdk_window_queue_translation  (GdkWindow          *window,
 static void gdk_window_clip_changed       (GdkWindow          *window,
 					   GdkRectangle       *old_clip,
 					   GdkRectangle       *new_clip);
+static void reset_backgrounds             (GdkWindow          *window);
 
 void
 _gdk_x11_window_get_offsets (GdkWindow *window,
@@ -316,6 +329,8 @@ translate_pos (GdkWindowParentPos *dest, GdkWindowParentPos *src,
 static void
 move (GdkWindow *window, GdkXPositionInfo *pos)
 {
+  _gdk_x11_display_flush_geometry (GDK_WINDOW_DISPLAY (window));
+
   XMoveWindow (GDK_WINDOW_XDISPLAY (window),
                GDK_WINDOW_XID (window), pos->x, pos->y);
 }
@@ -324,6 +339,8 @@ static void
 move_relative (GdkWindow *window, GdkRectangle *rect,
                gint dx, gint dy)
 {
+  _gdk_x11_display_flush_geometry (GDK_WINDOW_DISPLAY (window));
+
   XMoveWindow (GDK_WINDOW_XDISPLAY (window),
                GDK_WINDOW_XID (window),
                rect->x + dx, rect->y + dy);
@@ -332,11 +349,142 @@ move_relative (GdkWindow *window, GdkRectangle *rect,
 static void
 move_resize (GdkWindow *window, GdkRectangle *pos)
 {
+  _gdk_x11_display_flush_geometry (GDK_WINDOW_DISPLAY (window));
+
   XMoveResizeWindow (GDK_WINDOW_XDISPLAY (window),
                      GDK_WINDOW_XID (window),
                      pos->x, pos->y, pos->width, pos->height);
 }
 
+/* Records the final position of a child window while a geometry
+ * batch is open. Later changes to the same window within the batch
+ * replace the recorded position, so only one request is sent for it.
+ * Returns FALSE if no batch is open and the caller has to send
+ * the request itself.
+ */
+static gboolean
+queue_geometry (GdkWindow        *window,
+                GdkXPositionInfo *pos,
+                gboolean          resize)
+{
+  GdkDisplayX11 *display_x11 = GDK_DISPLAY_X11 (GDK_WINDOW_DISPLAY (window));
+  GdkWindowGeometryItem *item;
+
+  if (display_x11->geometry_batch_depth == 0)
+    return FALSE;
+
+  display_x11->geometry_requests_queued++;
+
+  if (!display_x11->geometry_batch)
+    {
+      display_x11->geometry_batch = g_queue_new ();
+      display_x11->geometry_batch_windows = g_hash_table_new (NULL, NULL);
+    }
+
+  item = g_hash_table_lookup (display_x11->geometry_batch_windows, window);
+  if (!item)
+    {
+      item = g_new0 (GdkWindowGeometryItem, 1);
+      item->window = g_object_ref (window);
+
+      g_queue_push_tail (display_x11->geometry_batch, item);
+      g_hash_table_insert (display_x11->geometry_batch_windows, window, item);
+    }
+
+  item->pos.x = pos->x;
+  item->pos.y = pos->y;
+  item->pos.width = pos->width;
+  item->pos.height = pos->height;
+  item->resize |= resize;
+  item->reset_backgrounds = TRUE;
+
+  return TRUE;
+}
+
+/* Sends the requests held back by the open geometry batches of
+ * @display. This has to be called before any other request that
+ * depends on the position of a child window, so that the X server
+ * sees the same order of requests as without batching.
+ */
+void
+_gdk_x11_display_flush_geometry (GdkDisplay *display)
+{
+  GdkDisplayX11 *display_x11 = GDK_DISPLAY_X11 (display);
+  GdkWindowGeometryItem *item;
+
+  if (!display_x11->geometry_batch)
+    return;
+
+  while ((item = g_queue_pop_head (display_x11->geometry_batch)))
+    {
+      GdkWindow *window = item->window;
+
+      g_hash_table_remove (display_x11->geometry_batch_windows, window);
+
+      if (!GDK_WINDOW_DESTROYED (window))
+        {
+          if (item->resize)
+            XMoveResizeWindow (GDK_WINDOW_XDISPLAY (window),
+                               GDK_WINDOW_XID (window),
+                               item->pos.x, item->pos.y,
+                               item->pos.width, item->pos.height);
+          else
+            XMoveWindow (GDK_WINDOW_XDISPLAY (window),
+                         GDK_WINDOW_XID (window),
+                         item->pos.x, item->pos.y);
+
+          display_x11->geometry_requests_sent++;
+
+          if (item->reset_backgrounds)
+            reset_backgrounds (window);
+        }
+
+      g_object_unref (window);
+      g_free (item);
+    }
+}
+
+void
+_gdk_x11_window_begin_geometry_batch (GdkWindow *window)
+{
+  GdkDisplayX11 *display_x11 = GDK_DISPLAY_X11 (GDK_WINDOW_DISPLAY (window));
+
+  display_x11->geometry_batch_depth++;
+}
+
+void
+_gdk_x11_window_end_geometry_batch (GdkWindow *window)
+{
+  GdkDisplay *display = GDK_WINDOW_DISPLAY (window);
+  GdkDisplayX11 *display_x11 = GDK_DISPLAY_X11 (display);
+
+  g_return_if_fail (display_x11->geometry_batch_depth > 0);
+
+  if (--display_x11->geometry_batch_depth > 0)
+    return;
+
+  _gdk_x11_display_flush_geometry (display);
+
+  if (display_x11->geometry_requests_queued > 0)
+    {
+      GDK_NOTE (MISC,
+                g_message ("geometry batch: %u child window requests, %u sent",
+                           display_x11->geometry_requests_queued,
+                           display_x11->geometry_requests_sent));
+
+      display_x11->geometry_requests_queued = 0;
+      display_x11->geometry_requests_sent = 0;
+    }
+
+  if (display_x11->geometry_batch)
+    {
+      g_queue_free (display_x11->geometry_batch);
+      display_x11->geometry_batch = NULL;
+      g_hash_table_destroy (display_x11->geometry_batch_windows);
+      display_x11->geometry_batch_windows = NULL;
+    }
+}
+
 static void
 gdk_window_guffaw_scroll (GdkWindow    *window,
 			  gint          dx,
@@ -409,6 +557,8 @@ _gdk_x11_window_scroll (GdkWindow *window,
   obj = GDK_WINDOW_OBJECT (window);
   impl = GDK_WINDOW_IMPL_X11 (obj->impl);  
 
+  _gdk_x11_display_flush_geometry (GDK_WINDOW_DISPLAY (window));
+
   /* Move the current invalid region */
   if (obj->update_area)
     gdk_region_offset (obj->update_area, dx, dy);
@@ -479,6 +629,8 @@ _gdk_x11_window_move_region (GdkWindow       *window,
   private = GDK_WINDOW_OBJECT (window);
   impl = GDK_WINDOW_IMPL_X11 (private->impl);  
 
+  _gdk_x11_display_flush_geometry (GDK_WINDOW_DISPLAY (window));
+
   window_clip = gdk_region_rectangle (&impl->position_info.clip_rect);
 
   /* compute source regions */
@@ -563,7 +715,10 @@ map_if_needed (GdkWindow *window, GdkXPositionInfo *pos_info)
   GdkWindowImplX11 *impl = GDK_WINDOW_IMPL_X11 (obj->impl);
 
   if (!impl->position_info.mapped && pos_info->mapped && GDK_WINDOW_IS_MAPPED (obj))
-    XMapWindow (GDK_DRAWABLE_XDISPLAY (window), GDK_DRAWABLE_XID (window));
+    {
+      _gdk_x11_display_flush_geometry (GDK_WINDOW_DISPLAY (window));
+      XMapWindow (GDK_DRAWABLE_XDISPLAY (window), GDK_DRAWABLE_XID (window));
+    }
 }
 
 static void
@@ -573,7 +728,10 @@ unmap_if_needed (GdkWindow *window, GdkXPositionInfo *pos_info)
   GdkWindowImplX11 *impl = GDK_WINDOW_IMPL_X11 (obj->impl);
 
   if (impl->position_info.mapped && !pos_info->mapped)
-    XUnmapWindow (GDK_DRAWABLE_XDISPLAY (window), GDK_DRAWABLE_XID (window));
+    {
+      _gdk_x11_display_flush_geometry (GDK_WINDOW_DISPLAY (window));
+      XUnmapWindow (GDK_DRAWABLE_XDISPLAY (window), GDK_DRAWABLE_XID (window));
+    }
 }
 
 void
@@ -592,6 +750,7 @@ _gdk_window_move_resize_child (GdkWindow *window,
   gint dx, dy;
   gboolean is_move;
   gboolean is_resize;
+  gboolean batched;
 
   GdkRectangle old_pos;
   
@@ -670,14 +829,20 @@ _gdk_window_move_resize_child (GdkWindow *window,
       
       g_list_foreach (obj->children, (GFunc) gdk_window_premove, &parent_pos);
 
-      if (is_resize)
-          move_resize (window, (GdkRectangle *) &new_info);
-      else
-          move (window, &new_info);
+      batched = queue_geometry (window, &new_info, is_resize);
+      if (!batched)
+        {
+          if (is_resize)
+            move_resize (window, (GdkRectangle *) &new_info);
+          else
+            move (window, &new_info);
+        }
 
       g_list_foreach (obj->children, (GFunc) gdk_window_postmove, &parent_pos);
 
-      reset_backgrounds (window);
+      /* When batched, the backgrounds are reset once the move is sent */
+      if (!batched)
+        reset_backgrounds (window);
       
       map_if_needed (window, &new_info);
 
@@ -988,6 +1153,9 @@ gdk_window_queue (GdkWindow          *window,
 {
   GdkDisplayX11 *display_x11 = GDK_DISPLAY_X11 (GDK_WINDOW_DISPLAY (window));
   
+  /* The serial recorded below must follow any held back request */
+  _gdk_x11_display_flush_geometry (GDK_WINDOW_DISPLAY (window));
+
   if (!display_x11->translate_queue)
     display_x11->translate_queue = g_queue_new ();
 
@@ -102,6 +102,11 @@ gint _gdk_send_xevent      (GdkDisplay *display,
 GType _gdk_gc_x11_get_type (void);
 
 gboolean _gdk_x11_have_render           (GdkDisplay *display);
+void     _gdk_x11_display_free_pixbuf_cache (GdkDisplay *display);
+
+void _gdk_x11_display_flush_geometry      (GdkDisplay *display);
+void _gdk_x11_window_begin_geometry_batch (GdkWindow  *window);
+void _gdk_x11_window_end_geometry_batch   (GdkWindow  *window);
 
 GdkGC *_gdk_x11_gc_new                  (GdkDrawable     *drawable,
 					 GdkGCValues     *values,
@@ -69,6 +69,10 @@
 #include <X11/extensions/Xfixes.h>
 #endif
 
+#ifdef HAVE_RANDR
+#include <X11/extensions/Xrandr.h>
+#endif
+
 #ifdef HAVE_XDAMAGE
 #include <X11/extensions/Xdamage.h>
 #endif
@@ -1163,6 +1167,7 @@ _gdk_windowing_window_destroy (GdkWindow *window,
 
   if (!recursing && !foreign_destroy)
     {
+      _gdk_x11_display_flush_geometry (GDK_WINDOW_DISPLAY (window));
       XDestroyWindow (GDK_WINDOW_XDISPLAY (window), GDK_WINDOW_XID (window));
     }
 }
@@ -1434,6 +1439,8 @@ gdk_window_x11_show (GdkWindow *window,
       Display *xdisplay = GDK_WINDOW_XDISPLAY (window);
       Window xwindow = GDK_WINDOW_XID (window);
       
+      _gdk_x11_display_flush_geometry (GDK_WINDOW_DISPLAY (window));
+
       if (raise)
         XRaiseWindow (xdisplay, xwindow);
 
@@ -1570,6 +1577,8 @@ gdk_window_x11_hide (GdkWindow *window)
       
       _gdk_window_clear_update_area (window);
 
+      _gdk_x11_display_flush_geometry (GDK_WINDOW_DISPLAY (window));
+
       pre_unmap (window);
       
       XUnmapWindow (GDK_WINDOW_XDISPLAY (window),
@@ -1594,6 +1603,8 @@ gdk_window_x11_withdraw (GdkWindow *window)
 
       g_assert (!GDK_WINDOW_IS_MAPPED (window));
 
+      _gdk_x11_display_flush_geometry (GDK_WINDOW_DISPLAY (window));
+
       pre_unmap (window);
       
       XWithdrawWindow (GDK_WINDOW_XDISPLAY (window),
@@ -1760,6 +1771,8 @@ gdk_window_x11_reparent (GdkWindow *window,
   parent_private = (GdkWindowObject*) new_parent;
   impl = GDK_WINDOW_IMPL_X11 (window_private->impl);
 
+  _gdk_x11_display_flush_geometry (GDK_WINDOW_DISPLAY (window));
+
   XReparentWindow (GDK_WINDOW_XDISPLAY (window),
 		   GDK_WINDOW_XID (window),
 		   GDK_WINDOW_XID (new_parent),
@@ -1851,14 +1864,20 @@ static void
 gdk_window_x11_raise (GdkWindow *window)
 {
   if (!GDK_WINDOW_DESTROYED (window))
-    XRaiseWindow (GDK_WINDOW_XDISPLAY (window), GDK_WINDOW_XID (window));
+    {
+      _gdk_x11_display_flush_geometry (GDK_WINDOW_DISPLAY (window));
+      XRaiseWindow (GDK_WINDOW_XDISPLAY (window), GDK_WINDOW_XID (window));
+    }
 }
 
 static void
 gdk_window_x11_lower (GdkWindow *window)
 {
   if (!GDK_WINDOW_DESTROYED (window))
-    XLowerWindow (GDK_WINDOW_XDISPLAY (window), GDK_WINDOW_XID (window));
+    {
+      _gdk_x11_display_flush_geometry (GDK_WINDOW_DISPLAY (window));
+      XLowerWindow (GDK_WINDOW_XDISPLAY (window), GDK_WINDOW_XID (window));
+    }
 }
 
 /**
@@ -2956,6 +2975,8 @@ gdk_window_x11_get_geometry (GdkWindow *window,
   
   if (!GDK_WINDOW_DESTROYED (window))
     {
+      _gdk_x11_display_flush_geometry (GDK_WINDOW_DISPLAY (window));
+
       XGetGeometry (GDK_WINDOW_XDISPLAY (window),
 		    GDK_WINDOW_XID (window),
 		    &root, &tx, &ty, &twidth, &theight, &tborder_width, &tdepth);
@@ -2985,6 +3006,8 @@ gdk_window_x11_get_origin (GdkWindow *window,
   
   if (!GDK_WINDOW_DESTROYED (window))
     {
+      _gdk_x11_display_flush_geometry (GDK_WINDOW_DISPLAY (window));
+
       return_val = XTranslateCoordinates (GDK_WINDOW_XDISPLAY (window),
 					  GDK_WINDOW_XID (window),
 					  GDK_WINDOW_XROOTWIN (window),
@@ -5342,6 +5365,9 @@ gdk_window_x11_set_static_gravities (GdkWindow *window,
     return TRUE;
 
   private->guffaw_gravity = use_static;
+
+  /* Held back moves were computed for the old gravities */
+  _gdk_x11_display_flush_geometry (GDK_WINDOW_DISPLAY (window));
   
   if (!GDK_WINDOW_DESTROYED (window))
     {
@@ -6167,6 +6193,28 @@ _gdk_windowing_window_set_composited (GdkWindow *window,
 #endif
 }
 
+static gint
+gdk_window_x11_get_refresh_rate (GdkWindow *window)
+{
+  gint rate = 0;
+#ifdef HAVE_RANDR
+  XRRScreenConfiguration *config;
+
+  if (GDK_WINDOW_DESTROYED (window))
+    return 0;
+
+  config = XRRGetScreenInfo (GDK_WINDOW_XDISPLAY (window),
+                             GDK_WINDOW_XROOTWIN (window));
+  if (config)
+    {
+      rate = XRRConfigCurrentRate (config);
+      XRRFreeScreenConfigInfo (config);
+    }
+#endif
+
+  return rate;
+}
+
 static void
 gdk_window_impl_iface_init (GdkWindowImplIface *iface)
 {
@@ -6193,6 +6241,9 @@ gdk_window_impl_iface_init (GdkWindowImplIface *iface)
   iface->merge_child_shapes = gdk_window_x11_merge_child_shapes;
   iface->set_static_gravities = gdk_window_x11_set_static_gravities;
   iface->get_offsets = _gdk_x11_window_get_offsets;
+  iface->begin_geometry_batch = _gdk_x11_window_begin_geometry_batch;
+  iface->end_geometry_batch = _gdk_x11_window_end_geometry_batch;
+  iface->get_refresh_rate = gdk_window_x11_get_refresh_rate;
 }
 
 #define __GDK_WINDOW_X11_C__
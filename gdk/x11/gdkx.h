@@ -55,6 +55,9 @@ int      gdk_x11_screen_get_screen_number (GdkScreen   *screen);
 void     gdk_x11_window_set_user_time     (GdkWindow   *window,
 					   guint32      timestamp);
 void     gdk_x11_window_move_to_current_desktop (GdkWindow   *window);
+void     gdk_x11_display_set_pixbuf_cache_size  (GdkDisplay  *display,
+                                                 gsize        max_bytes);
+void     gdk_x11_pixbuf_invalidate              (GdkPixbuf   *pixbuf);
 
 const char* gdk_x11_screen_get_window_manager_name (GdkScreen *screen);
 
@@ -0,0 +1,202 @@
+/* buildercompile.c
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "config.h"
+
+#include <locale.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <glib/gi18n.h>
+
+#include "gtkbuildercache.h"
+
+static gboolean quiet = FALSE;
+
+static void
+start_element (GMarkupParseContext *context,
+               const gchar         *element_name,
+               const gchar        **names,
+               const gchar        **values,
+               gpointer             user_data,
+               GError             **error)
+{
+  _gtk_builder_cache_writer_start_element (user_data, element_name,
+                                           names, values);
+}
+
+static void
+end_element (GMarkupParseContext *context,
+             const gchar         *element_name,
+             gpointer             user_data,
+             GError             **error)
+{
+  _gtk_builder_cache_writer_end_element (user_data, element_name);
+}
+
+static void
+text (GMarkupParseContext *context,
+      const gchar         *text,
+      gsize                text_len,
+      gpointer             user_data,
+      GError             **error)
+{
+  _gtk_builder_cache_writer_text (user_data, text, text_len);
+}
+
+static const GMarkupParser parser = {
+  start_element,
+  end_element,
+  text,
+  NULL,
+  NULL
+};
+
+static gboolean
+compile_file (const gchar  *filename,
+              const gchar  *output,
+              GError      **error)
+{
+  GMarkupParseContext *context;
+  GtkBuilderCacheWriter *writer;
+  struct stat st;
+  gchar *contents;
+  gsize length;
+  GString *out;
+  gboolean retval;
+
+  if (g_stat (filename, &st) < 0)
+    {
+      g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (errno),
+                   _("Failed to stat %s"), filename);
+      return FALSE;
+    }
+
+  if (!g_file_get_contents (filename, &contents, &length, error))
+    return FALSE;
+
+  writer = _gtk_builder_cache_writer_new ();
+
+  context = g_markup_parse_context_new (&parser,
+                                        G_MARKUP_TREAT_CDATA_AS_TEXT,
+                                        writer, NULL);
+
+  if (!g_markup_parse_context_parse (context, contents, length, error) ||
+      !g_markup_parse_context_end_parse (context, error))
+    {
+      g_markup_parse_context_free (context);
+      _gtk_builder_cache_writer_free (writer);
+      g_free (contents);
+
+      return FALSE;
+    }
+
+  out = _gtk_builder_cache_writer_finish (writer,
+                                          (guint32) st.st_size,
+                                          (guint32) st.st_mtime);
+
+  retval = g_file_set_contents (output, out->str, out->len, error);
+
+  g_string_free (out, TRUE);
+  g_markup_parse_context_free (context);
+  g_free (contents);
+
+  return retval;
+}
+
+static gchar *output = NULL;
+static gchar **files = NULL;
+
+static GOptionEntry args[] = {
+  { "output", 'o', 0, G_OPTION_ARG_FILENAME, &output, N_("Write the compiled file to FILE"), N_("FILE") },
+  { "quiet", 'q', 0, G_OPTION_ARG_NONE, &quiet, N_("Turn off verbose output"), NULL },
+  { G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_FILENAME_ARRAY, &files, NULL, N_("FILE...") },
+  { NULL }
+};
+
+int
+main (int    argc,
+      char **argv)
+{
+  GOptionContext *context;
+  GError *error = NULL;
+  gint status = 0;
+  gint i;
+
+  setlocale (LC_ALL, "");
+
+#ifdef ENABLE_NLS
+  bindtextdomain (GETTEXT_PACKAGE, GTK_LOCALEDIR);
+#ifdef HAVE_BIND_TEXTDOMAIN_CODESET
+  bind_textdomain_codeset (GETTEXT_PACKAGE, "UTF-8");
+#endif
+#endif
+
+  context = g_option_context_new ("FILE...");
+  g_option_context_set_summary (context,
+                                _("Compiles GtkBuilder UI definitions for faster loading"));
+  g_option_context_add_main_entries (context, args, GETTEXT_PACKAGE);
+
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      g_error_free (error);
+      return 1;
+    }
+  g_option_context_free (context);
+
+  if (files == NULL)
+    {
+      g_printerr (_("No UI definition given\n"));
+      return 1;
+    }
+
+  if (output && files[1] != NULL)
+    {
+      g_printerr (_("--output can only be used with a single file\n"));
+      return 1;
+    }
+
+  for (i = 0; files[i]; i++)
+    {
+      gchar *target;
+
+      if (output)
+        target = g_strdup (output);
+      else
+        target = g_strconcat (files[i], GTK_BUILDER_CACHE_SUFFIX, NULL);
+
+      if (!compile_file (files[i], target, &error))
+        {
+          g_printerr (_("Failed to compile %s: %s\n"), files[i], error->message);
+          g_clear_error (&error);
+          status = 1;
+        }
+      else if (!quiet)
+        g_printerr (_("Compiled %s into %s\n"), files[i], target);
+
+      g_free (target);
+    }
+
+  return status;
+}
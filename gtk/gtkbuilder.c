@@ -63,6 +63,16 @@ struct _GtkBuilderPrivate
   GSList *delayed_properties;
   GSList *signals;
   gchar *filename;
+
+  /* Objects not built yet, by id, see _gtk_builder_add_deferred() */
+  GHashTable *deferred;
+
+  /* The last gtk_builder_connect_signals_full() call, for
+   * connecting the signals of deferred objects.
+   */
+  GtkBuilderConnectFunc connect_func;
+  gpointer connect_data;
+  gpointer connect_args;
 };
 
 G_DEFINE_TYPE (GtkBuilder, gtk_builder, G_TYPE_OBJECT)
@@ -109,6 +119,7 @@ gtk_builder_init (GtkBuilder *builder)
   builder->priv->domain = NULL;
   builder->priv->objects = g_hash_table_new_full (g_str_hash, g_str_equal,
                                                   g_free, g_object_unref);
+  builder->priv->deferred = g_hash_table_new (g_str_hash, g_str_equal);
 }
 
 
@@ -116,6 +127,29 @@ gtk_builder_init (GtkBuilder *builder)
  * GObject virtual methods
  */
 
+static void
+deferred_info_free (DeferredInfo *info)
+{
+  g_free (info->filename);
+  g_free (info->domain);
+  g_slist_foreach (info->ids, (GFunc) g_free, NULL);
+  g_slist_free (info->ids);
+  g_string_free (info->events, TRUE);
+  g_slice_free (DeferredInfo, info);
+}
+
+static void
+free_deferred_foreach (gchar        *id,
+                       DeferredInfo *info,
+                       gpointer      user_data)
+{
+  /* Each info is in the table once per id, free it once */
+  if (id == info->ids->data)
+    deferred_info_free (info);
+}
+
+static void free_connect_args (gpointer args);
+
 static void
 gtk_builder_finalize (GObject *object)
 {
@@ -126,6 +160,12 @@ gtk_builder_finalize (GObject *object)
   
   g_hash_table_destroy (priv->objects);
 
+  g_hash_table_foreach (priv->deferred, (GHFunc) free_deferred_foreach, NULL);
+  g_hash_table_destroy (priv->deferred);
+
+  if (priv->connect_args)
+    free_connect_args (priv->connect_args);
+
   g_slist_foreach (priv->signals, (GFunc) _free_signal_info, NULL);
   g_slist_free (priv->signals);
   
@@ -598,7 +638,7 @@ gtk_builder_apply_delayed_properties (GtkBuilder *builder)
         {
           GObject *obj;
 
-          obj = g_hash_table_lookup (builder->priv->objects, property->value);
+          obj = gtk_builder_get_object (builder, property->value);
           if (!obj)
             g_warning ("No object called: %s", property->value);
           else
@@ -613,6 +653,86 @@ gtk_builder_apply_delayed_properties (GtkBuilder *builder)
   g_slist_free (props);
 }
 
+/*
+ * _gtk_builder_add_deferred:
+ * @builder: a #GtkBuilder
+ * @info: the recorded description of a deferred toplevel object
+ *
+ * Registers @info under all the object ids it contains, and takes
+ * ownership of it. The objects are constructed by the first
+ * gtk_builder_get_object() call for one of the ids.
+ */
+void
+_gtk_builder_add_deferred (GtkBuilder   *builder,
+                           DeferredInfo *info)
+{
+  GSList *l;
+
+  for (l = info->ids; l; l = l->next)
+    g_hash_table_insert (builder->priv->deferred, l->data, info);
+}
+
+/*
+ * _gtk_builder_has_deferred:
+ * @builder: a #GtkBuilder
+ * @id: an object id
+ *
+ * Returns: whether a deferred object that is not built yet
+ *   contains an object with @id
+ */
+gboolean
+_gtk_builder_has_deferred (GtkBuilder  *builder,
+                           const gchar *id)
+{
+  return g_hash_table_lookup (builder->priv->deferred, id) != NULL;
+}
+
+static void
+gtk_builder_build_deferred (GtkBuilder   *builder,
+                            DeferredInfo *info)
+{
+  GtkBuilderPrivate *priv = builder->priv;
+  GSList *signals, *delayed_properties, *l;
+  gchar *filename;
+  GError *error = NULL;
+
+  for (l = info->ids; l; l = l->next)
+    g_hash_table_remove (priv->deferred, l->data);
+
+  GTK_NOTE (BUILDER, g_print ("building deferred object \"%s\"\n",
+                              (gchar *) g_slist_last (info->ids)->data));
+
+  /* This may happen in the middle of parsing another UI definition,
+   * or of connecting signals, keep their state out of the way.
+   */
+  signals = priv->signals;
+  priv->signals = NULL;
+  delayed_properties = priv->delayed_properties;
+  priv->delayed_properties = NULL;
+  filename = priv->filename;
+  priv->filename = g_strdup (info->filename);
+
+  _gtk_builder_parser_parse_deferred (builder, info, &error);
+  if (error)
+    {
+      g_warning ("Failed to build deferred object: %s", error->message);
+      g_error_free (error);
+    }
+
+  if (priv->connect_func)
+    gtk_builder_connect_signals_full (builder,
+                                      priv->connect_func,
+                                      priv->connect_data);
+
+  priv->signals = g_slist_concat (signals, priv->signals);
+  priv->delayed_properties = g_slist_concat (priv->delayed_properties,
+                                             delayed_properties);
+  g_free (priv->filename);
+  priv->filename = filename;
+
+  deferred_info_free (info);
+}
+
 void
 _gtk_builder_finish (GtkBuilder *builder)
 {
@@ -643,6 +763,10 @@ gtk_builder_new (void)
  * Parses a file containing a <link linkend="BUILDER-UI">GtkBuilder 
  * UI definition</link> and merges it with the current contents of @builder. 
  * 
+ * If a compiled version of @filename made with gtk-builder-compile
+ * exists next to it and is up to date, it is loaded instead of
+ * parsing @filename.
+ *
  * Returns: A positive value on success, 0 if an error occurred
  *
  * Since: 2.12
@@ -652,6 +776,7 @@ gtk_builder_add_from_file (GtkBuilder   *builder,
                            const gchar  *filename,
                            GError      **error)
 {
+  GMappedFile *map;
   gchar *buffer;
   gsize length;
   GError *tmp_error;
@@ -662,6 +787,27 @@ gtk_builder_add_from_file (GtkBuilder   *builder,
 
   tmp_error = NULL;
 
+  map = _gtk_builder_cache_open (filename);
+  if (map)
+    {
+      g_free (builder->priv->filename);
+      builder->priv->filename = g_strdup (filename);
+
+      _gtk_builder_parser_parse_cache (builder, filename, map,
+                                       NULL,
+                                       &tmp_error);
+
+      g_mapped_file_free (map);
+
+      if (tmp_error != NULL)
+        {
+          g_propagate_error (error, tmp_error);
+          return 0;
+        }
+
+      return 1;
+    }
+
   if (!g_file_get_contents (filename, &buffer, &length, &tmp_error))
     {
       g_propagate_error (error, tmp_error);
@@ -704,6 +850,10 @@ gtk_builder_add_from_file (GtkBuilder   *builder,
  * #GtkTreeModel), you have to explicitely list all of them in @object_ids. 
  * </para></note>
  *
+ * If a compiled version of @filename made with gtk-builder-compile
+ * exists next to it and is up to date, it is loaded instead of
+ * parsing @filename.
+ *
  * Returns: A positive value on success, 0 if an error occurred
  *
  * Since: 2.14
@@ -714,6 +864,7 @@ gtk_builder_add_objects_from_file (GtkBuilder   *builder,
                                    gchar       **object_ids,
                                    GError      **error)
 {
+  GMappedFile *map;
   gchar *buffer;
   gsize length;
   GError *tmp_error;
@@ -725,6 +876,27 @@ gtk_builder_add_objects_from_file (GtkBuilder   *builder,
 
   tmp_error = NULL;
 
+  map = _gtk_builder_cache_open (filename);
+  if (map)
+    {
+      g_free (builder->priv->filename);
+      builder->priv->filename = g_strdup (filename);
+
+      _gtk_builder_parser_parse_cache (builder, filename, map,
+                                       object_ids,
+                                       &tmp_error);
+
+      g_mapped_file_free (map);
+
+      if (tmp_error != NULL)
+        {
+          g_propagate_error (error, tmp_error);
+          return 0;
+        }
+
+      return 1;
+    }
+
   if (!g_file_get_contents (filename, &buffer, &length, &tmp_error))
     {
       g_propagate_error (error, tmp_error);
@@ -857,6 +1029,10 @@ gtk_builder_add_objects_from_string (GtkBuilder   *builder,
  * Gets the object named @name. Note that this function does not
  * increment the reference count of the returned object. 
  *
+ * If the object is described with the "deferred" attribute in the
+ * UI definition and has not been needed before, it is constructed
+ * now, together with the objects inside it.
+ *
  * Return value: the object named @name or %NULL if it could not be 
  *    found in the object tree. 
  *
@@ -866,9 +1042,22 @@ GObject *
 gtk_builder_get_object (GtkBuilder  *builder,
                         const gchar *name)
 {
+  GObject *object;
+  DeferredInfo *info;
+
   g_return_val_if_fail (GTK_IS_BUILDER (builder), NULL);
   g_return_val_if_fail (name != NULL, NULL);
 
+  object = g_hash_table_lookup (builder->priv->objects, name);
+  if (object)
+    return object;
+
+  info = g_hash_table_lookup (builder->priv->deferred, name);
+  if (!info)
+    return NULL;
+
+  gtk_builder_build_deferred (builder, info);
+
   return g_hash_table_lookup (builder->priv->objects, name);
 }
 
@@ -888,6 +1077,9 @@ object_add_to_list (gchar    *object_id,
  * this function does not increment the reference counts of the returned
  * objects.
  *
+ * Deferred objects that have not been constructed yet are not
+ * included; use gtk_builder_get_object() to construct them.
+ *
  * Return value: a newly-allocated #GSList containing all the objects
  *   constructed by the #GtkBuilder instance. It should be freed by
  *   g_slist_free()
@@ -955,6 +1147,15 @@ typedef struct {
   gpointer data;
 } connect_args;
 
+static void
+free_connect_args (gpointer data)
+{
+  connect_args *args = data;
+
+  g_module_close (args->module);
+  g_slice_free (connect_args, args);
+}
+
 static void
 gtk_builder_connect_signals_default (GtkBuilder    *builder,
 				     GObject       *object,
@@ -1020,9 +1221,20 @@ gtk_builder_connect_signals (GtkBuilder *builder,
   gtk_builder_connect_signals_full (builder,
                                     gtk_builder_connect_signals_default,
                                     args);
-  g_module_close (args->module);
 
-  g_slice_free (connect_args, args);
+  if (builder->priv->connect_args)
+    free_connect_args (builder->priv->connect_args);
+  builder->priv->connect_args = NULL;
+
+  /* Keep the module around for objects that are still to be built */
+  if (g_hash_table_size (builder->priv->deferred) > 0)
+    builder->priv->connect_args = args;
+  else
+    {
+      free_connect_args (args);
+      builder->priv->connect_func = NULL;
+      builder->priv->connect_data = NULL;
+    }
 }
 
 /**
@@ -1054,6 +1266,10 @@ gtk_builder_connect_signals (GtkBuilder *builder,
  * version of gtk_builder_connect_signals(), except that it does not
  * require GModule to function correctly.
  *
+ * Signals of deferred objects that are constructed later on are
+ * connected with @func and @user_data as well, when they are
+ * constructed. @user_data must stay valid until then.
+ *
  * Since: 2.12
  */
 void
@@ -1061,18 +1277,26 @@ gtk_builder_connect_signals_full (GtkBuilder            *builder,
                                   GtkBuilderConnectFunc  func,
                                   gpointer               user_data)
 {
-  GSList *l;
+  GSList *l, *signals;
   GObject *object;
   GObject *connect_object;
   
   g_return_if_fail (GTK_IS_BUILDER (builder));
   g_return_if_fail (func != NULL);
+
+  builder->priv->connect_func = func;
+  builder->priv->connect_data = user_data;
   
   if (!builder->priv->signals)
     return;
 
-  builder->priv->signals = g_slist_reverse (builder->priv->signals);
-  for (l = builder->priv->signals; l; l = l->next)
+  /* Take the list over, looking up a deferred connect object
+   * builds it and connects its own signals.
+   */
+  signals = g_slist_reverse (builder->priv->signals);
+  builder->priv->signals = NULL;
+
+  for (l = signals; l; l = l->next)
     {
       SignalInfo *signal = (SignalInfo*)l->data;
 
@@ -1087,8 +1311,8 @@ gtk_builder_connect_signals_full (GtkBuilder            *builder,
       
       if (signal->connect_object_name)
 	{
-	  connect_object = g_hash_table_lookup (builder->priv->objects,
-						signal->connect_object_name);
+	  connect_object = gtk_builder_get_object (builder,
+						   signal->connect_object_name);
 	  if (!connect_object)
 	      g_warning ("Could not lookup object %s on signal %s of object %s",
 			 signal->connect_object_name, signal->name,
@@ -1099,9 +1323,8 @@ gtk_builder_connect_signals_full (GtkBuilder            *builder,
 	    connect_object, signal->flags, user_data);
     }
 
-  g_slist_foreach (builder->priv->signals, (GFunc)_free_signal_info, NULL);
-  g_slist_free (builder->priv->signals);
-  builder->priv->signals = NULL;
+  g_slist_foreach (signals, (GFunc)_free_signal_info, NULL);
+  g_slist_free (signals);
 }
 
 /**
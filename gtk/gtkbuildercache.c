@@ -0,0 +1,185 @@
+/* gtkbuildercache.c
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "config.h"
+#include "gtkbuildercache.h"
+
+#include <string.h>
+
+struct _GtkBuilderCacheWriter
+{
+  GHashTable *string_index;
+  GPtrArray *strings;
+  GArray *events;
+};
+
+GtkBuilderCacheWriter *
+_gtk_builder_cache_writer_new (void)
+{
+  GtkBuilderCacheWriter *writer;
+
+  writer = g_slice_new (GtkBuilderCacheWriter);
+  writer->string_index = g_hash_table_new (g_str_hash, g_str_equal);
+  writer->strings = g_ptr_array_new ();
+  writer->events = g_array_new (FALSE, FALSE, sizeof (guint32));
+
+  return writer;
+}
+
+static guint32
+writer_add_string (GtkBuilderCacheWriter *writer,
+                   const gchar           *string,
+                   gsize                  length)
+{
+  gchar *copy;
+  gpointer index;
+
+  copy = g_strndup (string, length);
+
+  if (g_hash_table_lookup_extended (writer->string_index, copy,
+                                    NULL, &index))
+    {
+      g_free (copy);
+      return GPOINTER_TO_UINT (index);
+    }
+
+  index = GUINT_TO_POINTER (writer->strings->len);
+  g_ptr_array_add (writer->strings, copy);
+  g_hash_table_insert (writer->string_index, copy, index);
+
+  return GPOINTER_TO_UINT (index);
+}
+
+static void
+writer_add_word (GtkBuilderCacheWriter *writer,
+                 guint32                word)
+{
+  g_array_append_val (writer->events, word);
+}
+
+void
+_gtk_builder_cache_writer_start_element (GtkBuilderCacheWriter  *writer,
+                                         const gchar            *element_name,
+                                         const gchar           **names,
+                                         const gchar           **values)
+{
+  guint n_attributes;
+  guint i;
+
+  n_attributes = g_strv_length ((gchar **) names);
+
+  writer_add_word (writer, GTK_BUILDER_CACHE_START_ELEMENT);
+  writer_add_word (writer, n_attributes);
+  writer_add_word (writer,
+                   writer_add_string (writer, element_name, strlen (element_name)));
+
+  for (i = 0; i < n_attributes; i++)
+    {
+      writer_add_word (writer,
+                       writer_add_string (writer, names[i], strlen (names[i])));
+      writer_add_word (writer,
+                       writer_add_string (writer, values[i], strlen (values[i])));
+    }
+}
+
+void
+_gtk_builder_cache_writer_end_element (GtkBuilderCacheWriter *writer,
+                                       const gchar           *element_name)
+{
+  writer_add_word (writer, GTK_BUILDER_CACHE_END_ELEMENT);
+  writer_add_word (writer,
+                   writer_add_string (writer, element_name, strlen (element_name)));
+}
+
+void
+_gtk_builder_cache_writer_text (GtkBuilderCacheWriter *writer,
+                                const gchar           *text,
+                                gsize                  text_len)
+{
+  writer_add_word (writer, GTK_BUILDER_CACHE_TEXT);
+  writer_add_word (writer, writer_add_string (writer, text, text_len));
+}
+
+static void
+append_word (GString *out,
+             guint32  word)
+{
+  word = GUINT32_TO_BE (word);
+  g_string_append_len (out, (const gchar *) &word, 4);
+}
+
+/* Frees @writer and returns the recorded events in the format
+ * described in gtkbuildercache.h.
+ */
+GString *
+_gtk_builder_cache_writer_finish (GtkBuilderCacheWriter *writer,
+                                  guint32                source_size,
+                                  guint32                source_mtime)
+{
+  GString *out;
+  guint32 events_offset, strings_offset, offset;
+  guint i;
+
+  events_offset = GTK_BUILDER_CACHE_HEADER_SIZE;
+  strings_offset = events_offset + writer->events->len * 4;
+
+  out = g_string_new (NULL);
+
+  g_string_append_len (out, GTK_BUILDER_CACHE_MAGIC, GTK_BUILDER_CACHE_MAGIC_LEN);
+  append_word (out, GTK_BUILDER_CACHE_VERSION);
+  append_word (out, source_size);
+  append_word (out, source_mtime);
+  append_word (out, events_offset);
+  append_word (out, writer->events->len);
+  append_word (out, strings_offset);
+  append_word (out, writer->strings->len);
+
+  for (i = 0; i < writer->events->len; i++)
+    append_word (out, g_array_index (writer->events, guint32, i));
+
+  offset = strings_offset + writer->strings->len * 4;
+  for (i = 0; i < writer->strings->len; i++)
+    {
+      append_word (out, offset);
+      offset += strlen (g_ptr_array_index (writer->strings, i)) + 1;
+    }
+
+  for (i = 0; i < writer->strings->len; i++)
+    {
+      const gchar *string = g_ptr_array_index (writer->strings, i);
+
+      g_string_append_len (out, string, strlen (string) + 1);
+    }
+
+  _gtk_builder_cache_writer_free (writer);
+
+  return out;
+}
+
+void
+_gtk_builder_cache_writer_free (GtkBuilderCacheWriter *writer)
+{
+  guint i;
+
+  g_hash_table_destroy (writer->string_index);
+  for (i = 0; i < writer->strings->len; i++)
+    g_free (g_ptr_array_index (writer->strings, i));
+  g_ptr_array_free (writer->strings, TRUE);
+  g_array_free (writer->events, TRUE);
+  g_slice_free (GtkBuilderCacheWriter, writer);
+}
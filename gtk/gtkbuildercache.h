@@ -0,0 +1,90 @@
+/* gtkbuildercache.h
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GTK_BUILDER_CACHE_H__
+#define __GTK_BUILDER_CACHE_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* Precompiled UI definitions, as written by gtk-builder-compile.
+ *
+ * A compiled file is stored next to the UI definition it was made
+ * from, with GTK_BUILDER_CACHE_SUFFIX appended to the file name. It
+ * contains the parse events of the definition, with all element
+ * names, attributes and text stored once in a string pool, so that
+ * loading it does not involve any XML tokenizing, unescaping or
+ * string copying. All numbers are 32 bit big endian.
+ *
+ * Header:
+ *   0  magic, GTK_BUILDER_CACHE_MAGIC
+ *   8  format version, GTK_BUILDER_CACHE_VERSION
+ *  12  size of the UI definition
+ *  16  modification time of the UI definition
+ *  20  offset of the event stream
+ *  24  number of words in the event stream
+ *  28  offset of the string table
+ *  32  number of strings
+ *
+ * The string table is an array of offsets to nul-terminated strings.
+ * The event stream is a sequence of records:
+ *
+ *   GTK_BUILDER_CACHE_START_ELEMENT n_attributes name
+ *                                   (attribute_name attribute_value)*
+ *   GTK_BUILDER_CACHE_END_ELEMENT name
+ *   GTK_BUILDER_CACHE_TEXT text
+ *
+ * where names, values and text are indices into the string table.
+ *
+ * The file is considered stale, and the UI definition is parsed
+ * instead, if the size or modification time do not match.
+ */
+
+#define GTK_BUILDER_CACHE_SUFFIX       "c"
+#define GTK_BUILDER_CACHE_MAGIC        "GtkBldr"
+#define GTK_BUILDER_CACHE_MAGIC_LEN    8
+#define GTK_BUILDER_CACHE_VERSION      1
+#define GTK_BUILDER_CACHE_HEADER_SIZE  36
+
+enum {
+  GTK_BUILDER_CACHE_START_ELEMENT = 1,
+  GTK_BUILDER_CACHE_END_ELEMENT,
+  GTK_BUILDER_CACHE_TEXT
+};
+
+typedef struct _GtkBuilderCacheWriter GtkBuilderCacheWriter;
+
+GtkBuilderCacheWriter *_gtk_builder_cache_writer_new           (void);
+void                   _gtk_builder_cache_writer_start_element (GtkBuilderCacheWriter  *writer,
+                                                                const gchar            *element_name,
+                                                                const gchar           **names,
+                                                                const gchar           **values);
+void                   _gtk_builder_cache_writer_end_element   (GtkBuilderCacheWriter  *writer,
+                                                                const gchar            *element_name);
+void                   _gtk_builder_cache_writer_text          (GtkBuilderCacheWriter  *writer,
+                                                                const gchar            *text,
+                                                                gsize                   text_len);
+GString *              _gtk_builder_cache_writer_finish        (GtkBuilderCacheWriter  *writer,
+                                                                guint32                 source_size,
+                                                                guint32                 source_mtime);
+void                   _gtk_builder_cache_writer_free          (GtkBuilderCacheWriter  *writer);
+
+G_END_DECLS
+
+#endif /* __GTK_BUILDER_CACHE_H__ */
@@ -21,10 +21,14 @@
 #include "config.h"
 
 #include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 #include <gmodule.h>
+#include <glib/gstdio.h>
 
 #include "gtktypeutils.h"
 #include "gtkbuilderprivate.h"
+#include "gtkbuildercache.h"
 #include "gtkbuilder.h"
 #include "gtkbuildable.h"
 #include "gtkdebug.h"
@@ -106,6 +110,25 @@ error_invalid_attribute (ParserData *data,
                line_number, char_number, attribute, tag);
 }
 
+static void
+error_duplicate_id (ParserData  *data,
+                    const gchar *id,
+                    GError     **error)
+{
+  gint line_number, char_number;
+
+  g_markup_parse_context_get_position (data->ctx,
+                                       &line_number,
+                                       &char_number);
+
+  g_set_error (error,
+               GTK_BUILDER_ERROR,
+               GTK_BUILDER_ERROR_INVALID_VALUE,
+               "%s:%d:%d Duplicate id of deferred object \"%s\"",
+               data->filename,
+               line_number, char_number, id);
+}
+
 static void
 error_invalid_tag (ParserData *data,
 		   const gchar *tag,
@@ -326,6 +349,10 @@ parse_object (ParserData   *data,
         object_id = g_strdup (values[i]);
       else if (strcmp (names[i], "constructor") == 0)
         constructor = g_strdup (values[i]);
+      else if (strcmp (names[i], "deferred") == 0)
+        {
+          /* Only honoured on toplevel objects, see parse_deferred() */
+        }
       else if (strcmp (names[i], "type-func") == 0)
         {
 	  /* Call the GType function, and return the name of the GType,
@@ -788,6 +815,128 @@ parse_custom (GMarkupParseContext *context,
   return TRUE;
 }
 
+/* Deferred objects: the events of a toplevel <object deferred="True">
+ * are recorded in the compiled format, wrapped in an <interface>, and
+ * only replayed when one of the objects in it is first needed.
+ */
+static gboolean
+record_start_element (ParserData   *data,
+                      const gchar  *element_name,
+                      const gchar **names,
+                      const gchar **values,
+                      GError      **error)
+{
+  const gchar **record_names;
+  const gchar **record_values;
+  gint i, n;
+
+  n = g_strv_length ((gchar **) names);
+  record_names = g_new (const gchar *, n + 1);
+  record_values = g_new (const gchar *, n + 1);
+
+  for (i = 0, n = 0; names[i] != NULL; i++)
+    {
+      if (strcmp (names[i], "deferred") == 0)
+        continue;
+
+      if (strcmp (element_name, "object") == 0 &&
+          strcmp (names[i], "id") == 0)
+        {
+          /* Each id can only be registered for one deferred object */
+          if (_gtk_builder_has_deferred (data->builder, values[i]) ||
+              g_slist_find_custom (data->deferred_ids, values[i],
+                                   (GCompareFunc) strcmp))
+            {
+              error_duplicate_id (data, values[i], error);
+              g_free (record_names);
+              g_free (record_values);
+              return FALSE;
+            }
+
+          data->deferred_ids = g_slist_prepend (data->deferred_ids,
+                                                g_strdup (values[i]));
+        }
+
+      record_names[n] = names[i];
+      record_values[n] = values[i];
+      n++;
+    }
+  record_names[n] = NULL;
+  record_values[n] = NULL;
+
+  _gtk_builder_cache_writer_start_element (data->deferred, element_name,
+                                           record_names, record_values);
+  data->deferred_level++;
+
+  g_free (record_names);
+  g_free (record_values);
+
+  return TRUE;
+}
+
+static void
+record_end_element (ParserData  *data,
+                    const gchar *element_name)
+{
+  DeferredInfo *info;
+
+  _gtk_builder_cache_writer_end_element (data->deferred, element_name);
+
+  if (--data->deferred_level > 0)
+    return;
+
+  _gtk_builder_cache_writer_end_element (data->deferred, "interface");
+
+  info = g_slice_new (DeferredInfo);
+  info->filename = g_strdup (data->filename);
+  info->domain = g_strdup (data->domain);
+  info->ids = data->deferred_ids;
+  info->events = _gtk_builder_cache_writer_finish (data->deferred, 0, 0);
+
+  data->deferred = NULL;
+  data->deferred_ids = NULL;
+
+  _gtk_builder_add_deferred (data->builder, info);
+}
+
+static gboolean
+parse_deferred (ParserData   *data,
+                const gchar  *element_name,
+                const gchar **names,
+                const gchar **values,
+                GError      **error)
+{
+  static const gchar *no_attributes[] = { NULL };
+  gboolean deferred = FALSE;
+  const gchar *id = NULL;
+  gint i;
+
+  for (i = 0; names[i] != NULL; i++)
+    {
+      if (strcmp (names[i], "deferred") == 0)
+        {
+          if (!_gtk_builder_boolean_from_string (values[i], &deferred, error))
+            return TRUE;
+        }
+      else if (strcmp (names[i], "id") == 0)
+        id = values[i];
+    }
+
+  /* Objects without an id are left to parse_object() to complain about */
+  if (!deferred || !id)
+    return FALSE;
+
+  GTK_NOTE (BUILDER, g_print ("deferring object \"%s\"\n", id));
+
+  data->deferred = _gtk_builder_cache_writer_new ();
+  data->deferred_level = 0;
+  _gtk_builder_cache_writer_start_element (data->deferred, "interface",
+                                           no_attributes, no_attributes);
+  record_start_element (data, element_name, names, values, error);
+
+  return TRUE;
+}
+
 static void
 start_element (GMarkupParseContext *context,
                const gchar         *element_name,
@@ -826,6 +975,18 @@ start_element (GMarkupParseContext *context,
     }
   data->last_element = element_name;
 
+  if (data->deferred)
+    {
+      record_start_element (data, element_name, names, values, error);
+      return;
+    }
+
+  if (strcmp (element_name, "object") == 0 &&
+      data->cur_object_level == 0 &&
+      !data->requested_objects &&
+      parse_deferred (data, element_name, names, values, error))
+    return;
+
   if (data->subparser)
     if (!subparser_start (context, element_name, names, values,
 			  data, error))
@@ -923,6 +1084,12 @@ end_element (GMarkupParseContext *context,
 
   GTK_NOTE (BUILDER, g_print ("</%s>\n", element_name));
 
+  if (data->deferred)
+    {
+      record_end_element (data, element_name);
+      return;
+    }
+
   if (data->subparser && data->subparser->start)
     {
       subparser_end (context, element_name, data, error);
@@ -1057,6 +1224,12 @@ text (GMarkupParseContext *context,
   ParserData *data = (ParserData*)user_data;
   CommonInfo *info;
 
+  if (data->deferred)
+    {
+      _gtk_builder_cache_writer_text (data->deferred, text, text_len);
+      return;
+    }
+
   if (data->subparser && data->subparser->start)
     {
       GError *tmp_error = NULL;
@@ -1075,7 +1248,11 @@ text (GMarkupParseContext *context,
   info = state_peek_info (data, CommonInfo);
   g_assert (info != NULL);
 
-  if (strcmp (g_markup_parse_context_get_element (context), "property") == 0)
+  /* Don't ask the context for the current element, there is
+   * no markup being parsed when loading a compiled UI definition.
+   * Only <property> pushes a PropertyInfo and has text content.
+   */
+  if (strcmp (info->tag.name, "property") == 0)
     {
       PropertyInfo *prop_info = (PropertyInfo*)info;
 
@@ -1108,17 +1285,13 @@ static const GMarkupParser parser = {
   NULL
 };
 
-void
-_gtk_builder_parser_parse_buffer (GtkBuilder   *builder,
-                                  const gchar  *filename,
-                                  const gchar  *buffer,
-                                  gsize         length,
-                                  gchar       **requested_objs,
-                                  GError      **error)
+static ParserData *
+parser_data_new (GtkBuilder   *builder,
+                 const gchar  *filename,
+                 gchar       **requested_objs)
 {
   ParserData *data;
-  GSList *l;
-  
+
   data = g_new0 (ParserData, 1);
   data->builder = builder;
   data->filename = filename;
@@ -1146,8 +1319,14 @@ _gtk_builder_parser_parse_buffer (GtkBuilder   *builder,
                                           G_MARKUP_TREAT_CDATA_AS_TEXT, 
                                           data, NULL);
 
-  if (!g_markup_parse_context_parse (data->ctx, buffer, length, error))
-    goto out;
+  return data;
+}
+
+static void
+parser_data_finish (ParserData *data)
+{
+  GtkBuilder *builder = data->builder;
+  GSList *l;
 
   _gtk_builder_finish (builder);
 
@@ -1171,9 +1350,11 @@ _gtk_builder_parser_parse_buffer (GtkBuilder   *builder,
       GtkBuildable *buildable = (GtkBuildable*)l->data;
       gtk_buildable_parser_finished (GTK_BUILDABLE (buildable), builder);
     }
+}
 
- out:
-
+static void
+parser_data_free (ParserData *data)
+{
   g_slist_foreach (data->stack, (GFunc)free_info, NULL);
   g_slist_free (data->stack);
   g_slist_foreach (data->custom_finalizers, (GFunc)free_subparser, NULL);
@@ -1181,7 +1362,290 @@ _gtk_builder_parser_parse_buffer (GtkBuilder   *builder,
   g_slist_free (data->finalizers);
   g_slist_foreach (data->requested_objects, (GFunc) g_free, NULL);
   g_slist_free (data->requested_objects);
+  if (data->deferred)
+    _gtk_builder_cache_writer_free (data->deferred);
+  g_slist_foreach (data->deferred_ids, (GFunc) g_free, NULL);
+  g_slist_free (data->deferred_ids);
   g_free (data->domain);
   g_markup_parse_context_free (data->ctx);
   g_free (data);
 }
+
+void
+_gtk_builder_parser_parse_buffer (GtkBuilder   *builder,
+                                  const gchar  *filename,
+                                  const gchar  *buffer,
+                                  gsize         length,
+                                  gchar       **requested_objs,
+                                  GError      **error)
+{
+  ParserData *data;
+  
+  data = parser_data_new (builder, filename, requested_objs);
+
+  if (g_markup_parse_context_parse (data->ctx, buffer, length, error))
+    parser_data_finish (data);
+
+  parser_data_free (data);
+}
+
+/* Precompiled UI definitions, see gtkbuildercache.h */
+
+#define CACHE_WORD(cache, offset) \
+  (GUINT32_FROM_BE (*(guint32 *)((cache) + (offset))))
+
+/*
+ * _gtk_builder_cache_open:
+ * @filename: the name of a UI definition
+ *
+ * Maps the precompiled version of @filename, if there is one and it
+ * is up to date.
+ *
+ * Returns: the mapped file, or %NULL if @filename must be parsed
+ */
+GMappedFile *
+_gtk_builder_cache_open (const gchar *filename)
+{
+  GMappedFile *map;
+  struct stat st;
+  const gchar *cache;
+  gchar *cache_filename;
+  gsize length;
+  guint32 events_offset, n_words, strings_offset, n_strings, i;
+
+  if (g_stat (filename, &st) < 0)
+    return NULL;
+
+  cache_filename = g_strconcat (filename, GTK_BUILDER_CACHE_SUFFIX, NULL);
+  map = g_mapped_file_new (cache_filename, FALSE, NULL);
+  g_free (cache_filename);
+
+  if (!map)
+    return NULL;
+
+  cache = g_mapped_file_get_contents (map);
+  length = g_mapped_file_get_length (map);
+
+  if (length < GTK_BUILDER_CACHE_HEADER_SIZE ||
+      memcmp (cache, GTK_BUILDER_CACHE_MAGIC, GTK_BUILDER_CACHE_MAGIC_LEN) != 0 ||
+      CACHE_WORD (cache, 8) != GTK_BUILDER_CACHE_VERSION)
+    goto invalid;
+
+  if (CACHE_WORD (cache, 12) != (guint32) st.st_size ||
+      CACHE_WORD (cache, 16) != (guint32) st.st_mtime)
+    {
+      GTK_NOTE (BUILDER, g_print ("ignoring stale compiled file for %s\n", filename));
+      goto invalid;
+    }
+
+  events_offset = CACHE_WORD (cache, 20);
+  n_words = CACHE_WORD (cache, 24);
+  strings_offset = CACHE_WORD (cache, 28);
+  n_strings = CACHE_WORD (cache, 32);
+
+  if (events_offset % 4 != 0 || strings_offset % 4 != 0 ||
+      events_offset > length || n_words > (length - events_offset) / 4 ||
+      strings_offset > length || n_strings > (length - strings_offset) / 4)
+    goto invalid;
+
+  /* Check the string table once, so that strings can be used
+   * directly from the mapping afterwards.
+   */
+  for (i = 0; i < n_strings; i++)
+    {
+      guint32 offset = CACHE_WORD (cache, strings_offset + 4 * i);
+
+      if (offset >= length ||
+          memchr (cache + offset, '\0', length - offset) == NULL)
+        goto invalid;
+    }
+
+  return map;
+
+ invalid:
+  g_mapped_file_free (map);
+
+  return NULL;
+}
+
+static gboolean
+replay_cache (ParserData   *data,
+              const gchar  *cache,
+              GError      **error)
+{
+  guint32 events_offset, n_words, strings_offset, n_strings;
+  const gchar **attributes = NULL;
+  guint32 n_attributes_allocated = 0;
+  GArray *elements;
+  GError *tmp_error = NULL;
+  guint32 i;
+
+  events_offset = CACHE_WORD (cache, 20);
+  n_words = CACHE_WORD (cache, 24);
+  strings_offset = CACHE_WORD (cache, 28);
+  n_strings = CACHE_WORD (cache, 32);
+
+#define EVENT(n) (CACHE_WORD (cache, events_offset + 4 * (n)))
+#define STRING(n) (cache + CACHE_WORD (cache, strings_offset + 4 * (n)))
+
+  elements = g_array_new (FALSE, FALSE, sizeof (guint32));
+
+  i = 0;
+  while (i < n_words && tmp_error == NULL)
+    {
+      guint32 type = EVENT (i);
+      guint32 name, n_attributes, j;
+
+      switch (type)
+        {
+        case GTK_BUILDER_CACHE_START_ELEMENT:
+          if (n_words - i < 3)
+            goto corrupt;
+          n_attributes = EVENT (i + 1);
+          name = EVENT (i + 2);
+          i += 3;
+
+          if (name >= n_strings || n_attributes > (n_words - i) / 2)
+            goto corrupt;
+
+          if (n_attributes + 1 > n_attributes_allocated)
+            {
+              n_attributes_allocated = n_attributes + 1;
+              attributes = g_renew (const gchar *, attributes,
+                                    2 * n_attributes_allocated);
+            }
+
+          for (j = 0; j < n_attributes; j++)
+            {
+              guint32 attr_name = EVENT (i + 2 * j);
+              guint32 attr_value = EVENT (i + 2 * j + 1);
+
+              if (attr_name >= n_strings || attr_value >= n_strings)
+                goto corrupt;
+
+              attributes[j] = STRING (attr_name);
+              attributes[n_attributes_allocated + j] = STRING (attr_value);
+            }
+          attributes[n_attributes] = NULL;
+          attributes[n_attributes_allocated + n_attributes] = NULL;
+          i += 2 * n_attributes;
+
+          g_array_append_val (elements, name);
+          start_element (data->ctx, STRING (name),
+                         attributes, attributes + n_attributes_allocated,
+                         data, &tmp_error);
+          break;
+
+        case GTK_BUILDER_CACHE_END_ELEMENT:
+          if (n_words - i < 2)
+            goto corrupt;
+          name = EVENT (i + 1);
+          i += 2;
+
+          if (elements->len == 0 ||
+              g_array_index (elements, guint32, elements->len - 1) != name)
+            goto corrupt;
+          g_array_set_size (elements, elements->len - 1);
+
+          end_element (data->ctx, STRING (name), data, &tmp_error);
+          break;
+
+        case GTK_BUILDER_CACHE_TEXT:
+          if (n_words - i < 2)
+            goto corrupt;
+          name = EVENT (i + 1);
+          i += 2;
+
+          if (name >= n_strings)
+            goto corrupt;
+
+          text (data->ctx, STRING (name), strlen (STRING (name)),
+                data, &tmp_error);
+          break;
+
+        default:
+          goto corrupt;
+        }
+    }
+
+  if (tmp_error == NULL && elements->len != 0)
+    goto corrupt;
+
+#undef EVENT
+#undef STRING
+
+  g_array_free (elements, TRUE);
+  g_free (attributes);
+
+  if (tmp_error)
+    {
+      g_propagate_error (error, tmp_error);
+      return FALSE;
+    }
+
+  return TRUE;
+
+ corrupt:
+  g_array_free (elements, TRUE);
+  g_free (attributes);
+
+  g_set_error (error,
+               G_MARKUP_ERROR,
+               G_MARKUP_ERROR_PARSE,
+               "%s: compiled UI definition is corrupt",
+               data->filename);
+
+  return FALSE;
+}
+
+/*
+ * _gtk_builder_parser_parse_cache:
+ * @builder: a #GtkBuilder
+ * @filename: the name of the UI definition
+ * @map: the compiled UI definition, as returned by _gtk_builder_cache_open()
+ * @requested_objs: the objects to build, or %NULL for all
+ * @error: return location for an error
+ *
+ * Like _gtk_builder_parser_parse_buffer(), for a compiled UI definition.
+ */
+void
+_gtk_builder_parser_parse_cache (GtkBuilder   *builder,
+                                 const gchar  *filename,
+                                 GMappedFile  *map,
+                                 gchar       **requested_objs,
+                                 GError      **error)
+{
+  ParserData *data;
+
+  data = parser_data_new (builder, filename, requested_objs);
+
+  if (replay_cache (data, g_mapped_file_get_contents (map), error))
+    parser_data_finish (data);
+
+  parser_data_free (data);
+}
+
+/*
+ * _gtk_builder_parser_parse_deferred:
+ * @builder: a #GtkBuilder
+ * @info: a deferred object, as passed to _gtk_builder_add_deferred()
+ * @error: return location for an error
+ *
+ * Constructs the objects recorded in @info.
+ */
+void
+_gtk_builder_parser_parse_deferred (GtkBuilder    *builder,
+                                    DeferredInfo  *info,
+                                    GError       **error)
+{
+  ParserData *data;
+
+  data = parser_data_new (builder, info->filename, NULL);
+  g_free (data->domain);
+  data->domain = g_strdup (info->domain);
+
+  if (replay_cache (data, info->events->str, error))
+    parser_data_finish (data);
+
+  parser_data_free (data);
+}
@@ -22,6 +22,7 @@
 #define __GTK_BUILDER_PRIVATE_H__
 
 #include "gtkbuilder.h"
+#include "gtkbuildercache.h"
 
 typedef struct {
   const gchar *name;
@@ -77,6 +78,13 @@ typedef struct {
   gint     minor;
 } RequiresInfo;
 
+typedef struct {
+  gchar *filename;
+  gchar *domain;
+  GSList *ids;
+  GString *events;
+} DeferredInfo;
+
 typedef struct {
   GMarkupParser *parser;
   gchar *tagname;
@@ -101,6 +109,10 @@ typedef struct {
   gboolean inside_requested_object;
   gint requested_object_level;
   gint cur_object_level;
+
+  GtkBuilderCacheWriter *deferred; /* non-NULL while recording a deferred object */
+  gint deferred_level;
+  GSList *deferred_ids;
 } ParserData;
 
 typedef GType (*GTypeGetFunc) (void);
@@ -112,6 +124,15 @@ void _gtk_builder_parser_parse_buffer (GtkBuilder *builder,
                                        gsize length,
                                        gchar **requested_objs,
                                        GError **error);
+GMappedFile * _gtk_builder_cache_open (const gchar *filename);
+void _gtk_builder_parser_parse_cache (GtkBuilder *builder,
+                                      const gchar *filename,
+                                      GMappedFile *map,
+                                      gchar **requested_objs,
+                                      GError **error);
+void _gtk_builder_parser_parse_deferred (GtkBuilder *builder,
+                                         DeferredInfo *info,
+                                         GError **error);
 GObject * _gtk_builder_construct (GtkBuilder *builder,
                                   ObjectInfo *info,
 				  GError    **error);
@@ -119,6 +140,10 @@ void      _gtk_builder_add (GtkBuilder *builder,
                             ChildInfo *child_info);
 void      _gtk_builder_add_signals (GtkBuilder *builder,
 				    GSList     *signals);
+void      _gtk_builder_add_deferred (GtkBuilder   *builder,
+                                     DeferredInfo *info);
+gboolean  _gtk_builder_has_deferred (GtkBuilder   *builder,
+                                     const gchar  *id);
 void      _gtk_builder_finish (GtkBuilder *builder);
 void _free_signal_info (SignalInfo *info,
                         gpointer user_data);
@@ -19,6 +19,7 @@
 
 #include "config.h"
 #include <stdlib.h>
+#include <string.h>
 #include "gtkcellrenderertext.h"
 #include "gtkeditable.h"
 #include "gtkentry.h"
@@ -1353,6 +1354,54 @@ gtk_cell_renderer_text_new (void)
   return g_object_new (GTK_TYPE_CELL_RENDERER_TEXT, NULL);
 }
 
+/* Layouts are cached per widget, so that cells showing the same text
+ * with the same attributes share one shaped PangoLayout, and a row that
+ * is measured and then drawn only shapes its text once.
+ */
+#define LAYOUT_CACHE_SIZE 512
+
+typedef struct _GtkCellRendererTextLayoutKey   GtkCellRendererTextLayoutKey;
+typedef struct _GtkCellRendererTextLayoutEntry GtkCellRendererTextLayoutEntry;
+typedef struct _GtkCellRendererTextLayoutCache GtkCellRendererTextLayoutCache;
+
+struct _GtkCellRendererTextLayoutKey
+{
+  gchar *text;
+  PangoFontDescription *font;
+  PangoLanguage *language;
+  gdouble font_scale;
+  PangoColor foreground;
+  PangoUnderline underline_style;
+  gint rise;
+  gint wrap_width;
+  PangoWrapMode wrap_mode;
+  PangoEllipsizeMode ellipsize;
+  PangoAlignment align;
+
+  guint foreground_set : 1;
+  guint strikethrough_set : 1;
+  guint strikethrough : 1;
+  guint scale_set : 1;
+  guint language_set : 1;
+  guint underline_set : 1;
+  guint rise_set : 1;
+  guint single_paragraph : 1;
+};
+
+struct _GtkCellRendererTextLayoutEntry
+{
+  GtkCellRendererTextLayoutKey key;
+  PangoLayout *layout;
+};
+
+struct _GtkCellRendererTextLayoutCache
+{
+  GHashTable *layouts;
+  GQueue *lru;
+};
+
+static GQuark layout_cache_quark = 0;
+
 static void
 add_attr (PangoAttrList  *attr_list,
           PangoAttribute *attr)
@@ -1363,27 +1412,23 @@ add_attr (PangoAttrList  *attr_list,
   pango_attr_list_insert (attr_list, attr);
 }
 
-static PangoLayout*
-get_layout (GtkCellRendererText *celltext,
-            GtkWidget           *widget,
-            gboolean             will_render,
-            GtkCellRendererState flags)
+static void
+layout_key_init (GtkCellRendererTextLayoutKey *key,
+                 GtkCellRendererText          *celltext,
+                 GtkWidget                    *widget,
+                 gboolean                      will_render,
+                 GtkCellRendererState          flags)
 {
-  PangoAttrList *attr_list;
-  PangoLayout *layout;
-  PangoUnderline uline;
   GtkCellRendererTextPrivate *priv;
+  PangoUnderline uline;
 
   priv = GTK_CELL_RENDERER_TEXT_GET_PRIVATE (celltext);
-  
-  layout = gtk_widget_create_pango_layout (widget, celltext->text);
 
-  if (celltext->extra_attrs)
-    attr_list = pango_attr_list_copy (celltext->extra_attrs);
-  else
-    attr_list = pango_attr_list_new ();
+  memset (key, 0, sizeof (GtkCellRendererTextLayoutKey));
 
-  pango_layout_set_single_paragraph_mode (layout, priv->single_paragraph);
+  key->text = celltext->text;
+  key->font = celltext->font;
+  key->single_paragraph = priv->single_paragraph;
 
   if (will_render)
     {
@@ -1396,24 +1441,23 @@ get_layout (GtkCellRendererText *celltext,
       if (celltext->foreground_set
 	  && (flags & GTK_CELL_RENDERER_SELECTED) == 0)
         {
-          PangoColor color;
-
-          color = celltext->foreground;
-          
-          add_attr (attr_list,
-                    pango_attr_foreground_new (color.red, color.green, color.blue));
+          key->foreground_set = TRUE;
+          key->foreground = celltext->foreground;
         }
 
       if (celltext->strikethrough_set)
-        add_attr (attr_list,
-                  pango_attr_strikethrough_new (celltext->strikethrough));
+        {
+          key->strikethrough_set = TRUE;
+          key->strikethrough = celltext->strikethrough;
+        }
     }
 
-  add_attr (attr_list, pango_attr_font_desc_new (celltext->font));
-
   if (celltext->scale_set &&
       celltext->font_scale != 1.0)
-    add_attr (attr_list, pango_attr_scale_new (celltext->font_scale));
+    {
+      key->scale_set = TRUE;
+      key->font_scale = celltext->font_scale;
+    }
   
   if (celltext->underline_set)
     uline = celltext->underline_style;
@@ -1421,7 +1465,10 @@ get_layout (GtkCellRendererText *celltext,
     uline = PANGO_UNDERLINE_NONE;
 
   if (priv->language_set)
-    add_attr (attr_list, pango_attr_language_new (priv->language));
+    {
+      key->language_set = TRUE;
+      key->language = priv->language;
+    }
   
   if ((flags & GTK_CELL_RENDERER_PRELIT) == GTK_CELL_RENDERER_PRELIT)
     {
@@ -1441,40 +1488,140 @@ get_layout (GtkCellRendererText *celltext,
     }
 
   if (uline != PANGO_UNDERLINE_NONE)
-    add_attr (attr_list, pango_attr_underline_new (celltext->underline_style));
+    {
+      key->underline_set = TRUE;
+      key->underline_style = celltext->underline_style;
+    }
 
   if (celltext->rise_set)
-    add_attr (attr_list, pango_attr_rise_new (celltext->rise));
+    {
+      key->rise_set = TRUE;
+      key->rise = celltext->rise;
+    }
 
   if (priv->ellipsize_set)
-    pango_layout_set_ellipsize (layout, priv->ellipsize);
+    key->ellipsize = priv->ellipsize;
   else
-    pango_layout_set_ellipsize (layout, PANGO_ELLIPSIZE_NONE);
+    key->ellipsize = PANGO_ELLIPSIZE_NONE;
 
+  key->wrap_width = priv->wrap_width;
   if (priv->wrap_width != -1)
-    {
-      pango_layout_set_width (layout, priv->wrap_width * PANGO_SCALE);
-      pango_layout_set_wrap (layout, priv->wrap_mode);
-    }
+    key->wrap_mode = priv->wrap_mode;
   else
-    {
-      pango_layout_set_width (layout, -1);
-      pango_layout_set_wrap (layout, PANGO_WRAP_CHAR);
-    }
+    key->wrap_mode = PANGO_WRAP_CHAR;
 
   if (priv->align_set)
-    pango_layout_set_alignment (layout, priv->align);
+    key->align = priv->align;
+  else if (gtk_widget_get_direction (widget) == GTK_TEXT_DIR_RTL)
+    key->align = PANGO_ALIGN_RIGHT;
   else
-    {
-      PangoAlignment align;
+    key->align = PANGO_ALIGN_LEFT;
+}
 
-      if (gtk_widget_get_direction (widget) == GTK_TEXT_DIR_RTL)
-	align = PANGO_ALIGN_RIGHT;
-      else
-	align = PANGO_ALIGN_LEFT;
+static guint
+layout_key_hash (gconstpointer data)
+{
+  const GtkCellRendererTextLayoutKey *key = data;
+  guint hash;
 
-      pango_layout_set_alignment (layout, align);
-    }
+  hash = g_str_hash (key->text ? key->text : "");
+  hash ^= pango_font_description_hash (key->font);
+  hash ^= (guint) key->wrap_width << 8;
+  hash ^= key->ellipsize << 4;
+  hash ^= key->foreground_set | (key->underline_set << 1);
+
+  return hash;
+}
+
+static gboolean
+layout_key_equal (gconstpointer a,
+                  gconstpointer b)
+{
+  const GtkCellRendererTextLayoutKey *key1 = a;
+  const GtkCellRendererTextLayoutKey *key2 = b;
+
+  if (key1->foreground_set != key2->foreground_set ||
+      key1->strikethrough_set != key2->strikethrough_set ||
+      key1->strikethrough != key2->strikethrough ||
+      key1->scale_set != key2->scale_set ||
+      key1->language_set != key2->language_set ||
+      key1->underline_set != key2->underline_set ||
+      key1->rise_set != key2->rise_set ||
+      key1->single_paragraph != key2->single_paragraph)
+    return FALSE;
+
+  if (key1->font_scale != key2->font_scale ||
+      key1->language != key2->language ||
+      key1->underline_style != key2->underline_style ||
+      key1->rise != key2->rise ||
+      key1->wrap_width != key2->wrap_width ||
+      key1->wrap_mode != key2->wrap_mode ||
+      key1->ellipsize != key2->ellipsize ||
+      key1->align != key2->align)
+    return FALSE;
+
+  if (key1->foreground_set &&
+      (key1->foreground.red != key2->foreground.red ||
+       key1->foreground.green != key2->foreground.green ||
+       key1->foreground.blue != key2->foreground.blue))
+    return FALSE;
+
+  if (strcmp (key1->text ? key1->text : "", key2->text ? key2->text : "") != 0)
+    return FALSE;
+
+  return pango_font_description_equal (key1->font, key2->font);
+}
+
+static PangoLayout *
+layout_new_from_key (GtkWidget                          *widget,
+                     const GtkCellRendererTextLayoutKey *key,
+                     PangoAttrList                      *extra_attrs)
+{
+  PangoAttrList *attr_list;
+  PangoLayout *layout;
+
+  layout = gtk_widget_create_pango_layout (widget, key->text);
+
+  if (extra_attrs)
+    attr_list = pango_attr_list_copy (extra_attrs);
+  else
+    attr_list = pango_attr_list_new ();
+
+  pango_layout_set_single_paragraph_mode (layout, key->single_paragraph);
+
+  if (key->foreground_set)
+    add_attr (attr_list,
+              pango_attr_foreground_new (key->foreground.red,
+                                         key->foreground.green,
+                                         key->foreground.blue));
+
+  if (key->strikethrough_set)
+    add_attr (attr_list,
+              pango_attr_strikethrough_new (key->strikethrough));
+
+  add_attr (attr_list, pango_attr_font_desc_new (key->font));
+
+  if (key->scale_set)
+    add_attr (attr_list, pango_attr_scale_new (key->font_scale));
+
+  if (key->language_set)
+    add_attr (attr_list, pango_attr_language_new (key->language));
+
+  if (key->underline_set)
+    add_attr (attr_list, pango_attr_underline_new (key->underline_style));
+
+  if (key->rise_set)
+    add_attr (attr_list, pango_attr_rise_new (key->rise));
+
+  pango_layout_set_ellipsize (layout, key->ellipsize);
+
+  if (key->wrap_width != -1)
+    pango_layout_set_width (layout, key->wrap_width * PANGO_SCALE);
+  else
+    pango_layout_set_width (layout, -1);
+  pango_layout_set_wrap (layout, key->wrap_mode);
+
+  pango_layout_set_alignment (layout, key->align);
 
   pango_layout_set_attributes (layout, attr_list);
 
@@ -1483,6 +1630,127 @@ get_layout (GtkCellRendererText *celltext,
   return layout;
 }
 
+static void
+layout_entry_free (GtkCellRendererTextLayoutEntry *entry)
+{
+  g_free (entry->key.text);
+  pango_font_description_free (entry->key.font);
+  g_object_unref (entry->layout);
+  g_slice_free (GtkCellRendererTextLayoutEntry, entry);
+}
+
+static void
+layout_cache_clear (GtkCellRendererTextLayoutCache *cache)
+{
+  GtkCellRendererTextLayoutEntry *entry;
+
+  g_hash_table_remove_all (cache->layouts);
+
+  while ((entry = g_queue_pop_head (cache->lru)) != NULL)
+    layout_entry_free (entry);
+}
+
+static void
+layout_cache_free (GtkCellRendererTextLayoutCache *cache)
+{
+  layout_cache_clear (cache);
+
+  g_hash_table_destroy (cache->layouts);
+  g_queue_free (cache->lru);
+  g_slice_free (GtkCellRendererTextLayoutCache, cache);
+}
+
+static GtkCellRendererTextLayoutCache *
+layout_cache_get (GtkWidget *widget)
+{
+  GtkCellRendererTextLayoutCache *cache;
+
+  if (!layout_cache_quark)
+    layout_cache_quark = g_quark_from_static_string ("gtk-cell-renderer-text-layout-cache");
+
+  cache = g_object_get_qdata (G_OBJECT (widget), layout_cache_quark);
+  if (cache)
+    return cache;
+
+  cache = g_slice_new (GtkCellRendererTextLayoutCache);
+  cache->layouts = g_hash_table_new (layout_key_hash, layout_key_equal);
+  cache->lru = g_queue_new ();
+
+  g_object_set_qdata_full (G_OBJECT (widget), layout_cache_quark,
+                           cache, (GDestroyNotify) layout_cache_free);
+
+  /* The layouts are tied to the widget's PangoContext, which gets
+   * updated from the style, the text direction and the screen.
+   */
+  g_signal_connect_swapped (widget, "style-set",
+                            G_CALLBACK (layout_cache_clear), cache);
+  g_signal_connect_swapped (widget, "direction-changed",
+                            G_CALLBACK (layout_cache_clear), cache);
+  g_signal_connect_swapped (widget, "screen-changed",
+                            G_CALLBACK (layout_cache_clear), cache);
+
+  return cache;
+}
+
+static PangoLayout*
+get_layout (GtkCellRendererText *celltext,
+            GtkWidget           *widget,
+            gboolean             will_render,
+            GtkCellRendererState flags)
+{
+  GtkCellRendererTextLayoutCache *cache;
+  GtkCellRendererTextLayoutEntry *entry;
+  GtkCellRendererTextLayoutKey key;
+  GList *link;
+
+  layout_key_init (&key, celltext, widget, will_render, flags);
+
+  /* Attributes from markup are not part of the key */
+  if (celltext->extra_attrs)
+    return layout_new_from_key (widget, &key, celltext->extra_attrs);
+
+  cache = layout_cache_get (widget);
+
+  link = g_hash_table_lookup (cache->layouts, &key);
+  if (link)
+    {
+      entry = link->data;
+
+      g_queue_unlink (cache->lru, link);
+      g_queue_push_head_link (cache->lru, link);
+
+      /* render() may have changed the width for ellipsizing,
+       * this is a no-op if it did not.
+       */
+      if (key.wrap_width != -1)
+        pango_layout_set_width (entry->layout, key.wrap_width * PANGO_SCALE);
+      else
+        pango_layout_set_width (entry->layout, -1);
+
+      return g_object_ref (entry->layout);
+    }
+
+  entry = g_slice_new (GtkCellRendererTextLayoutEntry);
+  entry->key = key;
+  entry->key.text = g_strdup (key.text);
+  entry->key.font = pango_font_description_copy (key.font);
+  entry->layout = layout_new_from_key (widget, &key, NULL);
+
+  g_queue_push_head (cache->lru, entry);
+  g_hash_table_insert (cache->layouts, &entry->key, cache->lru->head);
+
+  if (cache->lru->length > LAYOUT_CACHE_SIZE)
+    {
+      GtkCellRendererTextLayoutEntry *last;
+
+      last = g_queue_pop_tail (cache->lru);
+      g_hash_table_remove (cache->layouts, &last->key);
+      layout_entry_free (last);
+    }
+
+  return g_object_ref (entry->layout);
+}
+
 static void
 get_size (GtkCellRenderer *cell,
 	  GtkWidget       *widget,
@@ -122,6 +122,7 @@ struct _GtkComboBoxPrivate
   guint auto_scroll : 1;
   guint focus_on_click : 1;
   guint button_sensitivity : 2;
+  guint over_row_limit : 1;
 
   GtkTreeViewRowSeparatorFunc row_separator_func;
   gpointer                    row_separator_data;
@@ -891,6 +892,27 @@ gtk_combo_box_class_init (GtkComboBoxClass *klass)
                                                               GTK_SHADOW_NONE,
                                                               GTK_PARAM_READABLE));
 
+  /**
+   * GtkComboBox:menu-row-limit:
+   *
+   * The largest number of toplevel rows shown in a menu. A combo box
+   * whose model has more rows pops up a list instead, which only
+   * creates the rows that are on screen. 0, the default, means no
+   * limit.
+   *
+   * Combo boxes with a wrap width always use a menu.
+   *
+   * Since: 2.14
+   */
+  gtk_widget_class_install_style_property (widget_class,
+					   g_param_spec_int ("menu-row-limit",
+							     P_("Menu row limit"),
+							     P_("Models with more rows than this are shown in a list instead of a menu"),
+							     0,
+							     G_MAXINT,
+							     0,
+							     GTK_PARAM_READABLE));
+
   g_type_class_add_private (object_class, sizeof (GtkComboBoxPrivate));
 }
 
@@ -1121,21 +1143,65 @@ gtk_combo_box_button_state_changed (GtkWidget    *widget,
   gtk_widget_queue_draw (widget);
 }
 
+static gboolean
+gtk_combo_box_over_row_limit (GtkComboBox *combo_box)
+{
+  GtkComboBoxPrivate *priv = combo_box->priv;
+  gint limit;
+
+  if (priv->wrap_width || !priv->model)
+    return FALSE;
+
+  gtk_widget_style_get (GTK_WIDGET (combo_box),
+			"menu-row-limit", &limit,
+			NULL);
+
+  return limit > 0 && gtk_tree_model_iter_n_children (priv->model, NULL) > limit;
+}
+
+/* A list popup for a model over the row limit uses fixed height mode,
+ * so that the tree view only measures and draws the rows on screen.
+ */
+static void
+gtk_combo_box_list_update_fixed_height (GtkComboBox *combo_box)
+{
+  GtkComboBoxPrivate *priv = combo_box->priv;
+  GtkTreeView *tree_view = GTK_TREE_VIEW (priv->tree_view);
+
+  if (priv->over_row_limit)
+    {
+      gtk_tree_view_column_set_sizing (priv->column,
+				       GTK_TREE_VIEW_COLUMN_FIXED);
+      gtk_tree_view_set_fixed_height_mode (tree_view, TRUE);
+    }
+  else
+    {
+      gtk_tree_view_set_fixed_height_mode (tree_view, FALSE);
+      gtk_tree_view_column_set_sizing (priv->column,
+				       GTK_TREE_VIEW_COLUMN_GROW_ONLY);
+    }
+}
+
 static void
 gtk_combo_box_check_appearance (GtkComboBox *combo_box)
 {
   GtkComboBoxPrivate *priv = combo_box->priv;
   gboolean appears_as_list;
 
+  priv->over_row_limit = gtk_combo_box_over_row_limit (combo_box);
+
   /* if wrap_width > 0, then we are in grid-mode and forced to use
    * unix style
    */
   if (priv->wrap_width)
     appears_as_list = FALSE;
   else
-    gtk_widget_style_get (GTK_WIDGET (combo_box),
-			  "appears-as-list", &appears_as_list,
-			  NULL);
+    {
+      gtk_widget_style_get (GTK_WIDGET (combo_box),
+			    "appears-as-list", &appears_as_list,
+			    NULL);
+      appears_as_list = appears_as_list || priv->over_row_limit;
+    }
 
   if (appears_as_list)
     {
@@ -1146,6 +1212,8 @@ gtk_combo_box_check_appearance (GtkComboBox *combo_box)
       /* Create the list mode widgets, if they don't already exist. */
       if (!GTK_IS_TREE_VIEW (priv->tree_view))
 	gtk_combo_box_list_setup (combo_box);
+
+      gtk_combo_box_list_update_fixed_height (combo_box);
     }
   else
     {
@@ -1997,6 +2065,9 @@ gtk_combo_box_real_popup (GtkComboBox *combo_box)
     gtk_window_group_add_window (gtk_window_get_group (GTK_WINDOW (toplevel)), 
 				 GTK_WINDOW (priv->popup_window));
 
+  if (priv->over_row_limit)
+    gtk_tree_view_column_set_fixed_width (priv->column, MAX (priv->width, 1));
+
   gtk_widget_show_all (priv->scrolled_window);
   gtk_combo_box_list_position (combo_box, &x, &y, &width, &height);
   
@@ -3351,11 +3422,27 @@ gtk_combo_box_model_row_inserted (GtkTreeModel     *model,
 				  gpointer          user_data)
 {
   GtkComboBox *combo_box = GTK_COMBO_BOX (user_data);
+  GtkComboBoxPrivate *priv = combo_box->priv;
+  gint limit;
 
-  if (combo_box->priv->tree_view)
+  if (priv->tree_view)
     gtk_combo_box_list_popup_resize (combo_box);
   else
-    gtk_combo_box_menu_row_inserted (model, path, iter, user_data);
+    {
+      gtk_widget_style_get (GTK_WIDGET (combo_box),
+			    "menu-row-limit", &limit,
+			    NULL);
+
+      /* Once the model grows past the limit, stop adding menu items
+       * and switch to a list popup.
+       */
+      if (limit > 0 && !priv->wrap_width && !priv->popup_shown &&
+	  gtk_tree_path_get_depth (path) == 1 &&
+	  gtk_tree_model_iter_n_children (model, NULL) > limit)
+	gtk_combo_box_check_appearance (combo_box);
+      else
+	gtk_combo_box_menu_row_inserted (model, path, iter, user_data);
+    }
 
   gtk_combo_box_update_sensitivity (combo_box);
 }
@@ -3375,8 +3462,15 @@ gtk_combo_box_model_row_deleted (GtkTreeModel     *model,
       g_signal_emit (combo_box, combo_box_signals[CHANGED], 0);
     }
   
+  /* Dropping back to the menu row limit switches to a menu again */
   if (priv->tree_view)
-    gtk_combo_box_list_popup_resize (combo_box);
+    {
+      if (!priv->popup_shown &&
+	  gtk_combo_box_over_row_limit (combo_box) != priv->over_row_limit)
+	gtk_combo_box_check_appearance (combo_box);
+      else
+	gtk_combo_box_list_popup_resize (combo_box);
+    }
   else
     gtk_combo_box_menu_row_deleted (model, path, user_data);  
 
@@ -5162,6 +5256,8 @@ void
 gtk_combo_box_set_model (GtkComboBox  *combo_box,
                          GtkTreeModel *model)
 {
+  gboolean switched = FALSE;
+
   g_return_if_fail (GTK_IS_COMBO_BOX (combo_box));
   g_return_if_fail (model == NULL || GTK_IS_TREE_MODEL (model));
 
@@ -5192,6 +5288,16 @@ gtk_combo_box_set_model (GtkComboBox  *combo_box,
     g_signal_connect (combo_box->priv->model, "row-changed",
 		      G_CALLBACK (gtk_combo_box_model_row_changed),
 		      combo_box);
+
+  /* Moving over or under the menu row limit switches the popup
+   * between a list and a menu, which fills the new popup.
+   */
+  if (combo_box->priv->popup_widget &&
+      gtk_combo_box_over_row_limit (combo_box) != combo_box->priv->over_row_limit)
+    {
+      gtk_combo_box_check_appearance (combo_box);
+      switched = TRUE;
+    }
       
   if (combo_box->priv->tree_view)
     {
@@ -5203,7 +5309,7 @@ gtk_combo_box_set_model (GtkComboBox  *combo_box,
   else
     {
       /* menu mode */
-      if (combo_box->priv->popup_widget)
+      if (combo_box->priv->popup_widget && !switched)
 	gtk_combo_box_menu_fill (combo_box);
 
     }
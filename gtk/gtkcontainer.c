@@ -79,6 +79,7 @@ static void     gtk_container_base_class_finalize  (GtkContainerClass *klass);
 static void     gtk_container_class_init           (GtkContainerClass *klass);
 static void     gtk_container_init                 (GtkContainer      *container);
 static void     gtk_container_destroy              (GtkObject         *object);
+static void     gtk_container_process_resize_queue (void);
 static void     gtk_container_set_property         (GObject         *object,
 						    guint            prop_id,
 						    const GValue    *value,
@@ -146,6 +147,7 @@ static guint                 vadjustment_key_id = 0;
 static const gchar           hadjustment_key[] = "gtk-hadjustment";
 static guint                 hadjustment_key_id = 0;
 static GSList	            *container_resize_queue = NULL;
+static gboolean              container_resize_idle_pending = FALSE;
 static guint                 container_signals[LAST_SIGNAL] = { 0 };
 static GtkWidgetClass       *parent_class = NULL;
 extern GParamSpecPool       *_gtk_widget_child_property_pool;
@@ -231,6 +233,8 @@ gtk_container_class_init (GtkContainerClass *class)
 
   vadjustment_key_id = g_quark_from_static_string (vadjustment_key);
   hadjustment_key_id = g_quark_from_static_string (hadjustment_key);
+
+  gdk_window_set_frame_layout_func_libgtk_only (gtk_container_process_resize_queue);
   
   gobject_class->set_property = gtk_container_set_property;
   gobject_class->get_property = gtk_container_get_property;
@@ -1331,8 +1335,8 @@ _gtk_container_post_size_allocate (GtkContainer *container)
 static void container_scroll_focus_adjustments (GtkContainer *container, gboolean resize_update);
 #endif
 
-static gboolean
-gtk_container_idle_sizer (gpointer data)
+static void
+gtk_container_process_resize_queue (void)
 {
   /* we may be invoked with a container_resize_queue of NULL, because
    * queue_resize could have been adding an extra idle function while
@@ -1344,6 +1348,7 @@ gtk_container_idle_sizer (gpointer data)
     {
       GSList *slist;
       GtkWidget *widget;
+      GdkWindow *window;
 
       slist = container_resize_queue;
       container_resize_queue = slist->next;
@@ -1351,6 +1356,12 @@ gtk_container_idle_sizer (gpointer data)
       g_slist_free_1 (slist);
 
       GTK_PRIVATE_UNSET_FLAG (widget, GTK_RESIZE_PENDING);
+
+      /* Send the child window moves of the whole allocation at once */
+      window = GTK_WIDGET_REALIZED (widget) ? g_object_ref (widget->window) : NULL;
+      if (window)
+        gdk_window_begin_geometry_batch (window);
+
 #ifdef MAEMO_CHANGES
       collect_size_allocated_containers++;
 #endif
@@ -1358,6 +1369,12 @@ gtk_container_idle_sizer (gpointer data)
 #ifdef MAEMO_CHANGES
       collect_size_allocated_containers--;
 #endif
+
+      if (window)
+        {
+          gdk_window_end_geometry_batch (window);
+          g_object_unref (window);
+        }
     }
 
 #ifdef MAEMO_CHANGES
@@ -1391,6 +1408,14 @@ gtk_container_idle_sizer (gpointer data)
       size_allocated_containers = NULL;
     }
 #endif
+}
+
+static gboolean
+gtk_container_idle_sizer (gpointer data)
+{
+  container_resize_idle_pending = FALSE;
+
+  gtk_container_process_resize_queue ();
   
   gdk_window_process_all_updates ();
 
@@ -1430,10 +1455,19 @@ _gtk_container_queue_resize (GtkContainer *container)
 	      if (!GTK_CONTAINER_RESIZE_PENDING (resize_container))
 		{
 		  GTK_PRIVATE_SET_FLAG (resize_container, GTK_RESIZE_PENDING);
-		  if (container_resize_queue == NULL)
-		    gdk_threads_add_idle_full (GTK_PRIORITY_RESIZE,
-				     gtk_container_idle_sizer,
-				     NULL, NULL);
+		  /* Toplevels with a frame clock are laid out at the
+		   * start of their next frame
+		   */
+		  if (GTK_WIDGET_REALIZED (resize_container) &&
+		      gdk_window_get_frame_rate (GTK_WIDGET (resize_container)->window) != 0)
+		    gdk_window_schedule_frame_libgtk_only (GTK_WIDGET (resize_container)->window);
+		  else if (!container_resize_idle_pending)
+		    {
+		      container_resize_idle_pending = TRUE;
+		      gdk_threads_add_idle_full (GTK_PRIORITY_RESIZE,
+						 gtk_container_idle_sizer,
+						 NULL, NULL);
+		    }
 		  container_resize_queue = g_slist_prepend (container_resize_queue, resize_container);
 		}
 	      break;
@@ -26,6 +26,7 @@
 #include "gtkcellrenderertext.h"
 #include "gtkframe.h"
 #include "gtktreeselection.h"
+#include "gtktreestore.h"
 #include "gtktreeview.h"
 #include "gtkscrolledwindow.h"
 #include "gtkvbox.h"
@@ -156,6 +157,10 @@ static gboolean gtk_entry_completion_insert_completion   (GtkEntryCompletion *co
 static void     gtk_entry_completion_insert_completion_text (GtkEntryCompletion *completion,
                                                              const gchar *text);
 
+static void     gtk_entry_completion_index_clear         (GtkEntryCompletion *completion);
+static void     gtk_entry_completion_index_set_model     (GtkEntryCompletion *completion,
+                                                          GtkTreeModel       *model);
+
 static guint entry_completion_signals[LAST_SIGNAL] = { 0 };
 
 /* GtkBuildable */
@@ -578,6 +583,7 @@ gtk_entry_completion_set_property (GObject      *object,
 
       case PROP_TEXT_COLUMN:
 	priv->text_column = g_value_get_int (value);
+        gtk_entry_completion_index_clear (completion);
         break;
 
       case PROP_INLINE_COMPLETION:
@@ -672,6 +678,8 @@ gtk_entry_completion_finalize (GObject *object)
   if (priv->action_view)
     g_object_unref (priv->action_view);
 
+  gtk_entry_completion_index_set_model (completion, NULL);
+
   g_free (priv->case_normalized_key);
   g_free (priv->completion_prefix);
 
@@ -820,6 +828,197 @@ gtk_entry_completion_default_completion_func (GtkEntryCompletion *completion,
   return ret;
 }
 
+/* The completion index
+ *
+ * Normalizing and casefolding the text of every row on every keystroke
+ * is what makes completion slow on large models. For list and tree
+ * stores, whose iters stay valid as long as the row exists, the
+ * normalized text is kept per row, and dropped when the row changes.
+ *
+ * Rows are identified by the user_data of their iter alone; the stores
+ * leave the other fields unset. The stores free a row before emitting
+ * ::row-deleted, so the entry of a deleted row can not be found from
+ * the signal. It is harmless though: a new row that gets the same
+ * user_data drops it on ::row-inserted. Stale entries are counted, and
+ * the index is cleared once they could make up half of it.
+ *
+ * Each entry also remembers whether the row matched the last key it
+ * was checked against. When the user extends the key, a row that did
+ * not match the previous key cannot match the new one, so it is
+ * rejected without looking at its text.
+ */
+typedef struct
+{
+  GtkTreeIter iter;
+  gchar *key;
+  guint serial;
+  guint matched : 1;
+} IndexEntry;
+
+static guint
+index_entry_hash (gconstpointer key)
+{
+  const GtkTreeIter *iter = key;
+
+  return g_direct_hash (iter->user_data);
+}
+
+static gboolean
+index_entry_equal (gconstpointer a,
+                   gconstpointer b)
+{
+  const GtkTreeIter *iter_a = a;
+  const GtkTreeIter *iter_b = b;
+
+  return iter_a->user_data == iter_b->user_data;
+}
+
+static void
+index_entry_free (IndexEntry *entry)
+{
+  g_free (entry->key);
+  g_slice_free (IndexEntry, entry);
+}
+
+static void
+gtk_entry_completion_index_row_changed (GtkTreeModel       *model,
+                                        GtkTreePath        *path,
+                                        GtkTreeIter        *iter,
+                                        GtkEntryCompletion *completion)
+{
+  g_hash_table_remove (completion->priv->index, iter);
+}
+
+static void
+gtk_entry_completion_index_row_inserted (GtkTreeModel       *model,
+                                         GtkTreePath        *path,
+                                         GtkTreeIter        *iter,
+                                         GtkEntryCompletion *completion)
+{
+  GtkEntryCompletionPrivate *priv = completion->priv;
+
+  /* The new row may reuse the memory of a deleted one */
+  if (g_hash_table_remove (priv->index, iter) && priv->index_stale > 0)
+    priv->index_stale--;
+}
+
+static void
+gtk_entry_completion_index_row_deleted (GtkTreeModel       *model,
+                                        GtkTreePath        *path,
+                                        GtkEntryCompletion *completion)
+{
+  GtkEntryCompletionPrivate *priv = completion->priv;
+
+  priv->index_stale++;
+
+  if (priv->index_stale > g_hash_table_size (priv->index) / 2)
+    gtk_entry_completion_index_clear (completion);
+}
+
+static void
+gtk_entry_completion_index_clear (GtkEntryCompletion *completion)
+{
+  if (completion->priv->index)
+    g_hash_table_remove_all (completion->priv->index);
+
+  completion->priv->index_stale = 0;
+}
+
+static void
+gtk_entry_completion_index_set_model (GtkEntryCompletion *completion,
+                                      GtkTreeModel       *model)
+{
+  GtkEntryCompletionPrivate *priv = completion->priv;
+
+  if (priv->index_model)
+    {
+      g_signal_handler_disconnect (priv->index_model, priv->index_changed_id);
+      g_signal_handler_disconnect (priv->index_model, priv->index_inserted_id);
+      g_signal_handler_disconnect (priv->index_model, priv->index_deleted_id);
+      g_object_unref (priv->index_model);
+      priv->index_model = NULL;
+
+      g_hash_table_destroy (priv->index);
+      priv->index = NULL;
+    }
+
+  if (!model ||
+      !(GTK_IS_LIST_STORE (model) || GTK_IS_TREE_STORE (model)))
+    return;
+
+  priv->index_model = g_object_ref (model);
+  priv->index = g_hash_table_new_full (index_entry_hash, index_entry_equal,
+                                       NULL, (GDestroyNotify) index_entry_free);
+  priv->index_narrowing = FALSE;
+  priv->index_stale = 0;
+
+  /* These have to run before the handlers of the filter model, which
+   * check the visibility of changed rows.
+   */
+  priv->index_changed_id =
+    g_signal_connect (model, "row-changed",
+                      G_CALLBACK (gtk_entry_completion_index_row_changed),
+                      completion);
+  priv->index_inserted_id =
+    g_signal_connect (model, "row-inserted",
+                      G_CALLBACK (gtk_entry_completion_index_row_inserted),
+                      completion);
+  priv->index_deleted_id =
+    g_signal_connect (model, "row-deleted",
+                      G_CALLBACK (gtk_entry_completion_index_row_deleted),
+                      completion);
+}
+
+static gboolean
+gtk_entry_completion_index_match (GtkEntryCompletion *completion,
+                                  GtkTreeModel       *model,
+                                  GtkTreeIter        *iter)
+{
+  GtkEntryCompletionPrivate *priv = completion->priv;
+  const gchar *key = priv->case_normalized_key;
+  IndexEntry *entry;
+
+  entry = g_hash_table_lookup (priv->index, iter);
+
+  if (!entry)
+    {
+      gchar *item = NULL;
+
+      g_return_val_if_fail (gtk_tree_model_get_column_type (model, priv->text_column) == G_TYPE_STRING,
+                            FALSE);
+
+      gtk_tree_model_get (model, iter, priv->text_column, &item, -1);
+
+      entry = g_slice_new (IndexEntry);
+      entry->iter = *iter;
+      entry->key = NULL;
+
+      if (item)
+        {
+          gchar *normalized_string;
+
+          normalized_string = g_utf8_normalize (item, -1, G_NORMALIZE_ALL);
+          entry->key = g_utf8_casefold (normalized_string, -1);
+          g_free (normalized_string);
+          g_free (item);
+        }
+
+      g_hash_table_insert (priv->index, &entry->iter, entry);
+    }
+  else if (priv->index_narrowing &&
+           entry->serial == priv->index_serial - 1 &&
+           !entry->matched)
+    {
+      entry->serial = priv->index_serial;
+      return FALSE;
+    }
+
+  entry->matched = entry->key && strncmp (key, entry->key, strlen (key)) == 0;
+  entry->serial = priv->index_serial;
+
+  return entry->matched;
+}
+
 static gboolean
 gtk_entry_completion_visible_func (GtkTreeModel *model,
                                    GtkTreeIter  *iter,
@@ -837,6 +1036,8 @@ gtk_entry_completion_visible_func (GtkTreeModel *model,
                                             completion->priv->case_normalized_key,
                                             iter,
                                             completion->priv->match_data);
+  else if (completion->priv->text_column >= 0 && completion->priv->index)
+    ret = gtk_entry_completion_index_match (completion, model, iter);
   else if (completion->priv->text_column >= 0)
     ret = gtk_entry_completion_default_completion_func (completion,
                                                         completion->priv->case_normalized_key,
@@ -1067,8 +1268,11 @@ gtk_entry_completion_set_model (GtkEntryCompletion *completion,
 			       NULL);
       _gtk_entry_completion_popdown (completion);
       completion->priv->filter_model = NULL;
+      gtk_entry_completion_index_set_model (completion, NULL);
       return;
     }
+
+  gtk_entry_completion_index_set_model (completion, model);
      
   /* code will unref the old filter model (if any) */
   completion->priv->filter_model =
@@ -1198,19 +1402,32 @@ void
 gtk_entry_completion_complete (GtkEntryCompletion *completion)
 {
   gchar *tmp;
+  gchar *key;
 
   g_return_if_fail (GTK_IS_ENTRY_COMPLETION (completion));
 
   if (!completion->priv->filter_model)
     return;
-  
-  g_free (completion->priv->case_normalized_key);
 
   tmp = g_utf8_normalize (gtk_entry_get_text (GTK_ENTRY (completion->priv->entry)),
                           -1, G_NORMALIZE_ALL);
-  completion->priv->case_normalized_key = g_utf8_casefold (tmp, -1);
+  key = g_utf8_casefold (tmp, -1);
   g_free (tmp);
 
+  if (completion->priv->index)
+    {
+      /* Rows that did not match the previous key can be skipped
+       * if the new key only extends it.
+       */
+      completion->priv->index_narrowing =
+        completion->priv->case_normalized_key &&
+        g_str_has_prefix (key, completion->priv->case_normalized_key);
+      completion->priv->index_serial++;
+    }
+
+  g_free (completion->priv->case_normalized_key);
+  completion->priv->case_normalized_key = key;
+
   gtk_tree_model_filter_refilter (completion->priv->filter_model);
 
   if (GTK_WIDGET_VISIBLE (completion->priv->popup_window))
@@ -1339,6 +1556,7 @@ gtk_entry_completion_set_text_column (GtkEntryCompletion *completion,
   g_return_if_fail (column >= 0);
 
   completion->priv->text_column = column;
+  gtk_entry_completion_index_clear (completion);
 
   cell = gtk_cell_renderer_text_new ();
   gtk_cell_layout_pack_start (GTK_CELL_LAYOUT (completion),
@@ -48,6 +48,18 @@ struct _GtkEntryCompletionPrivate
 
   gchar *case_normalized_key;
 
+  /* Normalized row keys for the default match function, see
+   * gtk_entry_completion_index_match()
+   */
+  GHashTable *index;
+  GtkTreeModel *index_model;
+  gulong index_changed_id;
+  gulong index_inserted_id;
+  gulong index_deleted_id;
+  guint index_serial;
+  guint index_stale;
+  guint index_narrowing : 1;
+
   /* only used by GtkEntry when attached: */
   GtkWidget *popup_window;
   GtkWidget *vbox;
@@ -302,6 +302,18 @@ struct _GtkFileChooserDefault
 /* GtkFileSystemModel private */
 
 typedef struct _FileModelNode           FileModelNode;
+typedef struct _FileModelLevel          FileModelLevel;
+
+/* The children of a folder, in the order the folder reported them.  The
+ * position and visible row number cached in each node are only valid for
+ * the first @n_valid nodes.
+ */
+struct _FileModelLevel
+{
+  GPtrArray *nodes;
+  GHashTable *files;
+  guint n_valid;
+};
 
 struct _GtkFileSystemModel
 {
@@ -309,7 +321,7 @@ struct _GtkFileSystemModel
 
   GtkFileSystem  *file_system;
   gchar          *attributes;
-  FileModelNode  *roots;
+  FileModelLevel  roots;
   GtkFolder      *root_folder;
   GFile          *root_file;
 
@@ -333,15 +345,17 @@ struct _GtkFileSystemModel
 struct _FileModelNode
 {
   GFile *file;
-  FileModelNode *next;
 
   GFileInfo *info;
   GtkFolder *folder;
 
-  FileModelNode *children;
+  FileModelLevel children;
   FileModelNode *parent;
   GtkFileSystemModel *model;
 
+  guint index;
+  guint visible_index;
+
   guint ref_count;
   guint n_referenced_children;
 
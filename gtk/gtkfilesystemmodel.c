@@ -109,7 +109,7 @@ static gboolean           file_model_node_is_visible   (GtkFileSystemModel *mode
 							FileModelNode      *node);
 static void               file_model_node_clear        (GtkFileSystemModel *model,
 							FileModelNode      *node);
-static FileModelNode *    file_model_node_get_children (GtkFileSystemModel *model,
+static FileModelLevel *   file_model_node_get_children (GtkFileSystemModel *model,
 							FileModelNode      *node);
 
 static void deleted_callback       (GFile         *folder,
@@ -144,6 +144,190 @@ enum {
 
 static guint file_system_model_signals[LAST_SIGNAL] = { 0 };
 
+/*
+ * ******************** FileModelLevel ********************
+ */
+
+/* Recomputes the cached position and visible row number of the
+ * nodes that were added or moved since the last call.
+ */
+static void
+level_validate (FileModelLevel *level)
+{
+  guint i, n_visible;
+
+  if (!level->nodes || level->n_valid >= level->nodes->len)
+    return;
+
+  if (level->n_valid == 0)
+    n_visible = 0;
+  else
+    {
+      FileModelNode *prev = g_ptr_array_index (level->nodes, level->n_valid - 1);
+      n_visible = prev->visible_index + (prev->is_visible ? 1 : 0);
+    }
+
+  for (i = level->n_valid; i < level->nodes->len; i++)
+    {
+      FileModelNode *node = g_ptr_array_index (level->nodes, i);
+
+      node->index = i;
+      node->visible_index = n_visible;
+      if (node->is_visible)
+	n_visible++;
+    }
+
+  level->n_valid = level->nodes->len;
+}
+
+static guint
+level_get_n_visible (FileModelLevel *level)
+{
+  FileModelNode *last;
+
+  if (!level->nodes || level->nodes->len == 0)
+    return 0;
+
+  level_validate (level);
+
+  last = g_ptr_array_index (level->nodes, level->nodes->len - 1);
+
+  return last->visible_index + (last->is_visible ? 1 : 0);
+}
+
+static FileModelNode *
+level_get_nth_visible (FileModelLevel *level,
+		       guint           n)
+{
+  FileModelNode *node;
+  guint lo, hi;
+
+  if (!level->nodes)
+    return NULL;
+
+  level_validate (level);
+
+  /* Find the first node up to which more than n nodes are visible;
+   * that one is visible and has visible_index == n.
+   */
+  lo = 0;
+  hi = level->nodes->len;
+  while (lo < hi)
+    {
+      guint mid = (lo + hi) / 2;
+
+      node = g_ptr_array_index (level->nodes, mid);
+      if (node->visible_index + (node->is_visible ? 1 : 0) <= n)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+
+  if (lo == level->nodes->len)
+    return NULL;
+
+  return g_ptr_array_index (level->nodes, lo);
+}
+
+static FileModelNode *
+level_lookup (FileModelLevel *level,
+	      GFile          *file)
+{
+  if (!level->files)
+    return NULL;
+
+  return g_hash_table_lookup (level->files, file);
+}
+
+static void
+level_append (FileModelLevel *level,
+	      FileModelNode  *node)
+{
+  if (!level->nodes)
+    level->nodes = g_ptr_array_new ();
+
+  if (node->file)
+    {
+      if (!level->files)
+	level->files = g_hash_table_new (g_file_hash, (GEqualFunc) g_file_equal);
+
+      g_hash_table_insert (level->files, node->file, node);
+    }
+
+  g_ptr_array_add (level->nodes, node);
+}
+
+static void
+level_prepend (FileModelLevel *level,
+	       FileModelNode  *node)
+{
+  gpointer *pdata;
+
+  level_append (level, node);
+
+  pdata = level->nodes->pdata;
+  g_memmove (pdata + 1, pdata, (level->nodes->len - 1) * sizeof (gpointer));
+  pdata[0] = node;
+
+  node->index = 0;
+  node->visible_index = 0;
+  level->n_valid = 1;
+}
+
+/* The caller must make sure node->index is valid.  Removing a node
+ * leaves the cached positions of the nodes before it intact.
+ */
+static void
+level_remove (FileModelLevel *level,
+	      FileModelNode  *node)
+{
+  if (node->file)
+    g_hash_table_remove (level->files, node->file);
+
+  g_ptr_array_remove_index (level->nodes, node->index);
+  level->n_valid = MIN (level->n_valid, node->index);
+}
+
+static void
+level_free (FileModelLevel *level)
+{
+  GPtrArray *nodes = level->nodes;
+  guint i;
+
+  if (level->files)
+    g_hash_table_destroy (level->files);
+
+  level->nodes = NULL;
+  level->files = NULL;
+  level->n_valid = 0;
+
+  if (nodes)
+    {
+      for (i = 0; i < nodes->len; i++)
+	file_model_node_free (g_ptr_array_index (nodes, i));
+
+      g_ptr_array_free (nodes, TRUE);
+    }
+}
+
+static FileModelLevel *
+node_get_level (GtkFileSystemModel *model,
+		FileModelNode      *node)
+{
+  if (node->parent)
+    return &node->parent->children;
+  else
+    return &model->roots;
+}
+
+/* The editable row is always the first root */
+static gboolean
+node_is_editable (GtkFileSystemModel *model,
+		  FileModelNode      *node)
+{
+  return (model->has_editable &&
+	  g_ptr_array_index (model->roots.nodes, 0) == node);
+}
 
 
 G_DEFINE_TYPE_WITH_CODE (GtkFileSystemModel, _gtk_file_system_model, G_TYPE_OBJECT,
@@ -201,7 +385,6 @@ static void
 gtk_file_system_model_finalize (GObject *object)
 {
   GtkFileSystemModel *model = GTK_FILE_SYSTEM_MODEL (object);
-  FileModelNode *children, *next;
 
   if (model->root_folder)
     g_object_unref (model->root_folder);
@@ -212,13 +395,7 @@ gtk_file_system_model_finalize (GObject *object)
   if (model->file_system)
     g_object_unref (model->file_system);
 
-  children = model->roots;
-  while (children)
-    {
-      next = children->next;
-      file_model_node_free (children);
-      children = next;
-    }
+  level_free (&model->roots);
 
   g_free (model->attributes);
 
@@ -328,25 +505,10 @@ gtk_file_system_model_get_path (GtkTreeModel *tree_model,
 
   while (node)
     {
-      FileModelNode *parent = node->parent;
-      FileModelNode *children;
-      int n = 0;
-
-      if (parent)
-	children = parent->children;
-      else
-	children = model->roots;
-
-      while (children != node)
-	{
-	  if (children->is_visible)
-	    n++;
-	  children = children->next;
-	}
-      
-      gtk_tree_path_prepend_index (result, n);
+      level_validate (node_get_level (model, node));
+      gtk_tree_path_prepend_index (result, node->visible_index);
 
-      node = parent;
+      node = node->parent;
     }
 
   return result;
@@ -365,7 +527,7 @@ gtk_file_system_model_get_value (GtkTreeModel *tree_model,
   switch (column)
     {
     case GTK_FILE_SYSTEM_MODEL_INFO:
-      if (model->has_editable && node == model->roots)
+      if (node_is_editable (model, node))
 	info = NULL;
       else
 	info = file_model_node_get_info (model, node);
@@ -376,7 +538,7 @@ gtk_file_system_model_get_value (GtkTreeModel *tree_model,
       {
 	g_value_init (value, G_TYPE_STRING);
 
-	if (model->has_editable && node == model->roots)
+	if (node_is_editable (model, node))
 	  g_value_set_static_string (value, "");
 	else
 	  {
@@ -395,15 +557,26 @@ static gboolean
 gtk_file_system_model_iter_next (GtkTreeModel *tree_model,
 				 GtkTreeIter  *iter)
 {
+  GtkFileSystemModel *model = GTK_FILE_SYSTEM_MODEL (tree_model);
   FileModelNode *node = iter->user_data;
+  FileModelLevel *level = node_get_level (model, node);
+  guint i;
 
-  node = node->next;
-  while (node && !node->is_visible)
-    node = node->next;
-  
-  iter->user_data = node;
+  level_validate (level);
 
-  return node != NULL;
+  for (i = node->index + 1; i < level->nodes->len; i++)
+    {
+      node = g_ptr_array_index (level->nodes, i);
+      if (node->is_visible)
+	{
+	  iter->user_data = node;
+	  return TRUE;
+	}
+    }
+
+  iter->user_data = NULL;
+
+  return FALSE;
 }
 
 static gboolean
@@ -412,20 +585,21 @@ gtk_file_system_model_iter_children (GtkTreeModel *tree_model,
 				     GtkTreeIter  *parent)
 {
   GtkFileSystemModel *model = GTK_FILE_SYSTEM_MODEL (tree_model);
-  FileModelNode *children;
+  FileModelLevel *level;
+  FileModelNode *children = NULL;
 
   if (parent)
     {
       FileModelNode *parent_node = parent->user_data;
-      children = file_model_node_get_children (model, parent_node);
+      level = file_model_node_get_children (model, parent_node);
     }
   else
     {
-      children = model->roots;
+      level = &model->roots;
     }
 
-  while (children && !children->is_visible)
-    children = children->next;
+  if (level)
+    children = level_get_nth_visible (level, 0);
 
   iter->user_data = children;
 
@@ -453,27 +627,22 @@ gtk_file_system_model_iter_n_children (GtkTreeModel *tree_model,
 				       GtkTreeIter  *iter)
 {
   GtkFileSystemModel *model = GTK_FILE_SYSTEM_MODEL (tree_model);
-  FileModelNode *children;
-  gint n = 0;
+  FileModelLevel *level;
 
   if (iter)
     {
       FileModelNode *node = iter->user_data;
-      children = file_model_node_get_children (model, node);
+      level = file_model_node_get_children (model, node);
     }
   else
     {
-      children = model->roots;
+      level = &model->roots;
     }
 
-  while (children)
-    {
-      if (children->is_visible)
-	n++;
-      children = children->next;
-    }
+  if (!level)
+    return 0;
 
-  return n;
+  return level_get_n_visible (level);
 }
 
 static gboolean
@@ -483,28 +652,21 @@ gtk_file_system_model_iter_nth_child (GtkTreeModel *tree_model,
 				      gint          n)
 {
   GtkFileSystemModel *model = GTK_FILE_SYSTEM_MODEL (tree_model);
-  FileModelNode *children;
+  FileModelLevel *level;
+  FileModelNode *children = NULL;
 
   if (parent)
     {
       FileModelNode *parent_node = parent->user_data;
-      children = file_model_node_get_children (model, parent_node);
+      level = file_model_node_get_children (model, parent_node);
     }
   else
     {
-      children = model->roots;
+      level = &model->roots;
     }
 
-  while (children && !children->is_visible)
-    children = children->next;
-
-  while (n && children)
-    {
-      n--;
-      children = children->next;
-      while (children && !children->is_visible)
-	children = children->next;
-    }
+  if (level && n >= 0)
+    children = level_get_nth_visible (level, n);
 
   iter->user_data = children;
 
@@ -552,11 +714,8 @@ drag_source_row_draggable (GtkTreeDragSource *drag_source,
   if (!gtk_file_system_model_get_iter (GTK_TREE_MODEL (model), &iter, path))
     return FALSE;
 
-  if (!model->has_editable)
-    return TRUE;
-
   node = iter.user_data;
-  return (node != model->roots);
+  return !node_is_editable (model, node);
 }
 
 static gboolean
@@ -680,8 +839,6 @@ _gtk_file_system_model_new (GtkFileSystem     *file_system,
   model->root_folder = NULL;
   model->root_file = g_object_ref (root_file);
 
-  model->roots = NULL;
-
   cancellable = _gtk_file_system_get_folder (file_system, root_file,
 					     attributes,
 					     got_root_folder_cb,
@@ -713,54 +870,63 @@ model_refilter_recurse (GtkFileSystemModel *model,
 			GtkTreePath        *path)
 {
   GtkTreeModel *tree_model = GTK_TREE_MODEL (model);
-  int i = 0;
-  FileModelNode *nodes;
+  guint i, n_visible = 0;
+  FileModelLevel *level;
   gboolean has_children = FALSE;
 
   if (parent && !parent->loaded)
     return;
 
   if (parent)
-    nodes = parent->children;
+    level = &parent->children;
   else
-    nodes = model->roots;
+    level = &model->roots;
+
+  if (!level->nodes)
+    return;
+
+  level_validate (level);
 
-  while (nodes)
+  for (i = 0; i < level->nodes->len; i++)
     {
-      FileModelNode *next = nodes->next;
+      FileModelNode *node = g_ptr_array_index (level->nodes, i);
       gboolean is_visible;
-      
-      gtk_tree_path_append_index (path, i);
 
-      is_visible = file_model_node_is_visible (model, nodes);
+      /* Renumber as we go; the nodes after this one are stale
+       * until we get to them.
+       */
+      node->index = i;
+      node->visible_index = n_visible;
+      level->n_valid = i + 1;
+
+      gtk_tree_path_append_index (path, n_visible);
+
+      is_visible = file_model_node_is_visible (model, node);
       
-      if (!is_visible && nodes->is_visible)
+      if (!is_visible && node->is_visible)
 	{
-	  file_model_node_clear (model, nodes);
+	  file_model_node_clear (model, node);
+	  node->is_visible = FALSE;
 	  gtk_tree_model_row_deleted (tree_model, path);
-
-	  nodes->is_visible = FALSE;
 	}
-      else if (is_visible && !nodes->is_visible)
+      else if (is_visible && !node->is_visible)
 	{
 	  GtkTreeIter iter;
 
-	  iter.user_data = nodes;
-	  nodes->is_visible = TRUE;
+	  iter.user_data = node;
+	  node->is_visible = TRUE;
 	  gtk_tree_model_row_inserted (tree_model, path, &iter);
 	}
       else
-	model_refilter_recurse (model, nodes, path);
+	model_refilter_recurse (model, node, path);
 
       if (is_visible)
 	{
 	  has_children = TRUE;
-	  i++;
+	  n_visible++;
 	}
       
       gtk_tree_path_up (path);
-      
-      nodes = next;
     }
 
   if (parent && !has_children)
@@ -869,7 +1035,7 @@ _gtk_file_system_model_get_info (GtkFileSystemModel *model,
   FileModelNode *node;
 
   node = iter->user_data;
-  if (model->has_editable && node == model->roots)
+  if (node_is_editable (model, node))
     return NULL;
   else
     return file_model_node_get_info (model, node);
@@ -893,7 +1059,7 @@ _gtk_file_system_model_get_file (GtkFileSystemModel *model,
 {
   FileModelNode *node = iter->user_data;
 
-  if (model->has_editable && node == model->roots)
+  if (node_is_editable (model, node))
     return NULL;
 
   if (node->is_dummy)
@@ -916,22 +1082,20 @@ find_child_node (GtkFileSystemModel *model,
 		 FileModelNode      *parent_node,
 		 GFile              *file)
 {
-  FileModelNode *children;
+  FileModelLevel *level;
+  FileModelNode *node;
   
   if (parent_node)
-    children = file_model_node_get_children (model, parent_node);
+    level = file_model_node_get_children (model, parent_node);
   else
-    children = model->roots;
+    level = &model->roots;
 
-  while (children)
-    {
-      if (children->is_visible &&
-	  children->file &&
-	  g_file_equal (children->file, file))
-	return children;
+  if (!level)
+    return NULL;
 
-      children = children->next;
-    }
+  node = level_lookup (level, file);
+  if (node && node->is_visible)
+    return node;
 
   return NULL;
 }
@@ -1221,8 +1385,7 @@ _gtk_file_system_model_add_editable (GtkFileSystemModel *model, GtkTreeIter *ite
   node = file_model_node_new (model, NULL);
   node->is_visible = TRUE;
 
-  node->next = model->roots;
-  model->roots = node;
+  level_prepend (&model->roots, node);
 
   path = gtk_tree_path_new ();
   gtk_tree_path_append_index (path, 0);
@@ -1251,8 +1414,8 @@ _gtk_file_system_model_remove_editable (GtkFileSystemModel *model)
 
   model->has_editable = FALSE;
 
-  node = model->roots;
-  model->roots = model->roots->next;
+  node = g_ptr_array_index (model->roots.nodes, 0);
+  level_remove (&model->roots, node);
   file_model_node_free (node);
 
   path = gtk_tree_path_new ();
@@ -1351,22 +1514,11 @@ static void
 file_model_node_clear (GtkFileSystemModel *model,
 		       FileModelNode      *node)
 {
-  FileModelNode *children;
-  
   file_model_node_idle_clear_cancel (node);
   
-  children = node->children;
-  node->children = NULL;
   node->loaded = FALSE;
-  
-  while (children)
-    {
-      FileModelNode *next = children->next;
-      
-      file_model_node_free (children);
-      
-      children = next;
-    }
+  node->has_dummy = FALSE;
+  level_free (&node->children);
 
   if (node->folder)
     {
@@ -1496,15 +1648,9 @@ get_children_get_folder_cb (GCancellable *cancellable,
 
   if (cancelled || !folder)
     {
-      /* error, no folder, remove dummy child */
-      if (data->node->parent && data->node->parent->has_dummy)
-        {
-          data->node->parent->children = NULL;
-          data->node->parent->has_dummy = FALSE;
-	}
-
-      file_model_node_free (data->node);
-
+      /* error, no folder; the node is still in its parent's
+       * children, so just leave it with its dummy child.
+       */
       goto out;
     }
 
@@ -1525,13 +1671,16 @@ get_children_get_folder_cb (GCancellable *cancellable,
   /* We claimed this folder had children, so we
    * have to add a dummy child, possibly to remove later.
    */
-  child_node = file_model_node_new (data->model, NULL);
-  child_node->is_visible = TRUE;
-  child_node->parent = data->node;
-  child_node->is_dummy = TRUE;
+  if (!data->node->has_dummy)
+    {
+      child_node = file_model_node_new (data->model, NULL);
+      child_node->is_visible = TRUE;
+      child_node->parent = data->node;
+      child_node->is_dummy = TRUE;
 
-  data->node->children = child_node;
-  data->node->has_dummy = TRUE;
+      level_append (&data->node->children, child_node);
+      data->node->has_dummy = TRUE;
+    }
 
   g_object_set_data (G_OBJECT (data->node->folder), I_("model-node"), data->node);
 
@@ -1542,7 +1691,7 @@ out:
   g_object_unref (cancellable);
 }
 
-static FileModelNode *
+static FileModelLevel *
 file_model_node_get_children (GtkFileSystemModel *model,
 			      FileModelNode      *node)
 {
@@ -1586,40 +1735,35 @@ file_model_node_get_children (GtkFileSystemModel *model,
 	      child_node->parent = node;
 	      child_node->is_dummy = TRUE;
 
-	      node->children = child_node;
+	      level_append (&node->children, child_node);
 	      node->has_dummy = TRUE;
 	    }
 	}
     }
 
-  return node->children;
+  return &node->children;
 }
 
-static gint
-file_compare_func (GFile *file1,
-		   GFile *file2)
+/* Returns a path to the first child of @parent_node */
+static GtkTreePath *
+get_children_path (GtkFileSystemModel *model,
+		   FileModelNode      *parent_node)
 {
-  gchar *uri1, *uri2;
-  gint result;
-
-  uri1 = g_file_get_uri (file1);
-  uri2 = g_file_get_uri (file2);
-
-  result = g_strcmp0 (uri1, uri2);
+  GtkTreePath *path;
 
-  g_free (uri1);
-  g_free (uri2);
+  if (parent_node)
+    {
+      GtkTreeIter iter;
 
-  return result;
-}
+      iter.user_data = parent_node;
+      path = gtk_tree_model_get_path (GTK_TREE_MODEL (model), &iter);
+    }
+  else
+    path = gtk_tree_path_new ();
 
-static GSList *
-sort_file_list (GSList *list)
-{
-  GSList *copy;
+  gtk_tree_path_down (path);
 
-  copy = g_slist_copy (list);
-  return g_slist_sort (copy, (GCompareFunc) file_compare_func);
+  return path;
 }
 
 static void
@@ -1628,116 +1772,80 @@ do_files_added (GtkFileSystemModel *model,
 		GSList             *files)
 {
   GtkTreeModel *tree_model = GTK_TREE_MODEL (model);
-  FileModelNode *children;
-  FileModelNode *prev = NULL;
+  FileModelLevel *level;
   GtkTreeIter iter;
   GtkTreePath *path;
-  GSList *sorted_files, *tmp_list;
-
-  sorted_files = sort_file_list (files);
+  GSList *tmp_list;
 
   if (parent_node)
-    {
-      iter.user_data = parent_node;
-      path = gtk_tree_model_get_path (tree_model, &iter);
-      children = parent_node->children;
-    }
+    level = &parent_node->children;
   else
-    {
-      path = gtk_tree_path_new ();
-      children = model->roots;
-    }
+    level = &model->roots;
 
-  gtk_tree_path_down (path);
-  
-  if (parent_node && parent_node->has_dummy)
-    {
-      prev = children;
-      children = children->next;
-      gtk_tree_path_next (path);
-    }
+  /* New nodes are appended, so the path of the parent is computed
+   * once for the whole batch and only the last index changes.
+   */
+  path = get_children_path (model, parent_node);
 
-  for (tmp_list = sorted_files; tmp_list; tmp_list = tmp_list->next)
+  for (tmp_list = files; tmp_list; tmp_list = tmp_list->next)
     {
       GFile *file = tmp_list->data;
+      FileModelNode *new;
 
-      while (children &&
-	     (!children->file || !g_file_equal (children->file, file)))
+      if (level_lookup (level, file))
 	{
-	  prev = children;
-	  if (children->is_visible)
-	    gtk_tree_path_next (path);
-	  
-	  children = children->next;
+	  /* Shouldn't happen */
+	  continue;
 	}
-  
-      if (children &&
-	  children->file && g_file_equal (children->file, file))
+
+      new = file_model_node_new (model, file);
+
+      if (parent_node)
 	{
-	  /* Shouldn't happen */
+	  new->parent = parent_node;
+	  new->depth = parent_node->depth + 1;
 	}
-      else
+
+      new->is_visible = file_model_node_is_visible (model, new);
+
+      level_append (level, new);
+
+      if (new->is_visible)
 	{
-	  FileModelNode *new;
-	  
-	  new = file_model_node_new (model, file);
-	  
-	  if (children)
-	    new->next = children;
-	  if (prev)
-	    prev->next = new;
-	  else if (parent_node)
-	    parent_node->children = new;
-	  else
-	    model->roots = new;
-
-	  prev = new;
-	  
-	  if (parent_node)
-	    {
-	      new->parent = parent_node;
-	      new->depth = parent_node->depth + 1;
-	    }
-	  
-	  new->is_visible = file_model_node_is_visible (model, new);
-	  
-	  if (new->is_visible)
+	  level_validate (level);
+
+	  gtk_tree_path_up (path);
+	  gtk_tree_path_append_index (path, new->visible_index);
+
+	  iter.user_data = new;
+	  gtk_tree_model_row_inserted (tree_model, path, &iter);
+
+	  if (gtk_file_system_model_iter_has_child (tree_model, &iter))
+	    gtk_tree_model_row_has_child_toggled (tree_model, path, &iter);
+
+	  if (parent_node && parent_node->has_dummy)
 	    {
-	      iter.user_data = new;
-	      gtk_tree_path_free (path);
-	      path = gtk_tree_model_get_path (tree_model, &iter);
-	      gtk_tree_model_row_inserted (tree_model, path, &iter);
-	      
-	      if (gtk_file_system_model_iter_has_child (tree_model, &iter))
-		gtk_tree_model_row_has_child_toggled (tree_model, path, &iter);
-	      
-	      if (parent_node && parent_node->has_dummy)
-		{
-		  FileModelNode *dummy = parent_node->children;
-		  GtkTreePath *dummy_path;
-		  
-		  parent_node->children = parent_node->children->next;
-		  parent_node->has_dummy = FALSE;
-
-		  dummy_path = gtk_tree_path_copy (path);
-		  gtk_tree_path_up (dummy_path);
-		  gtk_tree_path_down (dummy_path);
-		  
-		  gtk_tree_model_row_deleted (tree_model, dummy_path);
-		  gtk_tree_path_free (dummy_path);
-
-		  if (dummy->ref_count)
-		    file_model_node_child_unref (parent_node);
-		  file_model_node_free (dummy);
-		}
-	      
-	      gtk_tree_path_next (path);
+	      FileModelNode *dummy = g_ptr_array_index (level->nodes, 0);
+	      GtkTreePath *dummy_path;
+
+	      level_remove (level, dummy);
+	      parent_node->has_dummy = FALSE;
+
+	      dummy_path = gtk_tree_path_copy (path);
+	      gtk_tree_path_up (dummy_path);
+	      gtk_tree_path_down (dummy_path);
+
+	      gtk_tree_model_row_deleted (tree_model, dummy_path);
+	      gtk_tree_path_free (dummy_path);
+
+	      if (dummy->ref_count)
+		file_model_node_child_unref (parent_node);
+	      file_model_node_free (dummy);
 	    }
 	}
     }
 
   gtk_tree_path_free (path);
-  g_slist_free (sorted_files);
 }
 
 static void
@@ -1746,50 +1854,30 @@ do_files_changed (GtkFileSystemModel *model,
 		  GSList             *files)
 {
   GtkTreeModel *tree_model = GTK_TREE_MODEL (model);
-  FileModelNode *children;
+  FileModelLevel *level;
   GtkTreeIter iter;
   GtkTreePath *path;
-  GSList *sorted_files;
   GSList *tmp_list;
 
-  sorted_files = sort_file_list (files);
-
   if (parent_node)
-    {
-      iter.user_data = parent_node;
-      path = gtk_tree_model_get_path (tree_model, &iter);
-      children = parent_node->children;
-    }
+    level = &parent_node->children;
   else
-    {
-      path = gtk_tree_path_new ();
-      children = model->roots;
-    }
+    level = &model->roots;
 
-  gtk_tree_path_down (path);
-  
-  if (parent_node && parent_node->has_dummy)
-    {
-      children = children->next;
-      gtk_tree_path_next (path);
-    }
+  path = get_children_path (model, parent_node);
 
-  for (tmp_list = sorted_files; tmp_list; tmp_list = tmp_list->next)
+  for (tmp_list = files; tmp_list; tmp_list = tmp_list->next)
     {
-      GFile *file = tmp_list->data;
+      FileModelNode *node = level_lookup (level, tmp_list->data);
 
-      while (children &&
-	     (!children->file || !g_file_equal (children->file, file)))
-	{
-	  if (children->is_visible)
-	    gtk_tree_path_next (path);
-	  
-	  children = children->next;
-	}
-  
-      if (children &&
-	  children->file && g_file_equal (children->file, file))
+      if (node && node->is_visible)
 	{
+	  level_validate (level);
+
+	  gtk_tree_path_up (path);
+	  gtk_tree_path_append_index (path, node->visible_index);
+
+	  iter.user_data = node;
 	  gtk_tree_model_row_changed (tree_model, path, &iter);
 	}
       else
@@ -1799,7 +1887,21 @@ do_files_changed (GtkFileSystemModel *model,
     }
 
   gtk_tree_path_free (path);
-  g_slist_free (sorted_files);
+}
+
+static gint
+node_index_compare_reverse (gconstpointer a,
+			    gconstpointer b)
+{
+  const FileModelNode *node_a = *(FileModelNode **) a;
+  const FileModelNode *node_b = *(FileModelNode **) b;
+
+  if (node_a->index < node_b->index)
+    return 1;
+  else if (node_a->index > node_b->index)
+    return -1;
+  else
+    return 0;
 }
 
 static void
@@ -1808,112 +1910,83 @@ do_files_removed (GtkFileSystemModel *model,
 		  GSList             *files)
 {
   GtkTreeModel *tree_model = GTK_TREE_MODEL (model);
-  FileModelNode *children;
-  FileModelNode *prev = NULL;
+  FileModelLevel *level;
   GtkTreeIter iter;
   GtkTreePath *path;
-  GSList *sorted_files;
+  GPtrArray *removed;
   GSList *tmp_list;
-  FileModelNode *tmp_child;
-  gint n_visible;
-
-  sorted_files = sort_file_list (files);
+  guint n_visible, i;
 
   if (parent_node)
-    {
-      iter.user_data = parent_node;
-      path = gtk_tree_model_get_path (tree_model, &iter);
-      children = parent_node->children;
-    }
+    level = &parent_node->children;
   else
+    level = &model->roots;
+
+  removed = g_ptr_array_new ();
+  for (tmp_list = files; tmp_list; tmp_list = tmp_list->next)
     {
-      path = gtk_tree_path_new ();
-      children = model->roots;
+      FileModelNode *node = level_lookup (level, tmp_list->data);
+
+      if (node)
+	g_ptr_array_add (removed, node);
     }
 
+  /* Remove the nodes from the last one backwards, so the ones still
+   * to be removed keep their positions.
+   */
+  level_validate (level);
+  g_ptr_array_sort (removed, node_index_compare_reverse);
+
   /* Count the number of currently visible children, so that
    * can catch when we need to insert a dummy node.
    */
-  n_visible = 0;
-  for (tmp_child = children; tmp_child; tmp_child = tmp_child->next)
-    {
-      if (tmp_child->is_visible)
-	n_visible++;
-    }
+  n_visible = level_get_n_visible (level);
 
-  gtk_tree_path_down (path);
-  
-  if (parent_node && parent_node->has_dummy)
-    {
-      prev = children;
-      children = children->next;
-      gtk_tree_path_next (path);
-    }
+  path = get_children_path (model, parent_node);
 
-  for (tmp_list = sorted_files; tmp_list; tmp_list = tmp_list->next)
+  for (i = 0; i < removed->len; i++)
     {
-      GFile *file = tmp_list->data;
+      FileModelNode *node = g_ptr_array_index (removed, i);
 
-      while (children &&
-	     (!children->file || !g_file_equal (children->file, file)))
-	{
-	  prev = children;
-	  if (children->is_visible)
-	    gtk_tree_path_next (path);
-	  
-	  children = children->next;
-	}
-  
-      if (children &&
-	  children->file && g_file_equal (children->file, file))
+      if (node->is_visible)
+	n_visible--;
+
+      if (parent_node && n_visible == 0 && !parent_node->has_dummy)
 	{
-	  FileModelNode *next = children->next;
+	  FileModelNode *dummy = file_model_node_new (model, NULL);
+	  dummy->is_visible = TRUE;
+	  dummy->parent = parent_node;
+	  dummy->is_dummy = TRUE;
 
-	  if (children->is_visible)
-	    n_visible--;
-	  
-	  if (parent_node && n_visible == 0)
-	    {
-	      FileModelNode *dummy = file_model_node_new (model, NULL);
-	      dummy->is_visible = TRUE;
-	      dummy->parent = parent_node;
-	      dummy->is_dummy = TRUE;
+	  level_prepend (level, dummy);
+	  parent_node->has_dummy = TRUE;
 
-	      parent_node->children = dummy;
-	      parent_node->has_dummy = TRUE;
+	  gtk_tree_path_up (path);
+	  gtk_tree_path_down (path);
 
-	      iter.user_data = dummy;
-	      gtk_tree_model_row_inserted (tree_model, path, &iter);
-	      gtk_tree_path_next (path);
+	  iter.user_data = dummy;
+	  gtk_tree_model_row_inserted (tree_model, path, &iter);
 
-	      prev = dummy;
-	    }
-	  
-	  if (prev)
-	    prev->next = next;
-	  else if (parent_node)
-	    parent_node->children = next;
-	  else
-	    model->roots = next;
-
-	  if (parent_node && children->ref_count)
-	    file_model_node_child_unref (parent_node);
-	      
-	  if (children->is_visible)
-	    gtk_tree_model_row_deleted (tree_model, path);
-
-	  file_model_node_free (children);
-
-	  children = next;
-	}
-      else
-	{
-	  /* Shouldn't happen */
+	  /* All the remaining nodes moved down by one */
+	  level_validate (level);
 	}
+
+      gtk_tree_path_up (path);
+      gtk_tree_path_append_index (path, node->visible_index);
+
+      level_remove (level, node);
+
+      if (parent_node && node->ref_count)
+	file_model_node_child_unref (parent_node);
+
+      if (node->is_visible)
+	gtk_tree_model_row_deleted (tree_model, path);
+
+      file_model_node_free (node);
     }
 
   gtk_tree_path_free (path);
-  g_slist_free (sorted_files);
+  g_ptr_array_free (removed, TRUE);
 }
 
 static void
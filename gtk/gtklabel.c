@@ -49,11 +49,33 @@
 
 #define GTK_LABEL_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), GTK_TYPE_LABEL, GtkLabelPrivate))
 
+#define WIDTH_MEMO_SIZE 4
+
+typedef struct
+{
+  gint max_width;
+  gint width;
+}
+GtkLabelWidthMemo;
+
 typedef struct
 {
   gint wrap_width;
   gint width_chars;
   gint max_width_chars;
+
+  /* Unwrapped width of the layout, or -1 */
+  gint longest_paragraph;
+
+  /* Widths chosen for a wrapping layout, by maximum width;
+   * valid until the layout is cleared
+   */
+  GtkLabelWidthMemo width_memo[WIDTH_MEMO_SIZE];
+  guint n_width_memo;
+  guint width_memo_next;
+
+  guint relayouts;
+  guint relayouts_avoided;
 }
 GtkLabelPrivate;
 
@@ -165,6 +187,7 @@ static void gtk_label_create_window       (GtkLabel *label);
 static void gtk_label_destroy_window      (GtkLabel *label);
 static void gtk_label_clear_layout        (GtkLabel *label);
 static void gtk_label_ensure_layout       (GtkLabel *label);
+static void gtk_label_update_layout_width (GtkLabel *label);
 static void gtk_label_invalidate_wrap_width (GtkLabel *label);
 static void gtk_label_select_region_index (GtkLabel *label,
                                            gint      anchor_index,
@@ -808,6 +831,7 @@ gtk_label_init (GtkLabel *label)
   priv->width_chars = -1;
   priv->max_width_chars = -1;
   priv->wrap_width = -1;
+  priv->longest_paragraph = -1;
   label->label = NULL;
 
   label->jtype = GTK_JUSTIFY_LEFT;
@@ -2176,6 +2200,7 @@ gtk_label_set_line_wrap_mode (GtkLabel *label,
       label->wrap_mode = wrap_mode;
       g_object_notify (G_OBJECT (label), "wrap-mode");
       
+      gtk_label_clear_layout (label);
       gtk_widget_queue_resize (GTK_WIDGET (label));
     }
 }
@@ -2224,6 +2249,15 @@ gtk_label_finalize (GObject *object)
 {
   GtkLabel *label = GTK_LABEL (object);
 
+  GTK_NOTE (MISC,
+            if (label->wrap)
+              {
+                GtkLabelPrivate *priv = GTK_LABEL_GET_PRIVATE (label);
+
+                g_message ("GtkLabel %p: %u relayouts, %u avoided",
+                           label, priv->relayouts, priv->relayouts_avoided);
+              });
+
   g_free (label->label);
   g_free (label->text);
 
@@ -2244,11 +2278,17 @@ gtk_label_finalize (GObject *object)
 static void
 gtk_label_clear_layout (GtkLabel *label)
 {
+  GtkLabelPrivate *priv;
+
   if (label->layout)
     {
       g_object_unref (label->layout);
       label->layout = NULL;
     }
+
+  priv = GTK_LABEL_GET_PRIVATE (label);
+  priv->longest_paragraph = -1;
+  priv->n_width_memo = 0;
 }
 
 static gint
@@ -2297,6 +2337,7 @@ gtk_label_invalidate_wrap_width (GtkLabel *label)
   priv = GTK_LABEL_GET_PRIVATE (label);
 
   priv->wrap_width = -1;
+  priv->n_width_memo = 0;
 }
 
 static gint
@@ -2324,11 +2365,117 @@ get_label_wrap_width (GtkLabel *label)
   return priv->wrap_width;
 }
 
+/* Sets the width at which a wrapping label's layout is broken into
+ * lines. Finding a balanced width shapes the text several times, so
+ * the result is remembered per maximum width until the layout is
+ * cleared; a label that is just resized then only has to rewrap once.
+ */
 static void
-gtk_label_ensure_layout (GtkLabel *label)
+gtk_label_update_layout_width (GtkLabel *label)
 {
   GtkWidget *widget;
+  GtkLabelPrivate *priv;
+  GtkWidgetAuxInfo *aux_info;
+  GdkScreen *screen;
   PangoRectangle logical_rect;
+  gint longest_paragraph;
+  gint max_width, width, height;
+  gint wrap_width;
+  guint i;
+
+  widget = GTK_WIDGET (label);
+  priv = GTK_LABEL_GET_PRIVATE (label);
+
+  aux_info = _gtk_widget_get_aux_info (widget, FALSE);
+  if (aux_info && aux_info->width > 0)
+    {
+      pango_layout_set_width (label->layout, aux_info->width * PANGO_SCALE);
+      return;
+    }
+
+  screen = gtk_widget_get_screen (widget);
+
+  if (priv->longest_paragraph < 0)
+    {
+      pango_layout_set_width (label->layout, -1);
+      pango_layout_get_extents (label->layout, NULL, &logical_rect);
+      priv->longest_paragraph = logical_rect.width;
+    }
+
+  width = priv->longest_paragraph;
+
+  /* Try to guess a reasonable maximum width */
+  longest_paragraph = width;
+
+  wrap_width = get_label_wrap_width (label);
+  width = MIN (width, wrap_width);
+#ifndef MAEMO_CHANGES
+  width = MIN (width,
+	       PANGO_SCALE * (gdk_screen_get_width (screen) + 1) / 2);
+#else
+  width = MIN (width, PANGO_SCALE * (gdk_screen_get_width (screen) + 1) * 0.70);
+#endif
+
+  for (i = 0; i < priv->n_width_memo; i++)
+    if (priv->width_memo[i].max_width == width)
+      {
+	pango_layout_set_width (label->layout, priv->width_memo[i].width);
+	priv->relayouts_avoided++;
+	return;
+      }
+
+  priv->relayouts++;
+  max_width = width;
+
+  pango_layout_set_width (label->layout, width);
+  pango_layout_get_extents (label->layout, NULL, &logical_rect);
+  width = logical_rect.width;
+  height = logical_rect.height;
+
+  /* Unfortunately, the above may leave us with a very unbalanced looking paragraph,
+   * so we try short search for a narrower width that leaves us with the same height
+   */
+  if (longest_paragraph > 0)
+    {
+      gint nlines, perfect_width;
+
+      nlines = pango_layout_get_line_count (label->layout);
+      perfect_width = (longest_paragraph + nlines - 1) / nlines;
+
+      if (perfect_width < width)
+	{
+	  pango_layout_set_width (label->layout, perfect_width);
+	  pango_layout_get_extents (label->layout, NULL, &logical_rect);
+
+	  if (logical_rect.height <= height)
+	    width = logical_rect.width;
+	  else
+	    {
+	      gint mid_width = (perfect_width + width) / 2;
+
+	      if (mid_width > perfect_width)
+		{
+		  pango_layout_set_width (label->layout, mid_width);
+		  pango_layout_get_extents (label->layout, NULL, &logical_rect);
+
+		  if (logical_rect.height <= height)
+		    width = logical_rect.width;
+		}
+	    }
+	}
+    }
+  pango_layout_set_width (label->layout, width);
+
+  priv->width_memo[priv->width_memo_next].max_width = max_width;
+  priv->width_memo[priv->width_memo_next].width = width;
+  priv->width_memo_next = (priv->width_memo_next + 1) % WIDTH_MEMO_SIZE;
+  priv->n_width_memo = MIN (priv->n_width_memo + 1, WIDTH_MEMO_SIZE);
+}
+
+static void
+gtk_label_ensure_layout (GtkLabel *label)
+{
+  GtkWidget *widget;
   gboolean rtl;
 
   widget = GTK_WIDGET (label);
@@ -2395,76 +2542,8 @@ gtk_label_ensure_layout (GtkLabel *label)
 				widget->allocation.width * PANGO_SCALE);
       else if (label->wrap)
 	{
-	  GtkWidgetAuxInfo *aux_info;
-	  gint longest_paragraph;
-	  gint width, height;
-
 	  pango_layout_set_wrap (label->layout, label->wrap_mode);
-	  
-	  aux_info = _gtk_widget_get_aux_info (widget, FALSE);
-	  if (aux_info && aux_info->width > 0)
-	    pango_layout_set_width (label->layout, aux_info->width * PANGO_SCALE);
-	  else
-	    {
-	      GdkScreen *screen = gtk_widget_get_screen (GTK_WIDGET (label));
-	      gint wrap_width;
-	      
-	      pango_layout_set_width (label->layout, -1);
-	      pango_layout_get_extents (label->layout, NULL, &logical_rect);
-
-	      width = logical_rect.width;
-	      
-	      /* Try to guess a reasonable maximum width */
-	      longest_paragraph = width;
-
-	      wrap_width = get_label_wrap_width (label);
-	      width = MIN (width, wrap_width);
-#ifndef MAEMO_CHANGES
-	      width = MIN (width,
-			   PANGO_SCALE * (gdk_screen_get_width (screen) + 1) / 2);
-#else
-	      width = MIN (width, PANGO_SCALE * (gdk_screen_get_width (screen) + 1) * 0.70);
-#endif
-              
-	      pango_layout_set_width (label->layout, width);
-	      pango_layout_get_extents (label->layout, NULL, &logical_rect);
-	      width = logical_rect.width;
-	      height = logical_rect.height;
-	      
-	      /* Unfortunately, the above may leave us with a very unbalanced looking paragraph,
-	       * so we try short search for a narrower width that leaves us with the same height
-	       */
-	      if (longest_paragraph > 0)
-		{
-		  gint nlines, perfect_width;
-		  
-		  nlines = pango_layout_get_line_count (label->layout);
-		  perfect_width = (longest_paragraph + nlines - 1) / nlines;
-		  
-		  if (perfect_width < width)
-		    {
-		      pango_layout_set_width (label->layout, perfect_width);
-		      pango_layout_get_extents (label->layout, NULL, &logical_rect);
-		      
-		      if (logical_rect.height <= height)
-			width = logical_rect.width;
-		      else
-			{
-			  gint mid_width = (perfect_width + width) / 2;
-			  
-			  if (mid_width > perfect_width)
-			    {
-			      pango_layout_set_width (label->layout, mid_width);
-			      pango_layout_get_extents (label->layout, NULL, &logical_rect);
-			      
-			      if (logical_rect.height <= height)
-				width = logical_rect.width;
-			    }
-			}
-		    }
-		}
-	      pango_layout_set_width (label->layout, width);
-	    }
+	  gtk_label_update_layout_width (label);
 	}
       else /* !label->wrap */
 	pango_layout_set_width (label->layout, -1);
@@ -2492,14 +2571,22 @@ gtk_label_size_request (GtkWidget      *widget,
    *
    * Instead of trying to detect changes to these quantities, if we
    * are wrapping, we just rewrap for each size request. Since
-   * size requisitions are cached by the GTK+ core, this is not
-   * expensive.
+   * size requisitions are cached by the GTK+ core, and the chosen
+   * wrap widths are remembered, this is not expensive.
+   *
+   * An ellipsized label is laid out at its allocated width, which
+   * gtk_label_update_layout_width() would replace by a wrap width.
    */
 
-  if (label->wrap)
-    gtk_label_clear_layout (label);
+  if (label->wrap && label->layout && !label->ellipsize)
+    gtk_label_update_layout_width (label);
+  else
+    {
+      if (label->wrap)
+        gtk_label_clear_layout (label);
 
-  gtk_label_ensure_layout (label);
+      gtk_label_ensure_layout (label);
+    }
 
   width = label->misc.xpad * 2;
   height = label->misc.ypad * 2;
@@ -2642,10 +2729,14 @@ gtk_label_direction_changed (GtkWidget        *widget,
 			     GtkTextDirection previous_dir)
 {
   GtkLabel *label = GTK_LABEL (widget);
+  GtkLabelPrivate *priv = GTK_LABEL_GET_PRIVATE (label);
 
   if (label->layout)
     pango_layout_context_changed (label->layout);
 
+  priv->longest_paragraph = -1;
+  priv->n_width_memo = 0;
+
   GTK_WIDGET_CLASS (gtk_label_parent_class)->direction_changed (widget, previous_dir);
 }
 
@@ -377,13 +377,21 @@ gtk_list_store_set_column_type (GtkListStore *list_store,
   list_store->column_headers[column] = type;
 }
 
+static void
+gtk_list_store_free_row (GtkTreeDataList *row,
+			 GtkListStore    *list_store)
+{
+  _gtk_tree_data_list_free (row, list_store->n_columns,
+			    list_store->column_headers);
+}
+
 static void
 gtk_list_store_finalize (GObject *object)
 {
   GtkListStore *list_store = GTK_LIST_STORE (object);
 
   g_sequence_foreach (list_store->seq,
-		      (GFunc) _gtk_tree_data_list_free, list_store->column_headers);
+		      (GFunc) gtk_list_store_free_row, list_store);
 
   g_sequence_free (list_store->seq);
 
@@ -482,20 +490,16 @@ gtk_list_store_get_value (GtkTreeModel *tree_model,
 {
   GtkListStore *list_store = (GtkListStore *) tree_model;
   GtkTreeDataList *list;
-  gint tmp_column = column;
 
   g_return_if_fail (column < list_store->n_columns);
   g_return_if_fail (VALID_ITER (iter, list_store));
 		    
   list = g_sequence_get (iter->user_data);
 
-  while (tmp_column-- > 0 && list)
-    list = list->next;
-
   if (list == NULL)
     g_value_init (value, list_store->column_headers[column]);
   else
-    _gtk_tree_data_list_node_to_value (list,
+    _gtk_tree_data_list_node_to_value (&list[column],
 				       list_store->column_headers[column],
 				       value);
 }
@@ -591,8 +595,6 @@ gtk_list_store_real_set_value (GtkListStore *list_store,
 			       gboolean      sort)
 {
   GtkTreeDataList *list;
-  GtkTreeDataList *prev;
-  gint old_column = column;
   GValue real_value = {0, };
   gboolean converted = FALSE;
   gboolean retval = FALSE;
@@ -620,48 +622,17 @@ gtk_list_store_real_set_value (GtkListStore *list_store,
       converted = TRUE;
     }
 
-  prev = list = g_sequence_get (iter->user_data);
-
-  while (list != NULL)
-    {
-      if (column == 0)
-	{
-	  if (converted)
-	    _gtk_tree_data_list_value_to_node (list, &real_value);
-	  else
-	    _gtk_tree_data_list_value_to_node (list, value);
-	  retval = TRUE;
-	  if (converted)
-	    g_value_unset (&real_value);
-         if (sort && GTK_LIST_STORE_IS_SORTED (list_store))
-            gtk_list_store_sort_iter_changed (list_store, iter, old_column);
-	  return retval;
-	}
-
-      column--;
-      prev = list;
-      list = list->next;
-    }
+  list = g_sequence_get (iter->user_data);
 
-  if (g_sequence_get (iter->user_data) == NULL)
+  if (list == NULL)
     {
-      list = _gtk_tree_data_list_alloc();
+      list = _gtk_tree_data_list_alloc (list_store->n_columns);
       g_sequence_set (iter->user_data, list);
-      list->next = NULL;
-    }
-  else
-    {
-      list = prev->next = _gtk_tree_data_list_alloc ();
-      list->next = NULL;
     }
 
-  while (column != 0)
-    {
-      list->next = _gtk_tree_data_list_alloc ();
-      list = list->next;
-      list->next = NULL;
-      column --;
-    }
+  _gtk_tree_data_list_invalidate_collate_key (list, list_store->n_columns, column);
+
+  list = &list[column];
 
   if (converted)
     _gtk_tree_data_list_value_to_node (list, &real_value);
@@ -673,7 +644,7 @@ gtk_list_store_real_set_value (GtkListStore *list_store,
     g_value_unset (&real_value);
 
   if (sort && GTK_LIST_STORE_IS_SORTED (list_store))
-    gtk_list_store_sort_iter_changed (list_store, iter, old_column);
+    gtk_list_store_sort_iter_changed (list_store, iter, column);
 
   return retval;
 }
@@ -962,7 +933,7 @@ gtk_list_store_remove (GtkListStore *list_store,
   ptr = iter->user_data;
   next = g_sequence_iter_next (ptr);
   
-  _gtk_tree_data_list_free (g_sequence_get (ptr), list_store->column_headers);
+  gtk_list_store_free_row (g_sequence_get (ptr), list_store);
   g_sequence_remove (iter->user_data);
 
   list_store->length--;
@@ -1310,32 +1281,13 @@ gtk_list_store_drag_data_received (GtkTreeDragDest   *drag_dest,
       if (retval)
         {
           GtkTreeDataList *dl = g_sequence_get (src_iter.user_data);
-          GtkTreeDataList *copy_head = NULL;
-          GtkTreeDataList *copy_prev = NULL;
-          GtkTreeDataList *copy_iter = NULL;
 	  GtkTreePath *path;
-          gint col;
-
-          col = 0;
-          while (dl)
-            {
-              copy_iter = _gtk_tree_data_list_node_copy (dl,
-                                                         list_store->column_headers[col]);
-
-              if (copy_head == NULL)
-                copy_head = copy_iter;
-
-              if (copy_prev)
-                copy_prev->next = copy_iter;
-
-              copy_prev = copy_iter;
-
-              dl = dl->next;
-              ++col;
-            }
 
 	  dest_iter.stamp = list_store->stamp;
-          g_sequence_set (dest_iter.user_data, copy_head);
+          g_sequence_set (dest_iter.user_data,
+                          _gtk_tree_data_list_copy (dl,
+                                                    list_store->n_columns,
+                                                    list_store->column_headers));
 
 	  path = gtk_list_store_get_path (tree_model, &dest_iter);
 	  gtk_tree_model_row_changed (tree_model, path, &dest_iter);
@@ -1677,7 +1629,16 @@ gtk_list_store_compare_func (GSequenceIter *a,
   g_assert (VALID_ITER (&iter_a, list_store));
   g_assert (VALID_ITER (&iter_b, list_store));
   
-  retval = (* func) (GTK_TREE_MODEL (list_store), &iter_a, &iter_b, data);
+  if (list_store->sort_column_id != -1 &&
+      _gtk_tree_data_list_can_collate (func, data,
+				       list_store->n_columns,
+				       list_store->column_headers))
+    retval = _gtk_tree_data_list_collate_compare (g_sequence_get (a),
+						  g_sequence_get (b),
+						  list_store->n_columns,
+						  GPOINTER_TO_INT (data));
+  else
+    retval = (* func) (GTK_TREE_MODEL (list_store), &iter_a, &iter_b, data);
 
   if (list_store->order == GTK_SORT_DESCENDING)
     {
@@ -44,6 +44,7 @@ struct _GtkPrintOperationPrivate
   guint cancelled          : 1;
   guint allow_async        : 1;
   guint is_sync            : 1;
+  guint render_in_thread   : 1;
 
   guint print_pages_idle_id;
   guint show_progress_timeout_id;
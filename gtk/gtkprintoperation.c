@@ -33,6 +33,7 @@
 #include "gtkalias.h"
 
 #define SHOW_PROGRESS_TIME 1200
+#define RENDER_PROGRESS_TIME 100
 
 #define GTK_PRINT_OPERATION_GET_PRIVATE(obj)(G_TYPE_INSTANCE_GET_PRIVATE ((obj), GTK_TYPE_PRINT_OPERATION, GtkPrintOperationPrivate))
 
@@ -67,7 +68,8 @@ enum
   PROP_EXPORT_FILENAME,
   PROP_STATUS,
   PROP_STATUS_STRING,
-  PROP_CUSTOM_TAB_LABEL
+  PROP_CUSTOM_TAB_LABEL,
+  PROP_RENDER_IN_THREAD
 };
 
 static guint signals[LAST_SIGNAL] = { 0 };
@@ -311,6 +313,9 @@ gtk_print_operation_set_property (GObject      *object,
     case PROP_CUSTOM_TAB_LABEL:
       gtk_print_operation_set_custom_tab_label (op, g_value_get_string (value));
       break;
+    case PROP_RENDER_IN_THREAD:
+      gtk_print_operation_set_render_in_thread (op, g_value_get_boolean (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -370,6 +375,9 @@ gtk_print_operation_get_property (GObject    *object,
     case PROP_CUSTOM_TAB_LABEL:
       g_value_set_string (value, priv->custom_tab_label);
       break;
+    case PROP_RENDER_IN_THREAD:
+      g_value_set_boolean (value, priv->render_in_thread);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1153,6 +1161,29 @@ gtk_print_operation_class_init (GtkPrintOperationClass *class)
 							NULL,
 							GTK_PARAM_READWRITE));
 
+  /**
+   * GtkPrintOperation:render-in-thread:
+   *
+   * Determines whether pages are rendered in a separate thread
+   * when printing or exporting, while the main loop keeps running.
+   * The #GtkPrintOperation::request-page-setup and
+   * #GtkPrintOperation::draw-page signals are then emitted in that
+   * thread, one page after the other, so their handlers must not
+   * call GTK+ functions and must be safe against what the rest of
+   * the application does at the same time.
+   *
+   * This has no effect on previews, or if threads have not been
+   * initialized.
+   *
+   * Since: 2.14
+   */
+  g_object_class_install_property (gobject_class,
+				   PROP_RENDER_IN_THREAD,
+				   g_param_spec_boolean ("render-in-thread",
+							 P_("Render in thread"),
+							 P_("TRUE if pages are rendered in a separate thread."),
+							 FALSE,
+							 GTK_PARAM_READWRITE));
 }
 
 /**
@@ -1676,6 +1707,38 @@ gtk_print_operation_set_allow_async (GtkPrintOperation  *op,
 }
 
 
+/**
+ * gtk_print_operation_set_render_in_thread:
+ * @op: a #GtkPrintOperation
+ * @render_in_thread: %TRUE to render pages in a separate thread
+ *
+ * Sets whether pages are rendered in a separate thread, which
+ * requires #GtkPrintOperation::request-page-setup and
+ * #GtkPrintOperation::draw-page handlers that can run outside
+ * of the main thread. See #GtkPrintOperation:render-in-thread.
+ *
+ * Since: 2.14
+ */
+void
+gtk_print_operation_set_render_in_thread (GtkPrintOperation *op,
+					  gboolean           render_in_thread)
+{
+  GtkPrintOperationPrivate *priv;
+
+  g_return_if_fail (GTK_IS_PRINT_OPERATION (op));
+
+  priv = op->priv;
+
+  render_in_thread = render_in_thread != FALSE;
+
+  if (priv->render_in_thread != render_in_thread)
+    {
+      priv->render_in_thread = render_in_thread;
+
+      g_object_notify (G_OBJECT (op), "render-in-thread");
+    }
+}
+
 /**
  * gtk_print_operation_set_custom_tab_label:
  * @op: a #GtkPrintOperation
@@ -1905,6 +1968,9 @@ typedef struct
  
   gboolean initialized;
   gboolean is_preview; 
+
+  GThread *thread;
+  guint thread_progress_id;
 } PrintPagesData;
 
 static void
@@ -1994,6 +2060,24 @@ increment_page_sequence (PrintPagesData *data)
   return TRUE;
 }
 
+/* Moves on to the next page to render, counting copies.
+ * Returns FALSE when all pages are done.
+ */
+static gboolean
+next_page (PrintPagesData *data)
+{
+  g_atomic_int_inc (&data->total);
+  data->collated++;
+  if (data->collated == data->collated_copies)
+    {
+      data->collated = 0;
+      if (!increment_page_sequence (data))
+	return FALSE;
+    }
+
+  return TRUE;
+}
+
 static void
 print_pages_idle_done (gpointer user_data)
 {
@@ -2005,6 +2089,10 @@ print_pages_idle_done (gpointer user_data)
 
   priv->print_pages_idle_id = 0;
 
+  /* The render thread took over, it finishes the job */
+  if (data->thread != NULL)
+    return;
+
   if (priv->show_progress_timeout_id > 0)
     {
       g_source_remove (priv->show_progress_timeout_id);
@@ -2045,7 +2133,7 @@ update_progress (PrintPagesData *data)
 	    text = g_strdup (_("Preparing"));
 	}
       else if (priv->status == GTK_PRINT_STATUS_GENERATING_DATA)
-	text = g_strdup_printf (_("Printing %d"), data->total);
+	text = g_strdup_printf (_("Printing %d"), g_atomic_int_get (&data->total));
       
       if (text)
 	{
@@ -2099,6 +2187,63 @@ common_render_page (GtkPrintOperation *op,
   g_object_unref (page_setup);
 }
 
+static gboolean
+print_pages_thread_progress (gpointer user_data)
+{
+  update_progress ((PrintPagesData *) user_data);
+
+  return TRUE;
+}
+
+static gboolean
+print_pages_thread_done (gpointer user_data)
+{
+  PrintPagesData *data;
+  GtkPrintOperationPrivate *priv;
+
+  data = (PrintPagesData*)user_data;
+  priv = data->op->priv;
+
+  g_thread_join (data->thread);
+  data->thread = NULL;
+
+  g_source_remove (data->thread_progress_id);
+  data->thread_progress_id = 0;
+
+  if (priv->cancelled)
+    _gtk_print_operation_set_status (data->op, GTK_PRINT_STATUS_FINISHED_ABORTED, NULL);
+
+  g_signal_emit (data->op, signals[END_PRINT], 0, priv->print_context);
+  priv->end_run (data->op, priv->is_sync, priv->cancelled);
+
+  update_progress (data);
+
+  print_pages_idle_done (data);
+
+  return FALSE;
+}
+
+/* Renders the pages one after the other, like print_pages_idle()
+ * does across idles, and hands back to the main loop when done.
+ * Only the cancelled flag is shared with the main thread meanwhile.
+ */
+static gpointer
+print_pages_thread (gpointer user_data)
+{
+  PrintPagesData *data;
+  GtkPrintOperationPrivate *priv;
+
+  data = (PrintPagesData*)user_data;
+  priv = data->op->priv;
+
+  while (!priv->cancelled && next_page (data))
+    common_render_page (data->op, data->page);
+
+  gdk_threads_add_idle (print_pages_thread_done, data);
+
+  return NULL;
+}
+
 static gboolean
 print_pages_idle (gpointer user_data)
 {
@@ -2204,18 +2349,25 @@ print_pages_idle (gpointer user_data)
       goto out;
     }
 
-  data->total++;
-  data->collated++;
-  if (data->collated == data->collated_copies)
+  if (priv->render_in_thread && !data->is_preview && g_thread_supported ())
     {
-      data->collated = 0;
-      if (!increment_page_sequence (data))
+      data->thread = g_thread_create (print_pages_thread, data, TRUE, NULL);
+      if (data->thread != NULL)
 	{
-	  done = TRUE;
-
-	  goto out;
+	  data->thread_progress_id =
+	    gdk_threads_add_timeout (RENDER_PROGRESS_TIME,
+				     print_pages_thread_progress,
+				     data);
+	  return FALSE;
 	}
     }
+
+  if (!next_page (data))
+    {
+      done = TRUE;
+
+      goto out;
+    }
  
   if (data->is_preview && !priv->cancelled)
     {
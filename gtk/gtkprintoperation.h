@@ -161,6 +161,8 @@ void                    gtk_print_operation_set_allow_async        (GtkPrintOper
 								    gboolean            allow_async);
 void                    gtk_print_operation_set_custom_tab_label   (GtkPrintOperation  *op,
 								    const gchar        *label);
+void                    gtk_print_operation_set_render_in_thread   (GtkPrintOperation  *op,
+								    gboolean            render_in_thread);
 GtkPrintOperationResult gtk_print_operation_run                    (GtkPrintOperation  *op,
 								    GtkPrintOperationAction action,
 								    GtkWindow          *parent,
@@ -22,19 +22,8 @@
 
 #include "config.h"
 
-/* these must be defined even when HAVE_GNU_FTW is not defined
- * because (really) old versions of GNU libc have ftw.h but do
- * export ftw() and friends only if _XOPEN_SOURCE and _GNU_SOURCE
- * are defined. see bug #444097.
- */
-#define _XOPEN_SOURCE 500
-#define _GNU_SOURCE 
-
-#ifdef HAVE_FTW_H
-#include <ftw.h>
-#endif
-
 #include "gtksearchenginesimple.h"
+#include "gtksearchindex.h"
 #include "gtkprivate.h"
 
 #include <string.h>
@@ -47,6 +36,7 @@ typedef struct
   
   gchar *path;
   gchar **words;
+  gchar *index_filename;
   GList *found_list;
   
   gint n_processed_files;
@@ -127,6 +117,7 @@ search_thread_data_free (SearchThreadData *data)
   g_object_unref (data->engine);
   g_free (data->path);
   g_strfreev (data->words);
+  g_free (data->index_filename);
   g_free (data);
 }
 
@@ -191,100 +182,83 @@ send_batch (SearchThreadData *data)
   data->uri_hits = NULL;
 }
 
-static GStaticPrivate search_thread_data = G_STATIC_PRIVATE_INIT;
+/* Like strstr() on the lowercased name, without allocating */
+static gboolean
+name_contains (const gchar *name,
+	       const gchar *word)
+{
+  gsize len = strlen (word);
+
+  if (len == 0)
+    return TRUE;
+
+  for (; *name; name++)
+    if (g_ascii_strncasecmp (name, word, len) == 0)
+      return TRUE;
+
+  return FALSE;
+}
 
-#ifdef HAVE_FTW_H
-static int
-search_visit_func (const char        *fpath,
-		   const struct stat *sb,
-		   int                typeflag,
-		   struct FTW        *ftwbuf)
+static void
+search_add_directory (const gchar *dirname,
+		      GPtrArray   *names,
+		      gpointer     user_data)
 {
   SearchThreadData *data;
-  gint i;
-  const gchar *name; 
-  gchar *lower_name;
-  gchar *uri;
-  gboolean hit;
-  gboolean is_hidden;
-  
-  data = (SearchThreadData*)g_static_private_get (&search_thread_data);
-
-  if (data->cancelled)
-#ifdef HAVE_GNU_FTW
-    return FTW_STOP;
-#else
-    return 1;
-#endif /* HAVE_GNU_FTW */
-
-  name = strrchr (fpath, '/');
-  if (name)
-    name++;
-  else
-    name = fpath;
-
-  is_hidden = *name == '.';
-	
-  hit = FALSE;
-  
-  if (!is_hidden) 
+  guint i, j;
+
+  data = user_data;
+
+  for (i = 0; i < names->len; i++)
     {
-      lower_name = g_ascii_strdown (name, -1);
-      
+      const gchar *name = g_ptr_array_index (names, i);
+      gboolean hit;
+
       hit = TRUE;
-      for (i = 0; data->words[i] != NULL; i++) 
+      for (j = 0; data->words[j] != NULL; j++)
 	{
-	  if (strstr (lower_name, data->words[i]) == NULL) 
+	  if (!name_contains (name, data->words[j]))
 	    {
 	      hit = FALSE;
 	      break;
 	    }
 	}
-      g_free (lower_name);
-    }
 
-  if (hit) 
-    {
-      uri = g_filename_to_uri (fpath, NULL, NULL);
-      data->uri_hits = g_list_prepend (data->uri_hits, uri);
-    }
+      if (hit)
+	{
+	  gchar *path, *uri;
 
-  data->n_processed_files++;
-  
-  if (data->n_processed_files > BATCH_SIZE)
-    send_batch (data);
-
-#ifdef HAVE_GNU_FTW
-  if (is_hidden)
-    return FTW_SKIP_SUBTREE;
-  else
-    return FTW_CONTINUE;
-#else
-  return 0;
-#endif /* HAVE_GNU_FTW */
+	  path = g_build_filename (dirname, name, NULL);
+	  uri = g_filename_to_uri (path, NULL, NULL);
+	  data->uri_hits = g_list_prepend (data->uri_hits, uri);
+	  g_free (path);
+	}
+
+      data->n_processed_files++;
+
+      if (data->n_processed_files > BATCH_SIZE)
+	send_batch (data);
+    }
 }
-#endif /* HAVE_FTW_H */
 
 static gpointer 
 search_thread_func (gpointer user_data)
 {
-#ifdef HAVE_FTW_H
   SearchThreadData *data;
   
   data = user_data;
-  
-  g_static_private_set (&search_thread_data, data, NULL);
 
-  nftw (data->path, search_visit_func, 20,
-#ifdef HAVE_GNU_FTW
-        FTW_ACTIONRETVAL |
-#endif
-        FTW_PHYS);
+  /* Use the index if there is one, and crawl the disk otherwise */
+  if (data->index_filename == NULL ||
+      !_gtk_search_index_query (data->index_filename, data->path,
+				search_add_directory, data,
+				&data->cancelled))
+    _gtk_search_crawl (data->path, search_add_directory, data,
+		       &data->cancelled);
 
   send_batch (data);
   
   gdk_threads_add_idle (search_thread_done_idle, data);
-#endif /* HAVE_FTW_H */
   
   return NULL;
 }
@@ -293,6 +267,7 @@ static void
 gtk_search_engine_simple_start (GtkSearchEngine *engine)
 {
   GtkSearchEngineSimple *simple;
+  GtkSearchIndex *index;
   SearchThreadData *data;
   
   simple = GTK_SEARCH_ENGINE_SIMPLE (engine);
@@ -304,6 +279,11 @@ gtk_search_engine_simple_start (GtkSearchEngine *engine)
     return;
 	
   data = search_thread_data_new (simple, simple->priv->query);
+
+  index = _gtk_search_index_get_default ();
+  if (_gtk_search_index_is_ready (index) &&
+      _gtk_search_index_covers (index, data->path))
+    data->index_filename = g_strdup (_gtk_search_index_get_filename (index));
   
   g_thread_create (search_thread_func, data, FALSE, NULL);
   
@@ -327,7 +307,7 @@ gtk_search_engine_simple_stop (GtkSearchEngine *engine)
 static gboolean
 gtk_search_engine_simple_is_indexed (GtkSearchEngine *engine)
 {
-  return FALSE;
+  return _gtk_search_index_is_ready (_gtk_search_index_get_default ());
 }
 
 static void
@@ -374,9 +354,5 @@ _gtk_search_engine_simple_init (GtkSearchEngineSimple *engine)
 GtkSearchEngine *
 _gtk_search_engine_simple_new (void)
 {
-#ifdef HAVE_FTW_H
   return g_object_new (GTK_TYPE_SEARCH_ENGINE_SIMPLE, NULL);
-#else
-  return NULL;
-#endif
 }
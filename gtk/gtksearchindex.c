@@ -0,0 +1,902 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include <glib/gstdio.h>
+#include <gio/gio.h>
+#include <gdk/gdk.h>
+
+#include "gtksearchindex.h"
+
+/* The filename index of GtkSearchEngineSimple.
+ *
+ * The index lists the non-hidden files below the home directory, so
+ * that searching does not have to walk the disk. It lives in the user
+ * cache directory and is read with mmap. The format is, with CARD32
+ * in big endian:
+ *
+ *  0  magic "GtkSIdx", nul-terminated
+ *  8  CARD32 version
+ * 12  CARD32 time of the last full build, in seconds since the epoch
+ * 16  CARD32 flags
+ * 20  the indexed directory, nul-terminated
+ *
+ * followed by one record per directory that has non-hidden entries:
+ *
+ *     the directory, nul-terminated
+ *     the names of its non-hidden entries, each nul-terminated
+ *     an empty string
+ *
+ * The index is rebuilt from scratch when it is older than a day.
+ * In between, file monitors on the upper directories mark directories
+ * as changed, and these are crawled again and replaced in the index.
+ *
+ * The crawl gives up on trees that are deeper or larger than is
+ * sensible to index. The index is then written without records and
+ * flagged incomplete, so that searches walk the disk instead, and
+ * no process tries again before the index is a day old. Only one
+ * process builds the index at a time, guarded by a lock file next
+ * to it.
+ */
+
+#define INDEX_MAGIC "GtkSIdx"
+#define INDEX_MAGIC_LEN 8
+#define INDEX_VERSION 2
+#define INDEX_HEADER_SIZE 20
+
+#define INDEX_FLAG_INCOMPLETE (1 << 0)
+
+#define INDEX_WORD(contents, offset) \
+  (GUINT32_FROM_BE (*(guint32 *)((contents) + (offset))))
+
+#define INDEX_MAX_AGE (24 * 60 * 60)
+#define CRAWL_THREADS 4
+#define CRAWL_MAX_DEPTH 16
+#define CRAWL_MAX_ENTRIES 200000
+/* A lock file this old was left behind by a build that died */
+#define LOCK_MAX_AGE (60 * 60)
+/* Inotify watches are shared by all processes of the user */
+#define MAX_MONITORS 32
+#define UPDATE_DELAY 5
+
+struct _GtkSearchIndex
+{
+  gchar *root;
+  gchar *filename;
+
+  GSList *monitors;
+  GSList *dirty;
+  guint update_id;
+
+  guint ready : 1;
+  guint building : 1;
+};
+
+static gboolean
+path_is_below (const gchar *path,
+               const gchar *dirname)
+{
+  gsize len = strlen (dirname);
+
+  if (strncmp (path, dirname, len) != 0)
+    return FALSE;
+
+  return path[len] == '\0' ||
+         path[len] == G_DIR_SEPARATOR ||
+         (len > 0 && dirname[len - 1] == G_DIR_SEPARATOR);
+}
+
+static gint
+path_depth (const gchar *path)
+{
+  gint depth = 0;
+
+  for (; *path; path++)
+    if (*path == G_DIR_SEPARATOR)
+      depth++;
+
+  return depth;
+}
+
+/* The crawler
+ *
+ * Directories are read by a pool of threads, each directory found
+ * is pushed back to the pool.
+ */
+typedef struct
+{
+  GThreadPool *pool;
+  GMutex *lock;
+  GCond *done;
+  gint pending;
+
+  gint max_depth;
+  guint max_entries;
+  guint n_entries;
+  gboolean truncated;
+
+  GtkSearchIndexFunc func;
+  gpointer user_data;
+  volatile gboolean *cancelled;
+} Crawl;
+
+static void
+crawl_directory (gpointer data,
+                 gpointer user_data)
+{
+  gchar *dirname = data;
+  Crawl *crawl = user_data;
+  GPtrArray *names;
+  GSList *subdirs = NULL, *l;
+  GDir *dir = NULL;
+  const gchar *name;
+  guint i;
+
+  names = g_ptr_array_new ();
+
+  if (!*crawl->cancelled)
+    dir = g_dir_open (dirname, 0, NULL);
+
+  if (dir)
+    {
+      while ((name = g_dir_read_name (dir)) != NULL)
+        {
+          gchar *filename;
+          struct stat st;
+
+          /* Hidden files are neither listed nor descended into */
+          if (name[0] == '.')
+            continue;
+
+          g_ptr_array_add (names, g_strdup (name));
+
+          filename = g_build_filename (dirname, name, NULL);
+          if (g_lstat (filename, &st) == 0 && S_ISDIR (st.st_mode))
+            subdirs = g_slist_prepend (subdirs, filename);
+          else
+            g_free (filename);
+        }
+
+      g_dir_close (dir);
+    }
+
+  g_mutex_lock (crawl->lock);
+
+  crawl->n_entries += names->len;
+  if (crawl->max_entries > 0 && crawl->n_entries > crawl->max_entries)
+    crawl->truncated = TRUE;
+
+  if (names->len > 0 && !*crawl->cancelled && !crawl->truncated)
+    crawl->func (dirname, names, crawl->user_data);
+
+  for (l = subdirs; l; l = l->next)
+    {
+      if (crawl->max_depth > 0 && path_depth (l->data) > crawl->max_depth)
+        crawl->truncated = TRUE;
+
+      /* There is no point in going on once the result is incomplete */
+      if (crawl->truncated)
+        {
+          g_free (l->data);
+          continue;
+        }
+
+      crawl->pending++;
+      g_thread_pool_push (crawl->pool, l->data, NULL);
+    }
+
+  if (--crawl->pending == 0)
+    g_cond_signal (crawl->done);
+
+  g_mutex_unlock (crawl->lock);
+
+  g_slist_free (subdirs);
+  for (i = 0; i < names->len; i++)
+    g_free (g_ptr_array_index (names, i));
+  g_ptr_array_free (names, TRUE);
+  g_free (dirname);
+}
+
+/* Crawls directories down to a path depth of max_depth, and at
+ * most max_entries entries, or everything if these are 0. Returns
+ * FALSE if it stopped at one of the limits.
+ */
+static gboolean
+crawl_tree (const gchar        *root,
+            gint                max_depth,
+            guint               max_entries,
+            GtkSearchIndexFunc  func,
+            gpointer            user_data,
+            volatile gboolean  *cancelled)
+{
+  Crawl crawl;
+
+  crawl.lock = g_mutex_new ();
+  crawl.done = g_cond_new ();
+  crawl.pending = 1;
+  crawl.max_depth = max_depth;
+  crawl.max_entries = max_entries;
+  crawl.n_entries = 0;
+  crawl.truncated = FALSE;
+  crawl.func = func;
+  crawl.user_data = user_data;
+  crawl.cancelled = cancelled;
+  crawl.pool = g_thread_pool_new (crawl_directory, &crawl,
+                                  CRAWL_THREADS, FALSE, NULL);
+
+  g_mutex_lock (crawl.lock);
+  g_thread_pool_push (crawl.pool, g_strdup (root), NULL);
+  while (crawl.pending > 0)
+    g_cond_wait (crawl.done, crawl.lock);
+  g_mutex_unlock (crawl.lock);
+
+  g_thread_pool_free (crawl.pool, FALSE, TRUE);
+  g_cond_free (crawl.done);
+  g_mutex_free (crawl.lock);
+
+  return !crawl.truncated;
+}
+
+/*
+ * _gtk_search_crawl:
+ * @root: the directory to crawl
+ * @func: called for every directory below @root
+ * @user_data: data for @func
+ * @cancelled: location that is set to %TRUE to stop crawling
+ *
+ * Walks the tree below @root with several threads, skipping hidden
+ * files and directories, and returns when it is done.
+ */
+void
+_gtk_search_crawl (const gchar        *root,
+                   GtkSearchIndexFunc  func,
+                   gpointer            user_data,
+                   volatile gboolean  *cancelled)
+{
+  crawl_tree (root, 0, 0, func, user_data, cancelled);
+}
+
+/* Reading the index */
+
+/* Returns the indexed directory, or NULL if the index is not valid */
+static const gchar *
+index_get_root (const gchar *contents,
+                gsize        length)
+{
+  if (length <= INDEX_HEADER_SIZE ||
+      memcmp (contents, INDEX_MAGIC, INDEX_MAGIC_LEN) != 0 ||
+      INDEX_WORD (contents, 8) != INDEX_VERSION ||
+      contents[length - 1] != '\0')
+    return NULL;
+
+  return contents + INDEX_HEADER_SIZE;
+}
+
+/* Only valid indexes can be incomplete */
+static gboolean
+index_is_complete (const gchar *contents)
+{
+  return (INDEX_WORD (contents, 16) & INDEX_FLAG_INCOMPLETE) == 0;
+}
+
+static gboolean
+index_foreach (const gchar        *contents,
+               gsize               length,
+               const gchar        *path,
+               GtkSearchIndexFunc  func,
+               gpointer            user_data,
+               volatile gboolean  *cancelled)
+{
+  const gchar *p, *end;
+  GPtrArray *names;
+
+  p = index_get_root (contents, length);
+  if (!p || !index_is_complete (contents))
+    return FALSE;
+
+  end = contents + length;
+  p += strlen (p) + 1;
+
+  names = g_ptr_array_new ();
+
+  while (p < end && !(cancelled && *cancelled))
+    {
+      const gchar *dirname = p;
+      gboolean wanted;
+
+      p += strlen (p) + 1;
+      wanted = path == NULL || path_is_below (dirname, path);
+
+      g_ptr_array_set_size (names, 0);
+      while (p < end && *p != '\0')
+        {
+          if (wanted)
+            g_ptr_array_add (names, (gpointer) p);
+          p += strlen (p) + 1;
+        }
+      p++;
+
+      if (wanted && names->len > 0)
+        func (dirname, names, user_data);
+    }
+
+  g_ptr_array_free (names, TRUE);
+
+  return TRUE;
+}
+
+/*
+ * _gtk_search_index_query:
+ * @filename: the index file, see _gtk_search_index_get_filename()
+ * @path: the directory to search in
+ * @func: called for every indexed directory below @path
+ * @user_data: data for @func
+ * @cancelled: location that is set to %TRUE to stop the query
+ *
+ * Can be called from any thread.
+ *
+ * Returns: %FALSE if the index could not be read, in which case
+ *   @func has not been called
+ */
+gboolean
+_gtk_search_index_query (const gchar        *filename,
+                         const gchar        *path,
+                         GtkSearchIndexFunc  func,
+                         gpointer            user_data,
+                         volatile gboolean  *cancelled)
+{
+  GMappedFile *map;
+  gboolean retval;
+
+  map = g_mapped_file_new (filename, FALSE, NULL);
+  if (!map)
+    return FALSE;
+
+  retval = index_foreach (g_mapped_file_get_contents (map),
+                          g_mapped_file_get_length (map),
+                          path, func, user_data, cancelled);
+
+  g_mapped_file_free (map);
+
+  return retval;
+}
+
+/* Building the index */
+
+typedef struct
+{
+  GtkSearchIndex *index;
+  gchar *root;
+  gchar *filename;
+  GSList *dirty;        /* NULL for a full build */
+  GString *records;
+  guint32 build_time;
+  gboolean complete;
+  volatile gboolean cancelled;
+  gboolean success;
+} Build;
+
+static void
+build_add_directory (const gchar *dirname,
+                     GPtrArray   *names,
+                     gpointer     user_data)
+{
+  Build *build = user_data;
+  guint i;
+
+  g_string_append_len (build->records, dirname, strlen (dirname) + 1);
+
+  for (i = 0; i < names->len; i++)
+    {
+      const gchar *name = g_ptr_array_index (names, i);
+
+      g_string_append_len (build->records, name, strlen (name) + 1);
+    }
+
+  g_string_append_c (build->records, '\0');
+}
+
+static void
+build_copy_directory (const gchar *dirname,
+                      GPtrArray   *names,
+                      gpointer     user_data)
+{
+  Build *build = user_data;
+  GSList *l;
+
+  for (l = build->dirty; l; l = l->next)
+    if (path_is_below (dirname, l->data))
+      return;
+
+  build_add_directory (dirname, names, user_data);
+}
+
+/* The index lists the names of private files, so it is only
+ * readable by the user, and written to a temporary file that
+ * is renamed over the old index once complete.
+ */
+static gboolean
+build_write (Build *build)
+{
+  GString *out;
+  guint32 word;
+  gchar *dirname, *tmp_filename;
+  const gchar *p;
+  gssize n;
+  gsize left;
+  gint fd;
+  gboolean retval;
+
+  out = g_string_sized_new (INDEX_HEADER_SIZE + strlen (build->root) + 1 +
+                            build->records->len);
+
+  g_string_append_len (out, INDEX_MAGIC, INDEX_MAGIC_LEN);
+  word = GUINT32_TO_BE (INDEX_VERSION);
+  g_string_append_len (out, (const gchar *) &word, 4);
+  word = GUINT32_TO_BE (build->build_time);
+  g_string_append_len (out, (const gchar *) &word, 4);
+  word = GUINT32_TO_BE (build->complete ? 0 : INDEX_FLAG_INCOMPLETE);
+  g_string_append_len (out, (const gchar *) &word, 4);
+  g_string_append_len (out, build->root, strlen (build->root) + 1);
+  if (build->complete)
+    g_string_append_len (out, build->records->str, build->records->len);
+
+  dirname = g_path_get_dirname (build->filename);
+  g_mkdir_with_parents (dirname, 0700);
+  g_chmod (dirname, 0700);
+  g_free (dirname);
+
+  retval = FALSE;
+
+  tmp_filename = g_strconcat (build->filename, ".XXXXXX", NULL);
+  fd = g_mkstemp (tmp_filename);
+  if (fd < 0)
+    goto out;
+
+  p = out->str;
+  left = out->len;
+  while (left > 0)
+    {
+      n = write (fd, p, left);
+      if (n < 0)
+        {
+          if (errno == EINTR)
+            continue;
+          break;
+        }
+
+      p += n;
+      left -= n;
+    }
+
+  if (close (fd) == 0 && left == 0 &&
+      g_rename (tmp_filename, build->filename) == 0)
+    retval = TRUE;
+  else
+    g_unlink (tmp_filename);
+
+out:
+  g_free (tmp_filename);
+  g_string_free (out, TRUE);
+
+  return retval;
+}
+
+/* Takes the lock that keeps other processes from building the
+ * index at the same time. A stale lock is taken over.
+ */
+static gboolean
+build_lock (Build *build)
+{
+  gchar *lock_filename, *dirname;
+  struct stat st;
+  gint fd;
+
+  dirname = g_path_get_dirname (build->filename);
+  g_mkdir_with_parents (dirname, 0700);
+  g_free (dirname);
+
+  lock_filename = g_strconcat (build->filename, ".lock", NULL);
+
+  fd = g_open (lock_filename, O_WRONLY | O_CREAT | O_EXCL, 0600);
+  if (fd < 0 && errno == EEXIST &&
+      g_stat (lock_filename, &st) == 0 &&
+      time (NULL) - st.st_mtime > LOCK_MAX_AGE)
+    {
+      g_unlink (lock_filename);
+      fd = g_open (lock_filename, O_WRONLY | O_CREAT | O_EXCL, 0600);
+    }
+
+  g_free (lock_filename);
+
+  if (fd < 0)
+    return FALSE;
+
+  close (fd);
+
+  return TRUE;
+}
+
+static void
+build_unlock (Build *build)
+{
+  gchar *lock_filename;
+
+  lock_filename = g_strconcat (build->filename, ".lock", NULL);
+  g_unlink (lock_filename);
+  g_free (lock_filename);
+}
+
+static gboolean build_done_idle (gpointer user_data);
+
+static gpointer
+build_thread (gpointer user_data)
+{
+  Build *build = user_data;
+  GMappedFile *map = NULL;
+  gboolean updated = FALSE;
+  gint max_depth;
+  GSList *l;
+
+  build->records = g_string_new (NULL);
+
+  /* Another process is building the index, it will be picked
+   * up by the next process that starts
+   */
+  if (!build_lock (build))
+    {
+      gdk_threads_add_idle (build_done_idle, build);
+
+      return NULL;
+    }
+
+  /* Keep everything but the changed directories */
+  if (build->dirty)
+    map = g_mapped_file_new (build->filename, FALSE, NULL);
+
+  if (map)
+    {
+      const gchar *contents = g_mapped_file_get_contents (map);
+
+      if (index_foreach (contents, g_mapped_file_get_length (map),
+                         NULL, build_copy_directory, build, NULL))
+        {
+          build->build_time = INDEX_WORD (contents, 12);
+          updated = TRUE;
+        }
+
+      g_mapped_file_free (map);
+    }
+
+  build->complete = TRUE;
+  max_depth = path_depth (build->root) + CRAWL_MAX_DEPTH;
+
+  if (updated)
+    {
+      for (l = build->dirty; l && build->complete; l = l->next)
+        build->complete = crawl_tree (l->data, max_depth, CRAWL_MAX_ENTRIES,
+                                      build_add_directory, build,
+                                      &build->cancelled);
+    }
+  else
+    {
+      g_string_truncate (build->records, 0);
+      build->complete = crawl_tree (build->root, max_depth, CRAWL_MAX_ENTRIES,
+                                    build_add_directory, build,
+                                    &build->cancelled);
+    }
+
+  build->success = build_write (build) && build->complete;
+
+  build_unlock (build);
+
+  gdk_threads_add_idle (build_done_idle, build);
+
+  return NULL;
+}
+
+static void
+index_start_build (GtkSearchIndex *index,
+                   GSList         *dirty)
+{
+  Build *build;
+
+  build = g_new0 (Build, 1);
+  build->index = index;
+  build->root = g_strdup (index->root);
+  build->filename = g_strdup (index->filename);
+  build->dirty = dirty;
+  build->build_time = (guint32) time (NULL);
+
+  index->building = TRUE;
+
+  if (!g_thread_create (build_thread, build, FALSE, NULL))
+    {
+      index->building = FALSE;
+      g_slist_foreach (build->dirty, (GFunc) g_free, NULL);
+      g_slist_free (build->dirty);
+      g_free (build->root);
+      g_free (build->filename);
+      g_free (build);
+    }
+}
+
+/* Keeping the index up to date */
+
+static gboolean
+index_update_timeout (gpointer user_data)
+{
+  GtkSearchIndex *index = user_data;
+
+  if (index->building)
+    return TRUE;
+
+  index->update_id = 0;
+
+  index_start_build (index, index->dirty);
+  index->dirty = NULL;
+
+  return FALSE;
+}
+
+static void
+index_monitor_changed (GFileMonitor      *monitor,
+                       GFile             *file,
+                       GFile             *other_file,
+                       GFileMonitorEvent  event,
+                       GtkSearchIndex    *index)
+{
+  GFile *parent;
+  gchar *basename, *dirname;
+  GSList *l;
+
+  if (event != G_FILE_MONITOR_EVENT_CREATED &&
+      event != G_FILE_MONITOR_EVENT_DELETED)
+    return;
+
+  basename = g_file_get_basename (file);
+  if (!basename || basename[0] == '.')
+    {
+      g_free (basename);
+      return;
+    }
+  g_free (basename);
+
+  parent = g_file_get_parent (file);
+  dirname = parent ? g_file_get_path (parent) : NULL;
+  if (parent)
+    g_object_unref (parent);
+  if (!dirname)
+    return;
+
+  /* Changed directories are crawled recursively, drop the ones
+   * that are covered by another one.
+   */
+  for (l = index->dirty; l; l = l->next)
+    if (path_is_below (dirname, l->data))
+      {
+        g_free (dirname);
+        dirname = NULL;
+        break;
+      }
+
+  if (dirname)
+    {
+      GSList *next;
+
+      for (l = index->dirty; l; l = next)
+        {
+          next = l->next;
+
+          if (path_is_below (l->data, dirname))
+            {
+              g_free (l->data);
+              index->dirty = g_slist_delete_link (index->dirty, l);
+            }
+        }
+
+      index->dirty = g_slist_prepend (index->dirty, dirname);
+    }
+
+  if (!index->update_id)
+    index->update_id = gdk_threads_add_timeout_seconds (UPDATE_DELAY,
+                                                        index_update_timeout,
+                                                        index);
+}
+
+static void
+collect_directory (const gchar *dirname,
+                   GPtrArray   *names,
+                   gpointer     user_data)
+{
+  g_ptr_array_add (user_data, (gpointer) dirname);
+}
+
+static gint
+compare_depth (gconstpointer a,
+               gconstpointer b)
+{
+  return path_depth (*(const gchar **) a) - path_depth (*(const gchar **) b);
+}
+
+/* Monitors the directories closest to the root, the number of
+ * monitors is limited on most systems.
+ */
+static void
+index_setup_monitors (GtkSearchIndex *index,
+                      GMappedFile    *map)
+{
+  GPtrArray *dirs;
+  GSList *l;
+  guint i;
+
+  for (l = index->monitors; l; l = l->next)
+    {
+      g_file_monitor_cancel (l->data);
+      g_object_unref (l->data);
+    }
+  g_slist_free (index->monitors);
+  index->monitors = NULL;
+
+  dirs = g_ptr_array_new ();
+  g_ptr_array_add (dirs, index->root);
+  index_foreach (g_mapped_file_get_contents (map),
+                 g_mapped_file_get_length (map),
+                 NULL, collect_directory, dirs, NULL);
+  g_ptr_array_sort (dirs, compare_depth);
+
+  for (i = 0; i < dirs->len && i < MAX_MONITORS; i++)
+    {
+      GFile *file;
+      GFileMonitor *monitor;
+
+      file = g_file_new_for_path (g_ptr_array_index (dirs, i));
+      monitor = g_file_monitor_directory (file, G_FILE_MONITOR_NONE,
+                                          NULL, NULL);
+      g_object_unref (file);
+
+      if (!monitor)
+        continue;
+
+      g_signal_connect (monitor, "changed",
+                        G_CALLBACK (index_monitor_changed), index);
+      index->monitors = g_slist_prepend (index->monitors, monitor);
+    }
+
+  g_ptr_array_free (dirs, TRUE);
+}
+
+/* Maps the index, and starts building it if it is missing or old */
+static void
+index_load (GtkSearchIndex *index)
+{
+  GMappedFile *map;
+  const gchar *contents, *root;
+  gsize length;
+
+  map = g_mapped_file_new (index->filename, FALSE, NULL);
+  if (map)
+    {
+      contents = g_mapped_file_get_contents (map);
+      length = g_mapped_file_get_length (map);
+      root = index_get_root (contents, length);
+
+      if (root && strcmp (root, index->root) == 0)
+        {
+          gboolean complete = index_is_complete (contents);
+
+          index->ready = complete;
+
+          if ((guint32) time (NULL) - INDEX_WORD (contents, 12) >= INDEX_MAX_AGE)
+            index_start_build (index, NULL);
+          else if (complete)
+            index_setup_monitors (index, map);
+        }
+      else
+        index_start_build (index, NULL);
+
+      g_mapped_file_free (map);
+    }
+  else
+    index_start_build (index, NULL);
+}
+
+static gboolean
+build_done_idle (gpointer user_data)
+{
+  Build *build = user_data;
+  GtkSearchIndex *index = build->index;
+
+  index->building = FALSE;
+
+  if (build->success)
+    {
+      GMappedFile *map;
+
+      index->ready = TRUE;
+
+      map = g_mapped_file_new (index->filename, FALSE, NULL);
+      if (map)
+        {
+          index_setup_monitors (index, map);
+          g_mapped_file_free (map);
+        }
+    }
+
+  g_slist_foreach (build->dirty, (GFunc) g_free, NULL);
+  g_slist_free (build->dirty);
+  g_string_free (build->records, TRUE);
+  g_free (build->root);
+  g_free (build->filename);
+  g_free (build);
+
+  return FALSE;
+}
+
+/*
+ * _gtk_search_index_get_default:
+ *
+ * Gets the index of the home directory, loading it or starting to
+ * build it on first use. Must be called from the main thread.
+ */
+GtkSearchIndex *
+_gtk_search_index_get_default (void)
+{
+  static GtkSearchIndex *index = NULL;
+
+  if (!index)
+    {
+      index = g_new0 (GtkSearchIndex, 1);
+      index->root = g_strdup (g_get_home_dir ());
+      index->filename = g_build_filename (g_get_user_cache_dir (),
+                                          "gtk-2.0", "search-index",
+                                          NULL);
+      index_load (index);
+    }
+
+  return index;
+}
+
+gboolean
+_gtk_search_index_is_ready (GtkSearchIndex *index)
+{
+  return index->ready;
+}
+
+gboolean
+_gtk_search_index_covers (GtkSearchIndex *index,
+                          const gchar    *path)
+{
+  return path_is_below (path, index->root);
+}
+
+const gchar *
+_gtk_search_index_get_filename (GtkSearchIndex *index)
+{
+  return index->filename;
+}
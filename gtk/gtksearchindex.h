@@ -0,0 +1,53 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GTK_SEARCH_INDEX_H__
+#define __GTK_SEARCH_INDEX_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GtkSearchIndex GtkSearchIndex;
+
+/* Receives the non-hidden entries of a directory. Called from
+ * several threads, but never concurrently for the same crawl
+ * or query.
+ */
+typedef void (* GtkSearchIndexFunc) (const gchar *dirname,
+                                     GPtrArray   *names,
+                                     gpointer     user_data);
+
+void            _gtk_search_crawl              (const gchar        *root,
+                                                GtkSearchIndexFunc  func,
+                                                gpointer            user_data,
+                                                volatile gboolean  *cancelled);
+
+GtkSearchIndex *_gtk_search_index_get_default  (void);
+gboolean        _gtk_search_index_is_ready     (GtkSearchIndex     *index);
+gboolean        _gtk_search_index_covers       (GtkSearchIndex     *index,
+                                                const gchar        *path);
+const gchar *   _gtk_search_index_get_filename (GtkSearchIndex     *index);
+gboolean        _gtk_search_index_query        (const gchar        *filename,
+                                                const gchar        *path,
+                                                GtkSearchIndexFunc  func,
+                                                gpointer            user_data,
+                                                volatile gboolean  *cancelled);
+
+G_END_DECLS
+
+#endif /* __GTK_SEARCH_INDEX_H__ */
@@ -110,6 +110,11 @@ struct _NodeData {
    * need recomputing.
    */
   guint valid : 8;		/* Actually a boolean */
+
+  /* TRUE once every line below this node has line data for the view,
+   * so that _gtk_text_btree_estimate() can skip the node.
+   */
+  guint estimated : 1;
 };
 
 
@@ -282,6 +287,7 @@ static NodeData         *node_data_find         (NodeData *nd,
 
 static GtkTextBTreeNode     *gtk_text_btree_node_new                  (void);
 static void                  gtk_text_btree_node_invalidate_downward  (GtkTextBTreeNode *node);
+static void                  gtk_text_btree_node_clear_estimated      (GtkTextBTreeNode *node);
 static void                  gtk_text_btree_node_invalidate_upward    (GtkTextBTreeNode *node,
                                                                        gpointer          view_id);
 static NodeData *            gtk_text_btree_node_check_valid          (GtkTextBTreeNode *node,
@@ -1221,6 +1227,10 @@ _gtk_text_btree_insert (GtkTextIter *iter,
       cleanup_line (line);
     }
 
+  /* The new lines have no line data yet */
+  if (line_count_delta > 0)
+    gtk_text_btree_node_clear_estimated (start_line->parent);
+
   post_insert_fixup (tree, line, line_count_delta, char_count_delta);
 
   /* Invalidate our region, and reset the iterator the user
@@ -1755,11 +1765,16 @@ queue_tag_redisplay (GtkTextBTree      *tree,
   /* We don't need to do anything if the tag doesn't affect display */
 }
 
-void
-_gtk_text_btree_tag (const GtkTextIter *start_orig,
-                     const GtkTextIter *end_orig,
-                     GtkTextTag        *tag,
-                     gboolean           add)
+/* Adds or removes toggles so that @tag covers, or does not cover,
+ * the ordered, non-empty range from @start to @end; the caller
+ * takes care of redisplay.
+ */
+static void
+gtk_text_btree_tag_range (GtkTextBTree      *tree,
+                          GtkTextTagInfo    *info,
+                          const GtkTextIter *start_iter,
+                          const GtkTextIter *end_iter,
+                          gboolean           add)
 {
   GtkTextLineSegment *seg, *prev;
   GtkTextLine *cleanupline;
@@ -1768,38 +1783,12 @@ _gtk_text_btree_tag (const GtkTextIter *start_orig,
   GtkTextLine *end_line;
   GtkTextIter iter;
   GtkTextIter start, end;
-  GtkTextBTree *tree;
   IterStack *stack;
-  GtkTextTagInfo *info;
-
-  g_return_if_fail (start_orig != NULL);
-  g_return_if_fail (end_orig != NULL);
-  g_return_if_fail (GTK_IS_TEXT_TAG (tag));
-  g_return_if_fail (_gtk_text_iter_get_btree (start_orig) ==
-                    _gtk_text_iter_get_btree (end_orig));
-  g_return_if_fail (tag->table == _gtk_text_iter_get_btree (start_orig)->table);
-  
-#if 0
-  printf ("%s tag %s from %d to %d\n",
-          add ? "Adding" : "Removing",
-          tag->name,
-          gtk_text_buffer_get_offset (start_orig),
-          gtk_text_buffer_get_offset (end_orig));
-#endif
-
-  if (gtk_text_iter_equal (start_orig, end_orig))
-    return;
-
-  start = *start_orig;
-  end = *end_orig;
-
-  gtk_text_iter_order (&start, &end);
-
-  tree = _gtk_text_iter_get_btree (&start);
-
-  queue_tag_redisplay (tree, tag, &start, &end);
+  GtkTextTag *tag;
 
-  info = gtk_text_btree_get_tag_info (tree, tag);
+  start = *start_iter;
+  end = *end_iter;
+  tag = info->tag;
 
   start_line = _gtk_text_iter_get_text_line (&start);
   end_line = _gtk_text_iter_get_text_line (&end);
@@ -2005,6 +1994,103 @@ _gtk_text_btree_tag (const GtkTextIter *start_orig,
     }
 
   segments_changed (tree);
+}
+
+void
+_gtk_text_btree_tag (const GtkTextIter *start_orig,
+                     const GtkTextIter *end_orig,
+                     GtkTextTag        *tag,
+                     gboolean           add)
+{
+  GtkTextIter start, end;
+  GtkTextBTree *tree;
+  GtkTextTagInfo *info;
+
+  g_return_if_fail (start_orig != NULL);
+  g_return_if_fail (end_orig != NULL);
+  g_return_if_fail (GTK_IS_TEXT_TAG (tag));
+  g_return_if_fail (_gtk_text_iter_get_btree (start_orig) ==
+                    _gtk_text_iter_get_btree (end_orig));
+  g_return_if_fail (tag->table == _gtk_text_iter_get_btree (start_orig)->table);
+  
+#if 0
+  printf ("%s tag %s from %d to %d\n",
+          add ? "Adding" : "Removing",
+          tag->name,
+          gtk_text_buffer_get_offset (start_orig),
+          gtk_text_buffer_get_offset (end_orig));
+#endif
+
+  if (gtk_text_iter_equal (start_orig, end_orig))
+    return;
+
+  start = *start_orig;
+  end = *end_orig;
+
+  gtk_text_iter_order (&start, &end);
+
+  tree = _gtk_text_iter_get_btree (&start);
+
+  queue_tag_redisplay (tree, tag, &start, &end);
+
+  info = gtk_text_btree_get_tag_info (tree, tag);
+
+  gtk_text_btree_tag_range (tree, info, &start, &end, add);
+
+  queue_tag_redisplay (tree, tag, &start, &end);
+
+  if (gtk_debug_flags & GTK_DEBUG_TEXT)
+    _gtk_text_btree_check (tree);
+}
+
+/* Like _gtk_text_btree_tag(), for @n_ranges ranges given as pairs of
+ * character offsets in @offsets. The ranges must be sorted and must
+ * not overlap; the whole span they cover is redisplayed once.
+ */
+void
+_gtk_text_btree_tag_ranges (GtkTextBTree *tree,
+                            GtkTextTag   *tag,
+                            const gint   *offsets,
+                            gint          n_ranges,
+                            gboolean      add)
+{
+  GtkTextIter start, end;
+  GtkTextTagInfo *info;
+  gint i;
+
+  g_return_if_fail (GTK_IS_TEXT_TAG (tag));
+  g_return_if_fail (tag->table == tree->table);
+
+  if (n_ranges == 0)
+    return;
+
+  _gtk_text_btree_get_iter_at_char (tree, &start, offsets[0]);
+  _gtk_text_btree_get_iter_at_char (tree, &end, offsets[2 * n_ranges - 1]);
+
+  queue_tag_redisplay (tree, tag, &start, &end);
+
+  info = gtk_text_btree_get_tag_info (tree, tag);
+
+  for (i = 0; i < n_ranges; i++)
+    {
+      g_assert (offsets[2 * i] <= offsets[2 * i + 1]);
+      g_assert (i == 0 || offsets[2 * i - 1] < offsets[2 * i]);
+
+      if (offsets[2 * i] == offsets[2 * i + 1])
+        continue;
+
+      /* Toggles inserted by the previous range invalidate iterators,
+       * so look the bounds up afresh.
+       */
+      _gtk_text_btree_get_iter_at_char (tree, &start, offsets[2 * i]);
+      _gtk_text_btree_get_iter_at_char (tree, &end, offsets[2 * i + 1]);
+
+      if (!gtk_text_iter_equal (&start, &end))
+        gtk_text_btree_tag_range (tree, info, &start, &end, add);
+    }
+
+  _gtk_text_btree_get_iter_at_char (tree, &start, offsets[0]);
+  _gtk_text_btree_get_iter_at_char (tree, &end, offsets[2 * n_ranges - 1]);
 
   queue_tag_redisplay (tree, tag, &start, &end);
 
@@ -3649,6 +3735,8 @@ _gtk_text_line_remove_data (GtkTextLine *line,
       else
         line->views = iter->next;
 
+      gtk_text_btree_node_clear_estimated (line->parent);
+
       return iter;
     }
   else
@@ -4816,6 +4904,7 @@ node_data_new (gpointer view_id)
   nd->width = 0;
   nd->height = 0;
   nd->valid = FALSE;
+  nd->estimated = FALSE;
 
   return nd;
 }
@@ -4919,6 +5008,23 @@ gtk_text_btree_node_has_tag (GtkTextBTreeNode *node, GtkTextTag *tag)
   return FALSE;
 }
 
+/* Forget for all views that every line below node has line data,
+ * after lines without data may have appeared there.
+ */
+static void
+gtk_text_btree_node_clear_estimated (GtkTextBTreeNode *node)
+{
+  while (node != NULL)
+    {
+      NodeData *nd;
+
+      for (nd = node->node_data; nd != NULL; nd = nd->next)
+        nd->estimated = FALSE;
+
+      node = node->parent;
+    }
+}
+
 /* Add node and all children to the damage region. */
 static void
 gtk_text_btree_node_invalidate_downward (GtkTextBTreeNode *node)
@@ -5268,6 +5374,137 @@ _gtk_text_btree_validate (GtkTextBTree *tree,
     return FALSE;
 }
 
+typedef struct _EstimateState EstimateState;
+
+struct _EstimateState
+{
+  GtkTextLineEstimateFunc func;
+  gpointer data;
+  gint y;
+  gint delta;
+  gint start_y;
+  gint end_y;
+  gint end_delta;
+};
+
+static void
+gtk_text_btree_node_estimate (GtkTextBTreeNode *node,
+                              gpointer          view_id,
+                              EstimateState    *state)
+{
+  NodeData *nd = gtk_text_btree_node_ensure_data (node, view_id);
+
+  /* Valid lines have line data too */
+  if (nd->valid || nd->estimated)
+    {
+      nd->estimated = TRUE;
+      state->y += nd->height;
+      return;
+    }
+
+  if (node->level == 0)
+    {
+      GtkTextLine *line = node->children.line;
+      GtkTextLineData *ld;
+
+      while (line != NULL)
+        {
+          ld = _gtk_text_line_get_data (line, view_id);
+
+          if (ld == NULL)
+            {
+              if (state->start_y < 0)
+                state->start_y = state->y;
+
+              ld = _gtk_text_line_data_new (view_id, line);
+              (* state->func) (line, ld, state->data);
+              _gtk_text_line_add_data (line, ld);
+
+              state->delta += ld->height;
+              state->end_y = state->y + ld->height;
+              state->end_delta = state->delta;
+            }
+
+          state->y += ld->height;
+
+          line = line->next;
+        }
+    }
+  else
+    {
+      GtkTextBTreeNode *child = node->children.node;
+
+      while (child != NULL)
+        {
+          gtk_text_btree_node_estimate (child, view_id, state);
+          child = child->next;
+        }
+    }
+
+  gtk_text_btree_node_check_valid (node, view_id);
+  nd->estimated = TRUE;
+}
+
+/**
+ * _gtk_text_btree_estimate:
+ * @tree: a #GtkTextBTree
+ * @view_id: view id
+ * @func: function computing the estimated size of a line
+ * @data: data to pass to @func
+ * @y: location to store starting y coordinate of the changed region
+ * @old_height: location to store old height of the changed region
+ * @new_height: location to store new height of the changed region
+ *
+ * Gives every line that has never been laid out for a view an
+ * estimated size, computed by @func, so that the total size of the
+ * view is roughly right before it is validated. The estimated lines
+ * stay invalid.
+ *
+ * Return value: %TRUE if any line has been estimated
+ **/
+gboolean
+_gtk_text_btree_estimate (GtkTextBTree           *tree,
+                          gpointer                view_id,
+                          GtkTextLineEstimateFunc func,
+                          gpointer                data,
+                          gint                   *y,
+                          gint                   *old_height,
+                          gint                   *new_height)
+{
+  EstimateState state;
+
+  g_return_val_if_fail (tree != NULL, FALSE);
+  g_return_val_if_fail (func != NULL, FALSE);
+
+  if (_gtk_text_btree_is_valid (tree, view_id))
+    return FALSE;
+
+  state.func = func;
+  state.data = data;
+  state.y = 0;
+  state.delta = 0;
+  state.start_y = -1;
+  state.end_y = 0;
+  state.end_delta = 0;
+
+  gtk_text_btree_node_estimate (tree->root_node, view_id, &state);
+
+  if (state.start_y < 0)
+    return FALSE;
+
+  if (y)
+    *y = state.start_y;
+  if (old_height)
+    *old_height = state.end_y - state.end_delta - state.start_y;
+  if (new_height)
+    *new_height = state.end_y - state.start_y;
+
+  if (gtk_debug_flags & GTK_DEBUG_TEXT)
+    _gtk_text_btree_check (tree);
+
+  return TRUE;
+}
+
 static void
 gtk_text_btree_node_compute_view_aggregates (GtkTextBTreeNode *node,
                                              gpointer          view_id,
@@ -6208,6 +6445,9 @@ recompute_node_counts (GtkTextBTree *tree, GtkTextBTreeNode *node)
       gtk_text_btree_node_check_valid (node, view->view_id);
       view = view->next;
     }
+
+  /* The children may have come from another node */
+  gtk_text_btree_node_clear_estimated (node);
   
   /*
    * Scan through the GtkTextBTreeNode's tag records again and delete any Summary
@@ -6630,6 +6870,30 @@ _gtk_toggle_segment_check_func (GtkTextLineSegment *segPtr,
  * Debug
  */
 
+static gboolean
+gtk_text_btree_node_lines_have_data (GtkTextBTreeNode *node,
+                                     gpointer          view_id)
+{
+  if (node->level == 0)
+    {
+      GtkTextLine *line;
+
+      for (line = node->children.line; line != NULL; line = line->next)
+        if (_gtk_text_line_get_data (line, view_id) == NULL)
+          return FALSE;
+    }
+  else
+    {
+      GtkTextBTreeNode *child;
+
+      for (child = node->children.node; child != NULL; child = child->next)
+        if (!gtk_text_btree_node_lines_have_data (child, view_id))
+          return FALSE;
+    }
+
+  return TRUE;
+}
+
 static void
 gtk_text_btree_node_view_check_consistency (GtkTextBTree     *tree,
                                             GtkTextBTreeNode *node,
@@ -6677,6 +6941,14 @@ gtk_text_btree_node_view_check_consistency (GtkTextBTree     *tree,
                nd->width, nd->height, nd->valid ? "TRUE" : "FALSE",
                width, height, valid ? "TRUE" : "FALSE");
     }
+
+  /* Valid nodes get marked estimated without their children, so only
+   * check what the estimate walk relies on, that all lines below have
+   * line data.
+   */
+  if (nd->estimated && !gtk_text_btree_node_lines_have_data (node, nd->view_id))
+    g_error ("Node for view %p is marked estimated, "
+             "but has a line without line data", nd->view_id);
 }
 
 static void
@@ -110,12 +110,29 @@ void         _gtk_text_btree_validate_line     (GtkTextBTree      *tree,
                                                 GtkTextLine       *line,
                                                 gpointer           view_id);
 
+typedef void (* GtkTextLineEstimateFunc) (GtkTextLine     *line,
+                                          GtkTextLineData *line_data,
+                                          gpointer         data);
+
+gboolean     _gtk_text_btree_estimate          (GtkTextBTree      *tree,
+                                                gpointer           view_id,
+                                                GtkTextLineEstimateFunc func,
+                                                gpointer           data,
+                                                gint              *y,
+                                                gint              *old_height,
+                                                gint              *new_height);
+
 /* Tag */
 
-void _gtk_text_btree_tag (const GtkTextIter *start,
-                          const GtkTextIter *end,
-                          GtkTextTag        *tag,
-                          gboolean           apply);
+void _gtk_text_btree_tag        (const GtkTextIter *start,
+                                 const GtkTextIter *end,
+                                 GtkTextTag        *tag,
+                                 gboolean           apply);
+void _gtk_text_btree_tag_ranges (GtkTextBTree      *tree,
+                                 GtkTextTag        *tag,
+                                 const gint        *offsets,
+                                 gint               n_ranges,
+                                 gboolean           apply);
 
 /* "Getters" */
 
@@ -592,6 +592,7 @@ gtk_text_buffer_init (GtkTextBuffer *buffer)
 
   /* allow copying of arbiatray stuff in the internal rich text format */
   gtk_text_buffer_register_serialize_tagset (buffer, NULL);
+  gtk_text_buffer_register_serialize_binary_tagset (buffer, NULL);
 }
 
 static void
@@ -2674,6 +2675,123 @@ gtk_text_buffer_remove_tag_by_name (GtkTextBuffer     *buffer,
   gtk_text_buffer_emit_tag (buffer, tag, FALSE, start, end);
 }
 
+/**
+ * gtk_text_buffer_apply_tag_spans:
+ * @buffer: a #GtkTextBuffer
+ * @spans: an array of #GtkTextTagSpan<!-- -->s, sorted by start offset
+ * @n_spans: the number of elements in @spans
+ *
+ * Applies each span's tag to the range between its character offsets,
+ * with the same result as calling gtk_text_buffer_apply_tag() for
+ * every span. This is meant for callers like syntax highlighters that
+ * tag many small ranges at once: overlapping and adjacent spans of the
+ * same tag are merged, and all ranges of a tag are added to the buffer
+ * and redisplayed in a single pass.
+ *
+ * If handlers are connected to the "apply-tag" signal, it is emitted
+ * once for each merged range.
+ *
+ * Since: 2.14
+ **/
+void
+gtk_text_buffer_apply_tag_spans (GtkTextBuffer        *buffer,
+                                 const GtkTextTagSpan *spans,
+                                 gint                  n_spans)
+{
+  GHashTable *ranges;
+  GSList *tags, *l;
+  GArray *array;
+  gboolean direct;
+  gint char_count;
+  gint i;
+
+  g_return_if_fail (GTK_IS_TEXT_BUFFER (buffer));
+  g_return_if_fail (spans != NULL || n_spans == 0);
+
+  char_count = gtk_text_buffer_get_char_count (buffer);
+
+  for (i = 0; i < n_spans; i++)
+    {
+      g_return_if_fail (GTK_IS_TEXT_TAG (spans[i].tag));
+      g_return_if_fail (spans[i].tag->table == buffer->tag_table);
+      g_return_if_fail (spans[i].start >= 0);
+      g_return_if_fail (spans[i].start <= spans[i].end);
+      g_return_if_fail (spans[i].end <= char_count);
+      g_return_if_fail (i == 0 || spans[i - 1].start <= spans[i].start);
+    }
+
+  /* Collect the ranges of each tag, merging those that touch */
+  ranges = g_hash_table_new (NULL, NULL);
+  tags = NULL;
+
+  for (i = 0; i < n_spans; i++)
+    {
+      if (spans[i].start == spans[i].end)
+        continue;
+
+      array = g_hash_table_lookup (ranges, spans[i].tag);
+      if (array == NULL)
+        {
+          array = g_array_new (FALSE, FALSE, sizeof (gint));
+          g_hash_table_insert (ranges, spans[i].tag, array);
+          tags = g_slist_prepend (tags, spans[i].tag);
+        }
+      else
+        {
+          gint *last_end = &g_array_index (array, gint, array->len - 1);
+
+          if (spans[i].start <= *last_end)
+            {
+              *last_end = MAX (*last_end, spans[i].end);
+              continue;
+            }
+        }
+
+      g_array_append_val (array, spans[i].start);
+      g_array_append_val (array, spans[i].end);
+    }
+
+  tags = g_slist_reverse (tags);
+
+  /* Without anyone watching, skip the signal and tag the B-tree
+   * directly, the same as the default handler would.
+   */
+  direct = (GTK_TEXT_BUFFER_GET_CLASS (buffer)->apply_tag == gtk_text_buffer_real_apply_tag &&
+            !g_signal_has_handler_pending (buffer, signals[APPLY_TAG], 0, FALSE));
+
+  for (l = tags; l; l = l->next)
+    {
+      GtkTextTag *tag = l->data;
+      guint j;
+
+      array = g_hash_table_lookup (ranges, tag);
+
+      if (direct)
+        _gtk_text_btree_tag_ranges (get_btree (buffer), tag,
+                                    (const gint *) array->data,
+                                    array->len / 2, TRUE);
+      else
+        {
+          for (j = 0; j < array->len; j += 2)
+            {
+              GtkTextIter start, end;
+
+              gtk_text_buffer_get_iter_at_offset (buffer, &start,
+                                                  g_array_index (array, gint, j));
+              gtk_text_buffer_get_iter_at_offset (buffer, &end,
+                                                  g_array_index (array, gint, j + 1));
+
+              gtk_text_buffer_emit_tag (buffer, tag, TRUE, &start, &end);
+            }
+        }
+
+      g_array_free (array, TRUE);
+    }
+
+  g_slist_free (tags);
+  g_hash_table_destroy (ranges);
+}
+
 static gint
 pointer_cmp (gconstpointer a,
              gconstpointer b)
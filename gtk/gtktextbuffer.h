@@ -58,6 +58,15 @@ typedef enum
   GTK_TEXT_BUFFER_TARGET_INFO_TEXT            = - 3
 } GtkTextBufferTargetInfo;
 
+typedef struct _GtkTextTagSpan GtkTextTagSpan;
+
+struct _GtkTextTagSpan
+{
+  GtkTextTag *tag;
+  gint        start;
+  gint        end;
+};
+
 typedef struct _GtkTextBTree GtkTextBTree;
 
 typedef struct _GtkTextLogAttrCache GtkTextLogAttrCache;
@@ -301,6 +310,9 @@ void gtk_text_buffer_remove_tag_by_name    (GtkTextBuffer     *buffer,
                                             const gchar       *name,
                                             const GtkTextIter *start,
                                             const GtkTextIter *end);
+void gtk_text_buffer_apply_tag_spans       (GtkTextBuffer        *buffer,
+                                            const GtkTextTagSpan *spans,
+                                            gint                  n_spans);
 void gtk_text_buffer_remove_all_tags       (GtkTextBuffer     *buffer,
                                             const GtkTextIter *start,
                                             const GtkTextIter *end);
@@ -52,6 +52,8 @@ GdkAtom   gtk_text_buffer_register_serialize_format   (GtkTextBuffer
                                                        GDestroyNotify                user_data_destroy);
 GdkAtom   gtk_text_buffer_register_serialize_tagset   (GtkTextBuffer                *buffer,
                                                        const gchar                  *tagset_name);
+GdkAtom   gtk_text_buffer_register_serialize_binary_tagset   (GtkTextBuffer         *buffer,
+                                                              const gchar           *tagset_name);
 
 GdkAtom   gtk_text_buffer_register_deserialize_format (GtkTextBuffer                *buffer,
                                                        const gchar                  *mime_type,
@@ -60,6 +62,8 @@ GdkAtom   gtk_text_buffer_register_deserialize_format (GtkTextBuffer
                                                        GDestroyNotify                user_data_destroy);
 GdkAtom   gtk_text_buffer_register_deserialize_tagset (GtkTextBuffer                *buffer,
                                                        const gchar                  *tagset_name);
+GdkAtom   gtk_text_buffer_register_deserialize_binary_tagset (GtkTextBuffer         *buffer,
+                                                              const gchar           *tagset_name);
 
 void    gtk_text_buffer_unregister_serialize_format   (GtkTextBuffer                *buffer,
                                                        GdkAtom                       format);
@@ -49,7 +49,7 @@ typedef struct
 } SerializationContext;
 
 static gchar *
-serialize_value (GValue *value)
+value_to_string (GValue *value)
 {
   if (g_value_type_transformable (value->g_type, G_TYPE_STRING))
     {
@@ -59,7 +59,7 @@ serialize_value (GValue *value)
       g_value_init (&text_value, G_TYPE_STRING);
       g_value_transform (value, &text_value);
 
-      tmp = g_markup_escape_text (g_value_get_string (&text_value), -1);
+      tmp = g_value_dup_string (&text_value);
       g_value_unset (&text_value);
 
       return tmp;
@@ -82,6 +82,22 @@ serialize_value (GValue *value)
   return NULL;
 }
 
+static gchar *
+serialize_value (GValue *value)
+{
+  gchar *tmp, *escaped;
+
+  tmp = value_to_string (value);
+
+  if (tmp == NULL)
+    return NULL;
+
+  escaped = g_markup_escape_text (tmp, -1);
+  g_free (tmp);
+
+  return escaped;
+}
+
 static gboolean
 deserialize_value (const gchar *str,
                    GValue      *value)
@@ -591,12 +607,12 @@ serialize_text (GtkTextBuffer        *buffer,
 }
 
 static void
-serialize_pixbufs (SerializationContext *context,
-		   GString              *text)
+serialize_pixbufs (GList   *pixbufs,
+		   GString *text)
 {
   GList *list;
 
-  for (list = context->pixbufs; list != NULL; list = list->next)
+  for (list = pixbufs; list != NULL; list = list->next)
     {
       GdkPixbuf *pixbuf = list->data;
       GdkPixdata pixdata;
@@ -646,7 +662,7 @@ _gtk_text_buffer_serialize_rich_text (GtkTextBuffer     *register_buffer,
   g_string_append_len (text, context.text_str->str, context.text_str->len);
 
   context.pixbufs = g_list_reverse (context.pixbufs);
-  serialize_pixbufs (&context, text);
+  serialize_pixbufs (context.pixbufs, text);
 
   g_hash_table_destroy (context.tags);
   g_list_free (context.pixbufs);
@@ -1230,27 +1246,43 @@ parse_attr_element (GMarkupParseContext  *context,
 }
 
 
+/* Finds a name that is neither used in @table nor in @reserved,
+ * which holds the names of tags still to be added to it.
+ */
 static gchar *
-get_tag_name (ParseInfo   *info,
-	      const gchar *tag_name)
+get_unique_tag_name (GtkTextTagTable *table,
+		     GHashTable      *reserved,
+		     const gchar     *tag_name)
 {
   gchar *name;
   gint i;
 
   name = g_strdup (tag_name);
 
-  if (!info->create_tags)
-    return name;
-
   i = 0;
 
-  while (gtk_text_tag_table_lookup (info->buffer->tag_table, name) != NULL)
+  while (gtk_text_tag_table_lookup (table, name) != NULL ||
+	 (reserved && g_hash_table_lookup (reserved, name) != NULL))
     {
       g_free (name);
       name = g_strdup_printf ("%s-%d", tag_name, ++i);
     }
 
-  if (i != 0)
+  return name;
+}
+
+static gchar *
+get_tag_name (ParseInfo   *info,
+	      const gchar *tag_name)
+{
+  gchar *name;
+
+  if (!info->create_tags)
+    return g_strdup (tag_name);
+
+  name = get_unique_tag_name (info->buffer->tag_table, NULL, tag_name);
+
+  if (strcmp (name, tag_name) != 0)
     {
       g_hash_table_insert (info->substitutions, g_strdup (tag_name), g_strdup (name));
     }
@@ -1755,6 +1787,7 @@ read_headers (const gchar *start,
 	goto error;
 
       if (strncmp (start + i, "GTKTEXTBUFFERCONTENTS-0001", 26) == 0 ||
+	  strncmp (start + i, "GTKTEXTBUFFERCONTENTS-0002", 26) == 0 ||
 	  strncmp (start + i, "GTKTEXTBUFFERPIXBDATA-0001", 26) == 0)
 	{
 	  section_len = read_int ((const guchar *) start + i + 26);
@@ -1878,3 +1911,776 @@ _gtk_text_buffer_deserialize_rich_text (GtkTextBuffer *register_buffer,
 
   return retval;
 }
+
+/* The binary format
+ *
+ * The GTKTEXTBUFFERCONTENTS-0002 section holds big-endian 32-bit
+ * integers and strings prefixed with their length in bytes:
+ *
+ *  - the number of tags, and for each tag, in order of increasing
+ *    priority, its name (with a length of -1 for anonymous tags), the
+ *    number of attributes and the name, type and value of each of them
+ *  - the text, in UTF-8, with U+FFFC where pixbufs are
+ *  - the number of pixbufs and their byte offsets in the text
+ *  - the number of tag runs, and for each run, sorted by start, the
+ *    index of its tag and its start and end character offsets
+ *
+ * The pixbufs follow in GTKTEXTBUFFERPIXBDATA-0001 sections, as in
+ * the XML format.
+ */
+
+#define PIXBUF_CHAR_LEN 3
+
+static void
+put_int (guchar *p,
+	 gint    value)
+{
+  p[0] = ((guint32) value >> 24) & 0xff;
+  p[1] = ((guint32) value >> 16) & 0xff;
+  p[2] = ((guint32) value >> 8) & 0xff;
+  p[3] = (guint32) value & 0xff;
+}
+
+static void
+append_int (GString *str,
+	    gint     value)
+{
+  guchar buf[4];
+
+  put_int (buf, value);
+  g_string_append_len (str, (gchar *) buf, 4);
+}
+
+static void
+append_string (GString     *str,
+	       const gchar *value,
+	       gint         len)
+{
+  if (value == NULL)
+    {
+      append_int (str, -1);
+      return;
+    }
+
+  if (len < 0)
+    len = strlen (value);
+
+  append_int (str, len);
+  g_string_append_len (str, value, len);
+}
+
+static gint
+append_tag_attributes (GString    *str,
+		       GtkTextTag *tag)
+{
+  GParamSpec **pspecs;
+  guint n_pspecs;
+  gint n_attrs;
+  guint i;
+
+  pspecs = g_object_class_list_properties (G_OBJECT_GET_CLASS (tag), &n_pspecs);
+  n_attrs = 0;
+
+  for (i = 0; i < n_pspecs; i++)
+    {
+      GValue value = { 0 };
+      gchar *tmp;
+
+      if (!(pspecs[i]->flags & G_PARAM_READABLE) ||
+	  !(pspecs[i]->flags & G_PARAM_WRITABLE))
+	continue;
+
+      if (!is_param_set (G_OBJECT (tag), pspecs[i], &value))
+	continue;
+
+      tmp = value_to_string (&value);
+
+      if (tmp)
+	{
+	  append_string (str, pspecs[i]->name, -1);
+	  append_string (str, g_type_name (pspecs[i]->value_type), -1);
+	  append_string (str, tmp, -1);
+	  n_attrs++;
+
+	  g_free (tmp);
+	}
+
+      g_value_unset (&value);
+    }
+
+  g_free (pspecs);
+
+  return n_attrs;
+}
+
+static gint
+sort_tag_priority (gconstpointer a,
+		   gconstpointer b)
+{
+  const GtkTextTag *tag_a = a;
+  const GtkTextTag *tag_b = b;
+
+  return tag_a->priority - tag_b->priority;
+}
+
+static gint
+sort_tag_span (gconstpointer a,
+	       gconstpointer b)
+{
+  const GtkTextTagSpan *span_a = a;
+  const GtkTextTagSpan *span_b = b;
+
+  if (span_a->start != span_b->start)
+    return span_a->start - span_b->start;
+
+  return span_a->tag->priority - span_b->tag->priority;
+}
+
+static void
+close_tag_run (GHashTable *open_tags,
+	       GArray     *runs,
+	       GtkTextTag *tag,
+	       gint        offset)
+{
+  gpointer start;
+  GtkTextTagSpan run;
+
+  if (!g_hash_table_lookup_extended (open_tags, tag, NULL, &start))
+    return;
+
+  g_hash_table_remove (open_tags, tag);
+
+  run.tag = tag;
+  run.start = GPOINTER_TO_INT (start);
+  run.end = offset;
+
+  if (run.start < run.end)
+    g_array_append_val (runs, run);
+}
+
+typedef struct
+{
+  GArray *runs;
+  gint    offset;
+} CloseRunsData;
+
+static void
+close_open_run (gpointer key,
+		gpointer value,
+		gpointer user_data)
+{
+  CloseRunsData *data = user_data;
+  GtkTextTagSpan run;
+
+  run.tag = key;
+  run.start = GPOINTER_TO_INT (value);
+  run.end = data->offset;
+
+  if (run.start < run.end)
+    g_array_append_val (data->runs, run);
+}
+
+/* Collects the runs of all tags between @start and @end, with offsets
+ * relative to @start, sorted by start.
+ */
+static GArray *
+collect_tag_runs (const GtkTextIter *start,
+		  const GtkTextIter *end)
+{
+  GHashTable *open_tags;
+  GArray *runs;
+  GSList *tags, *l;
+  GtkTextIter iter;
+  CloseRunsData data;
+  gint start_offset;
+  gint offset;
+
+  open_tags = g_hash_table_new (NULL, NULL);
+  runs = g_array_new (FALSE, FALSE, sizeof (GtkTextTagSpan));
+
+  start_offset = gtk_text_iter_get_offset (start);
+  iter = *start;
+
+  tags = gtk_text_iter_get_tags (&iter);
+  for (l = tags; l; l = l->next)
+    g_hash_table_insert (open_tags, l->data, GINT_TO_POINTER (0));
+  g_slist_free (tags);
+
+  while (gtk_text_iter_forward_to_tag_toggle (&iter, NULL) &&
+	 gtk_text_iter_compare (&iter, end) < 0)
+    {
+      offset = gtk_text_iter_get_offset (&iter) - start_offset;
+
+      tags = gtk_text_iter_get_toggled_tags (&iter, FALSE);
+      for (l = tags; l; l = l->next)
+	close_tag_run (open_tags, runs, l->data, offset);
+      g_slist_free (tags);
+
+      tags = gtk_text_iter_get_toggled_tags (&iter, TRUE);
+      for (l = tags; l; l = l->next)
+	g_hash_table_insert (open_tags, l->data, GINT_TO_POINTER (offset));
+      g_slist_free (tags);
+    }
+
+  data.runs = runs;
+  data.offset = gtk_text_iter_get_offset (end) - start_offset;
+  g_hash_table_foreach (open_tags, close_open_run, &data);
+  g_hash_table_destroy (open_tags);
+
+  g_array_sort (runs, sort_tag_span);
+
+  return runs;
+}
+
+guint8 *
+_gtk_text_buffer_serialize_binary_rich_text (GtkTextBuffer     *register_buffer,
+					     GtkTextBuffer     *content_buffer,
+					     const GtkTextIter *start,
+					     const GtkTextIter *end,
+					     gsize             *length,
+					     gpointer           user_data)
+{
+  GString *contents, *text;
+  GHashTable *tag_ids;
+  GList *tags, *pixbufs, *l;
+  GArray *runs, *pixbuf_offsets;
+  GtkTextIter iter;
+  gchar *slice;
+  const gchar *p, *last;
+  gint n_pixbufs;
+  gint id, n_attrs, pos;
+  guint i;
+
+  /* The runs give us the set of tags in use */
+  runs = collect_tag_runs (start, end);
+
+  tag_ids = g_hash_table_new (NULL, NULL);
+  tags = NULL;
+
+  for (i = 0; i < runs->len; i++)
+    {
+      GtkTextTag *tag = g_array_index (runs, GtkTextTagSpan, i).tag;
+
+      if (!g_hash_table_lookup_extended (tag_ids, tag, NULL, NULL))
+	{
+	  g_hash_table_insert (tag_ids, tag, NULL);
+	  tags = g_list_prepend (tags, tag);
+	}
+    }
+
+  tags = g_list_sort (tags, sort_tag_priority);
+
+  contents = g_string_new (NULL);
+
+  append_int (contents, g_list_length (tags));
+
+  for (l = tags, id = 0; l; l = l->next, id++)
+    {
+      GtkTextTag *tag = l->data;
+
+      g_hash_table_insert (tag_ids, tag, GINT_TO_POINTER (id));
+
+      append_string (contents, tag->name, -1);
+
+      pos = contents->len;
+      append_int (contents, 0);
+      n_attrs = append_tag_attributes (contents, tag);
+      put_int ((guchar *) contents->str + pos, n_attrs);
+    }
+
+  /* The text, and where the pixbufs are in it */
+  slice = gtk_text_iter_get_slice (start, end);
+  append_string (contents, slice, -1);
+
+  pixbufs = NULL;
+  pixbuf_offsets = g_array_new (FALSE, FALSE, sizeof (gint));
+  iter = *start;
+  last = slice;
+
+  while ((p = strstr (last, "\357\277\274")) != NULL)
+    {
+      GdkPixbuf *pixbuf;
+      gint offset;
+
+      gtk_text_iter_forward_chars (&iter, g_utf8_strlen (last, p - last));
+      pixbuf = gtk_text_iter_get_pixbuf (&iter);
+
+      if (pixbuf)
+	{
+	  offset = p - slice;
+	  g_array_append_val (pixbuf_offsets, offset);
+	  pixbufs = g_list_prepend (pixbufs, pixbuf);
+	}
+
+      gtk_text_iter_forward_char (&iter);
+      last = p + PIXBUF_CHAR_LEN;
+    }
+
+  n_pixbufs = pixbuf_offsets->len;
+  append_int (contents, n_pixbufs);
+  for (i = 0; i < pixbuf_offsets->len; i++)
+    append_int (contents, g_array_index (pixbuf_offsets, gint, i));
+
+  /* The tag runs */
+  append_int (contents, runs->len);
+  for (i = 0; i < runs->len; i++)
+    {
+      GtkTextTagSpan *run = &g_array_index (runs, GtkTextTagSpan, i);
+
+      append_int (contents,
+		  GPOINTER_TO_INT (g_hash_table_lookup (tag_ids, run->tag)));
+      append_int (contents, run->start);
+      append_int (contents, run->end);
+    }
+
+  text = g_string_sized_new (contents->len + 30);
+  serialize_section_header (text, "GTKTEXTBUFFERCONTENTS-0002", contents->len);
+  g_string_append_len (text, contents->str, contents->len);
+
+  pixbufs = g_list_reverse (pixbufs);
+  serialize_pixbufs (pixbufs, text);
+
+  g_list_free (pixbufs);
+  g_array_free (pixbuf_offsets, TRUE);
+  g_free (slice);
+  g_string_free (contents, TRUE);
+  g_list_free (tags);
+  g_hash_table_destroy (tag_ids);
+  g_array_free (runs, TRUE);
+
+  *length = text->len;
+
+  return (guint8 *) g_string_free (text, FALSE);
+}
+
+typedef struct
+{
+  const guchar *p;
+  const guchar *end;
+} BinaryReader;
+
+static gboolean
+binary_read_int (BinaryReader *reader,
+		 gint         *value)
+{
+  if (reader->end - reader->p < 4)
+    return FALSE;
+
+  *value = read_int (reader->p);
+  reader->p += 4;
+
+  return TRUE;
+}
+
+/* Strings point into the serialized data, and are not nul-terminated */
+static gboolean
+binary_read_string (BinaryReader  *reader,
+		    const gchar  **value,
+		    gint          *len)
+{
+  if (!binary_read_int (reader, len))
+    return FALSE;
+
+  if (*len == -1)
+    {
+      *value = NULL;
+      return TRUE;
+    }
+
+  if (*len < 0 || reader->end - reader->p < *len)
+    return FALSE;
+
+  *value = (const gchar *) reader->p;
+  reader->p += *len;
+
+  return TRUE;
+}
+
+static gboolean
+binary_read_count (BinaryReader *reader,
+		   gint          item_size,
+		   gint         *count)
+{
+  if (!binary_read_int (reader, count))
+    return FALSE;
+
+  return *count >= 0 && *count <= (reader->end - reader->p) / item_size;
+}
+
+static gboolean
+set_tag_attribute (GtkTextTag   *tag,
+		   const gchar  *name,
+		   const gchar  *type,
+		   const gchar  *value,
+		   GError      **error)
+{
+  GType gtype;
+  GValue gvalue = { 0 };
+  GParamSpec *pspec;
+
+  gtype = g_type_from_name (type);
+
+  if (gtype == G_TYPE_INVALID)
+    {
+      g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_PARSE,
+		   _("\"%s\" is not a valid attribute type"), type);
+      return FALSE;
+    }
+
+  if (!(pspec = g_object_class_find_property (G_OBJECT_GET_CLASS (tag), name)))
+    {
+      g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_PARSE,
+		   _("\"%s\" is not a valid attribute name"), name);
+      return FALSE;
+    }
+
+  g_value_init (&gvalue, gtype);
+
+  if (!deserialize_value (value, &gvalue))
+    {
+      g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_PARSE,
+		   _("\"%s\" could not be converted to a value of type \"%s\" for attribute \"%s\""),
+		   value, type, name);
+      g_value_unset (&gvalue);
+      return FALSE;
+    }
+
+  if (g_param_value_validate (pspec, &gvalue))
+    {
+      g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_PARSE,
+		   _("\"%s\" is not a valid value for attribute \"%s\""),
+		   value, name);
+      g_value_unset (&gvalue);
+      return FALSE;
+    }
+
+  g_object_set_property (G_OBJECT (tag), name, &gvalue);
+  g_value_unset (&gvalue);
+
+  return TRUE;
+}
+
+/* Reads a tag definition and returns the tag to use for it in
+ * @buffer. With @create_tags, that is a new tag which the caller
+ * owns and adds to the tag table once all of the data has been
+ * checked; its name is added to @new_names. Otherwise it is the
+ * existing tag with the same name.
+ */
+static GtkTextTag *
+read_binary_tag (BinaryReader   *reader,
+		 GtkTextBuffer  *buffer,
+		 gboolean        create_tags,
+		 GHashTable     *new_names,
+		 GError        **error)
+{
+  const gchar *str;
+  gchar *name;
+  gchar *attr[3];
+  GtkTextTag *tag;
+  gboolean ok;
+  gint len, n_attrs;
+  gint i, j;
+
+  if (!binary_read_string (reader, &str, &len) ||
+      !binary_read_count (reader, 12, &n_attrs))
+    goto malformed;
+
+  name = str ? g_strndup (str, len) : NULL;
+
+  if (create_tags)
+    {
+      if (name)
+	{
+	  gchar *tag_name = get_unique_tag_name (buffer->tag_table,
+						 new_names, name);
+
+	  tag = gtk_text_tag_new (tag_name);
+	  g_hash_table_insert (new_names, tag_name, tag_name);
+	}
+      else
+	tag = gtk_text_tag_new (NULL);
+
+      for (i = 0; i < n_attrs; i++)
+	{
+	  for (j = 0; j < 3; j++)
+	    {
+	      if (!binary_read_string (reader, &str, &len) || str == NULL)
+		break;
+
+	      attr[j] = g_strndup (str, len);
+	    }
+
+	  if (j < 3)
+	    {
+	      while (j--)
+		g_free (attr[j]);
+	      g_object_unref (tag);
+	      g_free (name);
+	      goto malformed;
+	    }
+
+	  ok = set_tag_attribute (tag, attr[0], attr[1], attr[2], error);
+
+	  for (j = 0; j < 3; j++)
+	    g_free (attr[j]);
+
+	  if (!ok)
+	    {
+	      g_object_unref (tag);
+	      g_free (name);
+	      return NULL;
+	    }
+	}
+    }
+  else
+    {
+      for (i = 0; i < n_attrs * 3; i++)
+	{
+	  if (!binary_read_string (reader, &str, &len))
+	    {
+	      g_free (name);
+	      goto malformed;
+	    }
+	}
+
+      if (!name)
+	{
+	  g_set_error_literal (error, G_MARKUP_ERROR, G_MARKUP_ERROR_PARSE,
+			       _("Anonymous tag found and tags can not be created."));
+	  return NULL;
+	}
+
+      tag = gtk_text_tag_table_lookup (buffer->tag_table, name);
+
+      if (!tag)
+	g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_PARSE,
+		     _("Tag \"%s\" does not exist in buffer and tags can not be created."),
+		     name);
+    }
+
+  g_free (name);
+
+  return tag;
+
+ malformed:
+  g_set_error_literal (error, G_MARKUP_ERROR, G_MARKUP_ERROR_PARSE,
+		       _("Serialized data is malformed"));
+
+  return NULL;
+}
+
+static gboolean
+deserialize_binary_text (GtkTextBuffer *buffer,
+			 GtkTextIter   *iter,
+			 const gchar   *data,
+			 gint           len,
+			 gboolean       create_tags,
+			 GError       **error,
+			 GList         *headers)
+{
+  BinaryReader reader;
+  GHashTable *new_names;
+  GtkTextTag **tags;
+  GdkPixbuf **pixbufs;
+  GtkTextTagSpan *runs;
+  const gchar *text, *p;
+  gint *pixbuf_offsets;
+  gint n_tags, n_pixbufs, n_runs;
+  gint text_len, n_chars;
+  gint base, tag_id;
+  gint i;
+  GError *tmp_error = NULL;
+  gboolean retval;
+
+  retval = FALSE;
+  new_names = NULL;
+  tags = NULL;
+  n_tags = 0;
+  pixbufs = NULL;
+  pixbuf_offsets = NULL;
+  runs = NULL;
+  n_pixbufs = 0;
+
+  reader.p = (const guchar *) data;
+  reader.end = reader.p + MAX (len, 0);
+
+  if (!binary_read_count (&reader, 8, &n_tags))
+    goto malformed;
+
+  /* Nothing is added to the buffer or its tag table before all
+   * of the data has been read and checked.
+   */
+  if (create_tags)
+    new_names = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  tags = g_new0 (GtkTextTag *, n_tags);
+
+  for (i = 0; i < n_tags; i++)
+    {
+      tags[i] = read_binary_tag (&reader, buffer, create_tags,
+				 new_names, error);
+
+      if (!tags[i])
+	goto out;
+    }
+
+  if (!binary_read_string (&reader, &text, &text_len) || text == NULL ||
+      !g_utf8_validate (text, text_len, NULL))
+    goto malformed;
+
+  n_chars = g_utf8_strlen (text, text_len);
+
+  if (!binary_read_count (&reader, 4, &n_pixbufs))
+    goto malformed;
+
+  pixbuf_offsets = g_new (gint, n_pixbufs);
+  pixbufs = g_new0 (GdkPixbuf *, n_pixbufs);
+
+  for (i = 0; i < n_pixbufs; i++)
+    {
+      if (!binary_read_int (&reader, &pixbuf_offsets[i]) ||
+	  pixbuf_offsets[i] < (i > 0 ? pixbuf_offsets[i - 1] + PIXBUF_CHAR_LEN : 0) ||
+	  pixbuf_offsets[i] > text_len - PIXBUF_CHAR_LEN ||
+	  strncmp (text + pixbuf_offsets[i], "\357\277\274", PIXBUF_CHAR_LEN) != 0)
+	goto malformed;
+    }
+
+  if (!binary_read_count (&reader, 12, &n_runs))
+    goto malformed;
+
+  runs = g_new (GtkTextTagSpan, n_runs);
+
+  for (i = 0; i < n_runs; i++)
+    {
+      if (!binary_read_int (&reader, &tag_id) ||
+	  !binary_read_int (&reader, &runs[i].start) ||
+	  !binary_read_int (&reader, &runs[i].end))
+	goto malformed;
+
+      if (tag_id < 0 || tag_id >= n_tags ||
+	  runs[i].start < (i > 0 ? runs[i - 1].start : 0) ||
+	  runs[i].start > runs[i].end || runs[i].end > n_chars)
+	goto malformed;
+
+      runs[i].tag = tags[tag_id];
+    }
+
+  for (i = 0; i < n_pixbufs; i++)
+    {
+      pixbufs[i] = get_pixbuf_from_headers (headers, i, &tmp_error);
+
+      if (!pixbufs[i])
+	{
+	  if (!tmp_error)
+	    goto malformed;
+
+	  g_propagate_error (error, tmp_error);
+	  goto out;
+	}
+    }
+
+  /* In order of increasing priority */
+  if (create_tags)
+    {
+      for (i = 0; i < n_tags; i++)
+	gtk_text_tag_table_add (buffer->tag_table, tags[i]);
+    }
+
+  /* Insert straight from the serialized data, splitting the text only
+   * where the pixbufs go.
+   */
+  base = gtk_text_iter_get_offset (iter);
+  p = text;
+
+  for (i = 0; i < n_pixbufs; i++)
+    {
+      if (text + pixbuf_offsets[i] > p)
+	gtk_text_buffer_insert (buffer, iter, p, text + pixbuf_offsets[i] - p);
+
+      gtk_text_buffer_insert_pixbuf (buffer, iter, pixbufs[i]);
+      p = text + pixbuf_offsets[i] + PIXBUF_CHAR_LEN;
+    }
+
+  if (text + text_len > p)
+    gtk_text_buffer_insert (buffer, iter, p, text + text_len - p);
+
+  for (i = 0; i < n_runs; i++)
+    {
+      runs[i].start += base;
+      runs[i].end += base;
+    }
+
+  gtk_text_buffer_apply_tag_spans (buffer, runs, n_runs);
+
+  retval = TRUE;
+  goto out;
+
+ malformed:
+  g_set_error_literal (error,
+                       G_MARKUP_ERROR,
+                       G_MARKUP_ERROR_PARSE,
+                       _("Serialized data is malformed"));
+
+ out:
+  for (i = 0; pixbufs && i < n_pixbufs; i++)
+    if (pixbufs[i])
+      g_object_unref (pixbufs[i]);
+
+  g_free (pixbufs);
+  g_free (pixbuf_offsets);
+  g_free (runs);
+
+  /* The table holds the created tags now, or they are dropped */
+  for (i = 0; create_tags && tags && i < n_tags; i++)
+    if (tags[i])
+      g_object_unref (tags[i]);
+
+  g_free (tags);
+
+  if (new_names)
+    g_hash_table_destroy (new_names);
+
+  return retval;
+}
+
+gboolean
+_gtk_text_buffer_deserialize_binary_rich_text (GtkTextBuffer *register_buffer,
+					       GtkTextBuffer *content_buffer,
+					       GtkTextIter   *iter,
+					       const guint8  *text,
+					       gsize          length,
+					       gboolean       create_tags,
+					       gpointer       user_data,
+					       GError       **error)
+{
+  GList *headers;
+  Header *header;
+  gboolean retval;
+
+  headers = read_headers ((gchar *) text, length, error);
+
+  if (!headers)
+    return FALSE;
+
+  header = headers->data;
+  if (!header_is (header, "GTKTEXTBUFFERCONTENTS-0002"))
+    {
+      g_set_error_literal (error,
+                           G_MARKUP_ERROR,
+                           G_MARKUP_ERROR_PARSE,
+                           _("Serialized data is malformed. First section isn't GTKTEXTBUFFERCONTENTS-0002"));
+
+      retval = FALSE;
+      goto out;
+    }
+
+  retval = deserialize_binary_text (content_buffer, iter,
+				    header->start, header->length,
+				    create_tags, error, headers->next);
+
+ out:
+  g_list_foreach (headers, (GFunc)g_free, NULL);
+  g_list_free (headers);
+
+  return retval;
+}
@@ -39,5 +39,20 @@ gboolean _gtk_text_buffer_deserialize_rich_text (GtkTextBuffer     *register_buf
                                                  gpointer           user_data,
                                                  GError           **error);
 
+guint8 * _gtk_text_buffer_serialize_binary_rich_text   (GtkTextBuffer     *register_buffer,
+                                                        GtkTextBuffer     *content_buffer,
+                                                        const GtkTextIter *start,
+                                                        const GtkTextIter *end,
+                                                        gsize             *length,
+                                                        gpointer           user_data);
+
+gboolean _gtk_text_buffer_deserialize_binary_rich_text (GtkTextBuffer     *register_buffer,
+                                                        GtkTextBuffer     *content_buffer,
+                                                        GtkTextIter       *iter,
+                                                        const guint8      *data,
+                                                        gsize              length,
+                                                        gboolean           create_tags,
+                                                        gpointer           user_data,
+                                                        GError           **error);
 
 #endif /* __GTK_TEXT_BUFFER_SERIALIZE_H__ */
@@ -1127,6 +1127,103 @@ gtk_text_layout_validate (GtkTextLayout *layout,
     }
 }
 
+typedef struct _GtkTextLayoutEstimate GtkTextLayoutEstimate;
+
+struct _GtkTextLayoutEstimate
+{
+  GtkTextAttributes *style;
+  gint char_width;
+  gint line_height;
+  gint wrap_width;
+};
+
+static void
+estimate_line_size (GtkTextLine     *line,
+                    GtkTextLineData *line_data,
+                    gpointer         data)
+{
+  GtkTextLayoutEstimate *estimate = data;
+  gint text_width;
+  gint n_lines;
+
+  text_width = _gtk_text_line_char_count (line) * estimate->char_width;
+
+  if (estimate->wrap_width > 0 && text_width > estimate->wrap_width)
+    {
+      n_lines = (text_width + estimate->wrap_width - 1) / estimate->wrap_width;
+      text_width = estimate->wrap_width;
+    }
+  else
+    n_lines = 1;
+
+  line_data->width = text_width +
+    estimate->style->left_margin + estimate->style->right_margin;
+  line_data->height = n_lines * estimate->line_height +
+    (n_lines - 1) * estimate->style->pixels_inside_wrap +
+    estimate->style->pixels_above_lines + estimate->style->pixels_below_lines;
+}
+
+/**
+ * _gtk_text_layout_estimate_heights:
+ * @layout: a #GtkTextLayout
+ *
+ * Gives lines that have not been laid out yet a size guessed from
+ * their length and the metrics of the default font, without shaping
+ * them. This makes the total size of the layout roughly right long
+ * before it has been validated; the estimated lines stay invalid and
+ * are replaced with their real size as they get validated. The
+ * ::changed signal is emitted for the region that was estimated.
+ **/
+void
+_gtk_text_layout_estimate_heights (GtkTextLayout *layout)
+{
+  GtkTextLayoutEstimate estimate;
+  PangoFontMetrics *metrics;
+  PangoLanguage *language;
+  gint y, old_height, new_height;
+
+  g_return_if_fail (GTK_IS_TEXT_LAYOUT (layout));
+
+  if (layout->buffer == NULL || layout->ltr_context == NULL ||
+      layout->default_style == NULL)
+    return;
+
+  estimate.style = layout->default_style;
+
+  if (estimate.style->wrap_mode != GTK_WRAP_NONE)
+    {
+      estimate.wrap_width = layout->screen_width -
+        estimate.style->left_margin - estimate.style->right_margin;
+
+      /* Nothing to wrap against until we have a width */
+      if (estimate.wrap_width <= 0)
+        return;
+    }
+  else
+    estimate.wrap_width = -1;
+
+  language = estimate.style->language;
+  if (language == NULL)
+    language = pango_context_get_language (layout->ltr_context);
+
+  metrics = pango_context_get_metrics (layout->ltr_context,
+                                       estimate.style->font, language);
+  estimate.char_width =
+    PANGO_PIXELS (pango_font_metrics_get_approximate_char_width (metrics));
+  estimate.line_height =
+    PANGO_PIXELS (pango_font_metrics_get_ascent (metrics) +
+                  pango_font_metrics_get_descent (metrics));
+  pango_font_metrics_unref (metrics);
+
+  if (_gtk_text_btree_estimate (_gtk_text_buffer_get_btree (layout->buffer),
+                                layout, estimate_line_size, &estimate,
+                                &y, &old_height, &new_height))
+    {
+      update_layout_size (layout);
+      gtk_text_layout_emit_changed (layout, y, old_height, new_height);
+    }
+}
+
 static GtkTextLineData*
 gtk_text_layout_real_wrap (GtkTextLayout   *layout,
                            GtkTextLine     *line,
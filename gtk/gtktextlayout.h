@@ -352,6 +352,7 @@ void     gtk_text_layout_validate_yrange (GtkTextLayout *layout,
                                           gint           y1_);
 void     gtk_text_layout_validate        (GtkTextLayout *layout,
                                           gint           max_pixels);
+void     _gtk_text_layout_estimate_heights (GtkTextLayout *layout);
 
 /* This function should return the passed-in line data,
  * OR remove the existing line data from the line, and
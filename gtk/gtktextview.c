@@ -114,6 +114,8 @@ struct _GtkTextViewPrivate
   guint blink_time;  /* time in msec the cursor has blinked since last user event */
   guint im_spot_idle;
 
+  guint estimate_line_heights : 1;
+
 #ifdef MAEMO_CHANGES
   GtkTextBuffer *placeholder_buffer;
   GtkTextLayout *placeholder_layout;
@@ -166,7 +168,8 @@ enum
   PROP_CURSOR_VISIBLE,
   PROP_BUFFER,
   PROP_OVERWRITE,
-  PROP_ACCEPTS_TAB
+  PROP_ACCEPTS_TAB,
+  PROP_ESTIMATE_LINE_HEIGHTS
 #ifdef MAEMO_CHANGES
   , PROP_HILDON_INPUT_MODE
   , PROP_HILDON_INPUT_DEFAULT
@@ -682,6 +685,23 @@ gtk_text_view_class_init (GtkTextViewClass *klass)
 							 TRUE,
 							 GTK_PARAM_READWRITE));
 
+  /**
+   * GtkTextView:estimate-line-heights:
+   *
+   * Whether lines that have not been laid out yet should be given a
+   * height estimated from their length, so that the scrollbars are
+   * close to right before the whole buffer has been validated.
+   *
+   * Since: 2.14
+   */
+  g_object_class_install_property (gobject_class,
+                                   PROP_ESTIMATE_LINE_HEIGHTS,
+                                   g_param_spec_boolean ("estimate-line-heights",
+							 P_("Estimate line heights"),
+							 P_("Whether to estimate the height of lines that have not been laid out yet"),
+							 FALSE,
+							 GTK_PARAM_READWRITE));
+
 #ifdef MAEMO_CHANGES
   /**
    * GtkTextView:hildon-input-mode:
@@ -3032,6 +3052,10 @@ gtk_text_view_set_property (GObject         *object,
       gtk_text_view_set_accepts_tab (text_view, g_value_get_boolean (value));
       break;
 
+    case PROP_ESTIMATE_LINE_HEIGHTS:
+      gtk_text_view_set_estimate_line_heights (text_view, g_value_get_boolean (value));
+      break;
+
 #ifdef MAEMO_CHANGES
     case PROP_HILDON_INPUT_MODE:
       hildon_gtk_text_view_set_input_mode (text_view, g_value_get_flags (value));
@@ -3120,6 +3144,10 @@ gtk_text_view_get_property (GObject         *object,
       g_value_set_boolean (value, text_view->accepts_tab);
       break;
 
+    case PROP_ESTIMATE_LINE_HEIGHTS:
+      g_value_set_boolean (value, GTK_TEXT_VIEW_GET_PRIVATE (text_view)->estimate_line_heights);
+      break;
+
 #ifdef MAEMO_CHANGES
     case PROP_HILDON_INPUT_MODE:
       g_value_set_flags (value, hildon_gtk_text_view_get_input_mode (text_view));
@@ -3659,6 +3687,15 @@ gtk_text_view_flush_first_validate (GtkTextView *text_view)
     }
   else
     {
+      GtkTextViewPrivate *priv = GTK_TEXT_VIEW_GET_PRIVATE (text_view);
+
+      /* give the lines we are not going to validate right away a
+       * rough size, so the scrollbars don't jump around as the
+       * idle validation works its way through the buffer.
+       */
+      if (priv->estimate_line_heights && text_view->layout)
+        _gtk_text_layout_estimate_heights (text_view->layout);
+
       /* scroll to any marks, if that's pending. This can jump us to
        * the validation codepath used for scrolling onscreen, if so we
        * bail out.  It won't jump if already in that codepath since
@@ -6135,6 +6172,67 @@ gtk_text_view_get_accepts_tab (GtkTextView *text_view)
   return text_view->accepts_tab;
 }
 
+/**
+ * gtk_text_view_set_estimate_line_heights:
+ * @text_view: A #GtkTextView
+ * @estimate: whether to estimate the height of lines that have not
+ *    been laid out yet
+ *
+ * Sets whether lines that have not been laid out yet get a height
+ * estimated from their length and the metrics of the default font.
+ * Laying out every line of a large buffer takes a while, and until
+ * it is done the scrollbars only reflect the part that has been
+ * validated. With estimation turned on they are roughly right from
+ * the start, and get corrected as the lines are laid out in the
+ * background.
+ *
+ * Since: 2.14
+ **/
+void
+gtk_text_view_set_estimate_line_heights (GtkTextView *text_view,
+                                         gboolean     estimate)
+{
+  GtkTextViewPrivate *priv;
+
+  g_return_if_fail (GTK_IS_TEXT_VIEW (text_view));
+
+  priv = GTK_TEXT_VIEW_GET_PRIVATE (text_view);
+  estimate = estimate != FALSE;
+
+  if (priv->estimate_line_heights != estimate)
+    {
+      priv->estimate_line_heights = estimate;
+
+      if (estimate && text_view->layout)
+        gtk_text_view_invalidate (text_view);
+
+      g_object_notify (G_OBJECT (text_view), "estimate-line-heights");
+    }
+}
+
+/**
+ * gtk_text_view_get_estimate_line_heights:
+ * @text_view: A #GtkTextView
+ *
+ * Returns whether the height of lines that have not been laid out
+ * yet is estimated. See gtk_text_view_set_estimate_line_heights().
+ *
+ * Return value: %TRUE if line heights are estimated
+ *
+ * Since: 2.14
+ **/
+gboolean
+gtk_text_view_get_estimate_line_heights (GtkTextView *text_view)
+{
+  GtkTextViewPrivate *priv;
+
+  g_return_val_if_fail (GTK_IS_TEXT_VIEW (text_view), FALSE);
+
+  priv = GTK_TEXT_VIEW_GET_PRIVATE (text_view);
+
+  return priv->estimate_line_heights;
+}
+
 static void
 gtk_text_view_compat_move_focus (GtkTextView     *text_view,
                                  GtkDirectionType direction_type)
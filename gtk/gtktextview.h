@@ -336,6 +336,9 @@ gboolean         gtk_text_view_get_overwrite          (GtkTextView      *text_vi
 void		 gtk_text_view_set_accepts_tab        (GtkTextView	*text_view,
 						       gboolean		 accepts_tab);
 gboolean	 gtk_text_view_get_accepts_tab        (GtkTextView	*text_view);
+void		 gtk_text_view_set_estimate_line_heights (GtkTextView	*text_view,
+							  gboolean	 estimate);
+gboolean	 gtk_text_view_get_estimate_line_heights (GtkTextView	*text_view);
 void             gtk_text_view_set_pixels_above_lines (GtkTextView      *text_view,
                                                        gint              pixels_above_lines);
 gint             gtk_text_view_get_pixels_above_lines (GtkTextView      *text_view);
@@ -25,43 +25,138 @@
 #include "gtkalias.h"
 #include <string.h>
 
-/* node allocation
+/* row allocation
+ *
+ * The values of a row are kept in one block of n_columns nodes, so that
+ * a column can be reached by indexing instead of walking a list.  Two
+ * more nodes follow the columns: the collation key of one string column
+ * and the number of that column, filled in lazily while sorting.
  */
+#define COLLATE_KEY(list, n_columns)        ((list)[(n_columns)].data.v_pointer)
+#define COLLATE_KEY_COLUMN(list, n_columns) ((list)[(n_columns) + 1].data.v_int)
+#define ROW_SIZE(n_columns)                 (((n_columns) + 2) * sizeof (GtkTreeDataList))
+
 GtkTreeDataList *
-_gtk_tree_data_list_alloc (void)
+_gtk_tree_data_list_alloc (gint n_columns)
 {
-  GtkTreeDataList *list;
+  g_return_val_if_fail (n_columns > 0, NULL);
 
-  list = g_slice_new0 (GtkTreeDataList);
+  return g_slice_alloc0 (ROW_SIZE (n_columns));
+}
 
-  return list;
+static void
+_gtk_tree_data_list_node_clear (GtkTreeDataList *node,
+				GType            type)
+{
+  if (node->data.v_pointer == NULL)
+    return;
+
+  if (g_type_is_a (type, G_TYPE_STRING))
+    g_free ((gchar *) node->data.v_pointer);
+  else if (g_type_is_a (type, G_TYPE_OBJECT))
+    g_object_unref (node->data.v_pointer);
+  else if (g_type_is_a (type, G_TYPE_BOXED))
+    g_boxed_free (type, (gpointer) node->data.v_pointer);
 }
 
 void
 _gtk_tree_data_list_free (GtkTreeDataList *list,
+			  gint             n_columns,
 			  GType           *column_headers)
 {
-  GtkTreeDataList *tmp, *next;
-  gint i = 0;
+  gint i;
+
+  if (list == NULL)
+    return;
 
-  tmp = list;
+  for (i = 0; i < n_columns; i++)
+    _gtk_tree_data_list_node_clear (&list[i], column_headers[i]);
 
-  while (tmp)
+  g_free (COLLATE_KEY (list, n_columns));
+  g_slice_free1 (ROW_SIZE (n_columns), list);
+}
+
+/* collation keys
+ */
+static const gchar *
+_gtk_tree_data_list_get_collate_key (GtkTreeDataList *list,
+				     gint             n_columns,
+				     gint             column)
+{
+  static gchar *empty_key = NULL;
+  const gchar *str;
+
+  if (list == NULL)
     {
-      next = tmp->next;
-      if (g_type_is_a (column_headers [i], G_TYPE_STRING))
-	g_free ((gchar *) tmp->data.v_pointer);
-      else if (g_type_is_a (column_headers [i], G_TYPE_OBJECT) && tmp->data.v_pointer != NULL)
-	g_object_unref (tmp->data.v_pointer);
-      else if (g_type_is_a (column_headers [i], G_TYPE_BOXED) && tmp->data.v_pointer != NULL)
-	g_boxed_free (column_headers [i], (gpointer) tmp->data.v_pointer);
-
-      g_slice_free (GtkTreeDataList, tmp);
-      i++;
-      tmp = next;
+      /* a row that was never set holds a NULL string */
+      if (empty_key == NULL)
+	empty_key = g_utf8_collate_key ("", -1);
+
+      return empty_key;
+    }
+
+  if (COLLATE_KEY (list, n_columns) != NULL &&
+      COLLATE_KEY_COLUMN (list, n_columns) == column)
+    return COLLATE_KEY (list, n_columns);
+
+  g_free (COLLATE_KEY (list, n_columns));
+
+  str = list[column].data.v_pointer;
+  COLLATE_KEY (list, n_columns) = g_utf8_collate_key (str ? str : "", -1);
+  COLLATE_KEY_COLUMN (list, n_columns) = column;
+
+  return COLLATE_KEY (list, n_columns);
+}
+
+void
+_gtk_tree_data_list_invalidate_collate_key (GtkTreeDataList *list,
+					    gint             n_columns,
+					    gint             column)
+{
+  if (list == NULL || COLLATE_KEY (list, n_columns) == NULL)
+    return;
+
+  if (COLLATE_KEY_COLUMN (list, n_columns) == column)
+    {
+      g_free (COLLATE_KEY (list, n_columns));
+      COLLATE_KEY (list, n_columns) = NULL;
     }
 }
 
+/* Returns TRUE if rows sorted with @func and @data can be compared with
+ * _gtk_tree_data_list_collate_compare() instead, that is when @func is
+ * the default compare function on a string column.
+ */
+gboolean
+_gtk_tree_data_list_can_collate (GtkTreeIterCompareFunc  func,
+				 gpointer                data,
+				 gint                    n_columns,
+				 GType                  *column_headers)
+{
+  gint column = GPOINTER_TO_INT (data);
+
+  if (func != _gtk_tree_data_list_compare_func)
+    return FALSE;
+
+  if (column < 0 || column >= n_columns)
+    return FALSE;
+
+  return column_headers[column] == G_TYPE_STRING;
+}
+
+/* Same result as _gtk_tree_data_list_compare_func() on a string column,
+ * but collates each row only once per sort column.
+ */
+gint
+_gtk_tree_data_list_collate_compare (GtkTreeDataList *a,
+				     GtkTreeDataList *b,
+				     gint             n_columns,
+				     gint             column)
+{
+  return strcmp (_gtk_tree_data_list_get_collate_key (a, n_columns, column),
+		 _gtk_tree_data_list_get_collate_key (b, n_columns, column));
+}
+
 gboolean
 _gtk_tree_data_list_check_type (GType type)
 {
@@ -250,17 +345,11 @@ _gtk_tree_data_list_value_to_node (GtkTreeDataList *list,
     }
 }
 
-GtkTreeDataList *
-_gtk_tree_data_list_node_copy (GtkTreeDataList *list,
+static void
+_gtk_tree_data_list_node_copy (GtkTreeDataList *src,
+                               GtkTreeDataList *dest,
                                GType            type)
 {
-  GtkTreeDataList *new_list;
-
-  g_return_val_if_fail (list != NULL, NULL);
-  
-  new_list = _gtk_tree_data_list_alloc ();
-  new_list->next = NULL;
-
   switch (get_fundamental_type (type))
     {
     case G_TYPE_BOOLEAN:
@@ -277,27 +366,44 @@ _gtk_tree_data_list_node_copy (GtkTreeDataList *list,
     case G_TYPE_POINTER:
     case G_TYPE_FLOAT:
     case G_TYPE_DOUBLE:
-      new_list->data = list->data;
+      dest->data = src->data;
       break;
     case G_TYPE_STRING:
-      new_list->data.v_pointer = g_strdup (list->data.v_pointer);
+      dest->data.v_pointer = g_strdup (src->data.v_pointer);
       break;
     case G_TYPE_OBJECT:
     case G_TYPE_INTERFACE:
-      new_list->data.v_pointer = list->data.v_pointer;
-      if (new_list->data.v_pointer)
-	g_object_ref (new_list->data.v_pointer);
+      dest->data.v_pointer = src->data.v_pointer;
+      if (dest->data.v_pointer)
+	g_object_ref (dest->data.v_pointer);
       break;
     case G_TYPE_BOXED:
-      if (list->data.v_pointer)
-	new_list->data.v_pointer = g_boxed_copy (type, list->data.v_pointer);
+      if (src->data.v_pointer)
+	dest->data.v_pointer = g_boxed_copy (type, src->data.v_pointer);
       else
-	new_list->data.v_pointer = NULL;
+	dest->data.v_pointer = NULL;
       break;
     default:
       g_warning ("Unsupported node type (%s) copied.", g_type_name (type));
       break;
     }
+}
+
+GtkTreeDataList *
+_gtk_tree_data_list_copy (GtkTreeDataList *list,
+                          gint             n_columns,
+                          GType           *column_headers)
+{
+  GtkTreeDataList *new_list;
+  gint i;
+
+  if (list == NULL)
+    return NULL;
+
+  new_list = _gtk_tree_data_list_alloc (n_columns);
+
+  for (i = 0; i < n_columns; i++)
+    _gtk_tree_data_list_node_copy (&list[i], &new_list[i], column_headers[i]);
 
   return new_list;
 }
@@ -25,8 +25,6 @@
 typedef struct _GtkTreeDataList GtkTreeDataList;
 struct _GtkTreeDataList
 {
-  GtkTreeDataList *next;
-
   union {
     gint	   v_int;
     gint8          v_char;
@@ -50,8 +48,9 @@ typedef struct _GtkTreeDataSortHeader
   GDestroyNotify destroy;
 } GtkTreeDataSortHeader;
 
-GtkTreeDataList *_gtk_tree_data_list_alloc          (void);
+GtkTreeDataList *_gtk_tree_data_list_alloc          (gint             n_columns);
 void             _gtk_tree_data_list_free           (GtkTreeDataList *list,
+						     gint             n_columns,
 						     GType           *column_headers);
 gboolean         _gtk_tree_data_list_check_type     (GType            type);
 void             _gtk_tree_data_list_node_to_value  (GtkTreeDataList *list,
@@ -60,8 +59,22 @@ void             _gtk_tree_data_list_node_to_value  (GtkTreeDataList *list,
 void             _gtk_tree_data_list_value_to_node  (GtkTreeDataList *list,
 						     GValue          *value);
 
-GtkTreeDataList *_gtk_tree_data_list_node_copy      (GtkTreeDataList *list,
-                                                     GType            type);
+GtkTreeDataList *_gtk_tree_data_list_copy           (GtkTreeDataList *list,
+                                                     gint             n_columns,
+                                                     GType           *column_headers);
+
+/* Collation keys for string columns */
+gboolean         _gtk_tree_data_list_can_collate    (GtkTreeIterCompareFunc  func,
+						     gpointer                data,
+						     gint                    n_columns,
+						     GType                  *column_headers);
+gint             _gtk_tree_data_list_collate_compare (GtkTreeDataList *a,
+						      GtkTreeDataList *b,
+						      gint             n_columns,
+						      gint             column);
+void             _gtk_tree_data_list_invalidate_collate_key (GtkTreeDataList *list,
+							     gint             n_columns,
+							     gint             column);
 
 /* Header code */
 gint                   _gtk_tree_data_list_compare_func (GtkTreeModel *model,
@@ -85,6 +85,7 @@ struct _SortTuple
 {
   SortElt   *elt;
   gint       offset;
+  gchar     *collate_key;
 };
 
 /* Properties */
@@ -1497,6 +1498,74 @@ gtk_tree_model_sort_compare_func (gconstpointer a,
   return retval;
 }
 
+static gint
+gtk_tree_model_sort_collate_compare_func (gconstpointer a,
+					  gconstpointer b,
+					  gpointer      user_data)
+{
+  SortData *data = (SortData *)user_data;
+  SortTuple *sa = (SortTuple *)a;
+  SortTuple *sb = (SortTuple *)b;
+  gint retval;
+
+  if (sa->offset == sb->offset)
+    return 0;
+
+  retval = strcmp (sa->collate_key, sb->collate_key);
+
+  if (data->tree_model_sort->order == GTK_SORT_DESCENDING)
+    {
+      if (retval > 0)
+	retval = -1;
+      else if (retval < 0)
+	retval = 1;
+    }
+
+  return retval;
+}
+
+/* When sorting a string column with the default compare function,
+ * collate every row once up front instead of on each comparison.
+ */
+static gboolean
+gtk_tree_model_sort_build_collate_keys (GtkTreeModelSort *tree_model_sort,
+					SortData         *data,
+					GArray           *sort_array)
+{
+  gint column = GPOINTER_TO_INT (data->sort_data);
+  gint i;
+
+  if (data->sort_func != _gtk_tree_data_list_compare_func)
+    return FALSE;
+
+  if (gtk_tree_model_get_column_type (tree_model_sort->child_model,
+				      column) != G_TYPE_STRING)
+    return FALSE;
+
+  for (i = 0; i < sort_array->len; i++)
+    {
+      SortTuple *tuple = &g_array_index (sort_array, SortTuple, i);
+      GtkTreeIter child_iter;
+      gchar *str = NULL;
+
+      if (GTK_TREE_MODEL_SORT_CACHE_CHILD_ITERS (tree_model_sort))
+	child_iter = tuple->elt->iter;
+      else
+	{
+	  data->parent_path_indices [data->parent_path_depth-1] = tuple->elt->offset;
+	  gtk_tree_model_get_iter (tree_model_sort->child_model,
+				   &child_iter, data->parent_path);
+	}
+
+      gtk_tree_model_get (tree_model_sort->child_model, &child_iter,
+			  column, &str, -1);
+      tuple->collate_key = g_utf8_collate_key (str ? str : "", -1);
+      g_free (str);
+    }
+
+  return TRUE;
+}
+
 static gint
 gtk_tree_model_sort_offset_compare_func (gconstpointer a,
 					 gconstpointer b,
@@ -1579,6 +1648,7 @@ gtk_tree_model_sort_sort_level (GtkTreeModelSort *tree_model_sort,
 
       tuple.elt = &g_array_index (level->array, SortElt, i);
       tuple.offset = i;
+      tuple.collate_key = NULL;
 
       g_array_append_val (sort_array, tuple);
     }
@@ -1609,6 +1679,16 @@ gtk_tree_model_sort_sort_level (GtkTreeModelSort *tree_model_sort,
     g_array_sort_with_data (sort_array,
 			    gtk_tree_model_sort_offset_compare_func,
 			    &data);
+  else if (gtk_tree_model_sort_build_collate_keys (tree_model_sort,
+						   &data, sort_array))
+    {
+      g_array_sort_with_data (sort_array,
+			      gtk_tree_model_sort_collate_compare_func,
+			      &data);
+
+      for (i = 0; i < sort_array->len; i++)
+	g_free (g_array_index (sort_array, SortTuple, i).collate_key);
+    }
   else
     g_array_sort_with_data (sort_array,
 			    gtk_tree_model_sort_compare_func,
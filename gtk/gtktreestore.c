@@ -29,6 +29,7 @@
 #include "gtkalias.h"
 
 #define G_NODE(node) ((GNode *)node)
+#define GTK_TREE_STORE_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), GTK_TYPE_TREE_STORE, GtkTreeStorePrivate))
 #define GTK_TREE_STORE_IS_SORTED(tree) (((GtkTreeStore*)(tree))->sort_column_id != GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID)
 #define VALID_ITER(iter, tree_store) ((iter)!= NULL && (iter)->user_data != NULL && ((GtkTreeStore*)(tree_store))->stamp == (iter)->stamp)
 
@@ -134,6 +135,32 @@ static void     gtk_tree_store_buildable_custom_finished (GtkBuildable 	 *builda
 
 static void     validate_gnode                         (GNode *node);
 
+/* Levels with more than LEVEL_INDEX_THRESHOLD children get an index, so
+ * that nth-child and path lookups don't have to walk the siblings.  The
+ * children are kept in two arrays growing away from a common origin,
+ * which keeps appending and prepending O(1); a child's key is its
+ * offset from the origin, and its position is its key minus the key of
+ * the first child.
+ */
+#define LEVEL_INDEX_THRESHOLD 64
+
+typedef struct _GtkTreeStorePrivate GtkTreeStorePrivate;
+typedef struct _GtkTreeStoreLevel   GtkTreeStoreLevel;
+
+struct _GtkTreeStorePrivate
+{
+  GHashTable *levels;     /* parent GNode -> GtkTreeStoreLevel */
+};
+
+struct _GtkTreeStoreLevel
+{
+  GPtrArray  *front;      /* children with keys -1, -2, ... */
+  GPtrArray  *back;       /* children with keys 0, 1, ... */
+  gint        first;      /* key of the first child */
+  gint        length;
+  GHashTable *keys;       /* GNode -> key */
+};
+
 static void     gtk_tree_store_move                    (GtkTreeStore           *tree_store,
                                                         GtkTreeIter            *iter,
                                                         GtkTreeIter            *position,
@@ -171,6 +198,8 @@ gtk_tree_store_class_init (GtkTreeStoreClass *class)
   object_class = (GObjectClass *) class;
 
   object_class->finalize = gtk_tree_store_finalize;
+
+  g_type_class_add_private (object_class, sizeof (GtkTreeStorePrivate));
 }
 
 static void
@@ -410,11 +439,284 @@ gtk_tree_store_set_column_type (GtkTreeStore *tree_store,
   tree_store->column_headers[column] = type;
 }
 
+/* Level index
+ */
+static void
+gtk_tree_store_level_free (GtkTreeStoreLevel *level)
+{
+  g_ptr_array_free (level->front, TRUE);
+  g_ptr_array_free (level->back, TRUE);
+  g_hash_table_destroy (level->keys);
+  g_slice_free (GtkTreeStoreLevel, level);
+}
+
+static GtkTreeStoreLevel *
+gtk_tree_store_lookup_level (GtkTreeStore *tree_store,
+			     GNode        *parent)
+{
+  GtkTreeStorePrivate *priv = GTK_TREE_STORE_GET_PRIVATE (tree_store);
+
+  if (priv->levels == NULL)
+    return NULL;
+
+  return g_hash_table_lookup (priv->levels, parent);
+}
+
+static GtkTreeStoreLevel *
+gtk_tree_store_get_level (GtkTreeStore *tree_store,
+			  GNode        *parent)
+{
+  GtkTreeStorePrivate *priv = GTK_TREE_STORE_GET_PRIVATE (tree_store);
+  GtkTreeStoreLevel *level;
+  GNode *node;
+
+  if (priv->levels == NULL)
+    priv->levels = g_hash_table_new_full (NULL, NULL, NULL,
+					  (GDestroyNotify) gtk_tree_store_level_free);
+  else
+    {
+      level = g_hash_table_lookup (priv->levels, parent);
+      if (level)
+	return level;
+    }
+
+  level = g_slice_new (GtkTreeStoreLevel);
+  level->front = g_ptr_array_new ();
+  level->back = g_ptr_array_new ();
+  level->first = 0;
+  level->length = 0;
+  level->keys = g_hash_table_new (NULL, NULL);
+
+  for (node = parent->children; node; node = node->next)
+    {
+      g_hash_table_insert (level->keys, node, GINT_TO_POINTER (level->length));
+      g_ptr_array_add (level->back, node);
+      level->length++;
+    }
+
+  g_hash_table_insert (priv->levels, parent, level);
+
+  return level;
+}
+
+static void
+gtk_tree_store_level_invalidate (GtkTreeStore *tree_store,
+				 GNode        *parent)
+{
+  GtkTreeStorePrivate *priv = GTK_TREE_STORE_GET_PRIVATE (tree_store);
+
+  if (priv->levels != NULL)
+    g_hash_table_remove (priv->levels, parent);
+}
+
+static GNode *
+gtk_tree_store_level_nth (GtkTreeStoreLevel *level,
+			  gint               n)
+{
+  gint key;
+
+  if (n < 0 || n >= level->length)
+    return NULL;
+
+  key = level->first + n;
+  if (key >= 0)
+    return g_ptr_array_index (level->back, key);
+  else
+    return g_ptr_array_index (level->front, -key - 1);
+}
+
+static gint
+gtk_tree_store_level_position (GtkTreeStoreLevel *level,
+			       GNode             *node)
+{
+  gpointer key;
+
+  if (!g_hash_table_lookup_extended (level->keys, node, NULL, &key))
+    return -1;
+
+  return GPOINTER_TO_INT (key) - level->first;
+}
+
+/* Stores @node under @key, which must be next to the keys in use */
+static gboolean
+gtk_tree_store_level_set (GtkTreeStoreLevel *level,
+			  gint               key,
+			  GNode             *node)
+{
+  GPtrArray *array;
+  gint index;
+
+  if (key >= 0)
+    {
+      array = level->back;
+      index = key;
+    }
+  else
+    {
+      array = level->front;
+      index = -key - 1;
+    }
+
+  if (index < array->len)
+    g_ptr_array_index (array, index) = node;
+  else if (index == array->len)
+    g_ptr_array_add (array, node);
+  else
+    return FALSE;
+
+  g_hash_table_insert (level->keys, node, GINT_TO_POINTER (key));
+
+  return TRUE;
+}
+
+/* Called after @node has been linked into its parent */
+static void
+gtk_tree_store_level_child_added (GtkTreeStore *tree_store,
+				  GNode        *node)
+{
+  GtkTreeStoreLevel *level;
+  gint key;
+
+  level = gtk_tree_store_lookup_level (tree_store, node->parent);
+  if (level == NULL)
+    return;
+
+  if (node->next == NULL)
+    key = level->first + level->length;
+  else if (node->prev == NULL)
+    key = level->first - 1;
+  else
+    {
+      gtk_tree_store_level_invalidate (tree_store, node->parent);
+      return;
+    }
+
+  if (!gtk_tree_store_level_set (level, key, node))
+    {
+      gtk_tree_store_level_invalidate (tree_store, node->parent);
+      return;
+    }
+
+  if (node->prev == NULL)
+    level->first = key;
+  level->length++;
+}
+
+/* Called before @node is unlinked from its parent */
+static void
+gtk_tree_store_level_child_removed (GtkTreeStore *tree_store,
+				    GNode        *node)
+{
+  GtkTreeStoreLevel *level;
+  gint position;
+
+  level = gtk_tree_store_lookup_level (tree_store, node->parent);
+  if (level == NULL)
+    return;
+
+  position = gtk_tree_store_level_position (level, node);
+
+  if (position == 0)
+    level->first++;
+  else if (position < 0 || position != level->length - 1)
+    {
+      gtk_tree_store_level_invalidate (tree_store, node->parent);
+      return;
+    }
+
+  g_hash_table_remove (level->keys, node);
+  level->length--;
+}
+
+static gboolean
+level_forget (GNode    *node,
+	      gpointer  data)
+{
+  g_hash_table_remove (data, node);
+
+  return FALSE;
+}
+
+/* Drops the indexes of @node and its descendants, before they are freed */
+static void
+gtk_tree_store_level_forget_subtree (GtkTreeStore *tree_store,
+				     GNode        *node)
+{
+  GtkTreeStorePrivate *priv = GTK_TREE_STORE_GET_PRIVATE (tree_store);
+
+  if (priv->levels == NULL || g_hash_table_size (priv->levels) == 0)
+    return;
+
+  g_node_traverse (node, G_POST_ORDER, G_TRAVERSE_ALL, -1,
+		   level_forget, priv->levels);
+}
+
+static GNode *
+gtk_tree_store_last_child (GtkTreeStore *tree_store,
+			   GNode        *parent)
+{
+  GtkTreeStoreLevel *level;
+  GNode *node;
+  gint n = 0;
+
+  level = gtk_tree_store_lookup_level (tree_store, parent);
+  if (level)
+    return gtk_tree_store_level_nth (level, level->length - 1);
+
+  node = parent->children;
+  if (node == NULL)
+    return NULL;
+
+  while (node->next)
+    {
+      node = node->next;
+
+      if (++n == LEVEL_INDEX_THRESHOLD)
+	{
+	  level = gtk_tree_store_get_level (tree_store, parent);
+	  return gtk_tree_store_level_nth (level, level->length - 1);
+	}
+    }
+
+  return node;
+}
+
+/* Like g_node_insert(), without walking long levels */
+static void
+gtk_tree_store_insert_node (GtkTreeStore *tree_store,
+			    GNode        *parent,
+			    gint          position,
+			    GNode        *node)
+{
+  GtkTreeStoreLevel *level = NULL;
+
+  if (position < 0 || position >= LEVEL_INDEX_THRESHOLD)
+    level = gtk_tree_store_lookup_level (tree_store, parent);
+  if (level == NULL && position >= LEVEL_INDEX_THRESHOLD)
+    level = gtk_tree_store_get_level (tree_store, parent);
+
+  if (level && position >= 0 && position < level->length)
+    g_node_insert_before (parent,
+			  gtk_tree_store_level_nth (level, position),
+			  node);
+  else if (position < 0 || level)
+    g_node_insert_after (parent,
+			 gtk_tree_store_last_child (tree_store, parent),
+			 node);
+  else
+    g_node_insert (parent, position, node);
+
+  gtk_tree_store_level_child_added (tree_store, node);
+}
+
 static gboolean
 node_free (GNode *node, gpointer data)
 {
+  GtkTreeStore *tree_store = data;
+
   if (node->data)
-    _gtk_tree_data_list_free (node->data, (GType*)data);
+    _gtk_tree_data_list_free (node->data, tree_store->n_columns,
+			      tree_store->column_headers);
   node->data = NULL;
 
   return FALSE;
@@ -424,9 +726,13 @@ static void
 gtk_tree_store_finalize (GObject *object)
 {
   GtkTreeStore *tree_store = GTK_TREE_STORE (object);
+  GtkTreeStorePrivate *priv = GTK_TREE_STORE_GET_PRIVATE (tree_store);
+
+  if (priv->levels)
+    g_hash_table_destroy (priv->levels);
 
   g_node_traverse (tree_store->root, G_POST_ORDER, G_TRAVERSE_ALL, -1,
-		   node_free, tree_store->column_headers);
+		   node_free, tree_store);
   g_node_destroy (tree_store->root);
   _gtk_tree_data_list_header_free (tree_store->sort_list);
   g_free (tree_store->column_headers);
@@ -556,13 +862,24 @@ gtk_tree_store_get_path (GtkTreeModel *tree_model,
       return NULL;
     }
 
-  for (; tmp_node; tmp_node = tmp_node->next)
+  for (; tmp_node && i < LEVEL_INDEX_THRESHOLD; tmp_node = tmp_node->next)
     {
       if (tmp_node == G_NODE (iter->user_data))
 	break;
       i++;
     }
 
+  if (tmp_node && tmp_node != G_NODE (iter->user_data))
+    {
+      GtkTreeStoreLevel *level;
+
+      /* a long level, look the node up in its index */
+      level = gtk_tree_store_get_level (tree_store, tmp_node->parent);
+      i = gtk_tree_store_level_position (level, iter->user_data);
+      if (i < 0)
+	tmp_node = NULL;
+    }
+
   if (tmp_node == NULL)
     {
       /* We couldn't find node, meaning it's prolly not ours */
@@ -585,19 +902,15 @@ gtk_tree_store_get_value (GtkTreeModel *tree_model,
 {
   GtkTreeStore *tree_store = (GtkTreeStore *) tree_model;
   GtkTreeDataList *list;
-  gint tmp_column = column;
 
   g_return_if_fail (column < tree_store->n_columns);
   g_return_if_fail (VALID_ITER (iter, tree_store));
 
   list = G_NODE (iter->user_data)->data;
 
-  while (tmp_column-- > 0 && list)
-    list = list->next;
-
   if (list)
     {
-      _gtk_tree_data_list_node_to_value (list,
+      _gtk_tree_data_list_node_to_value (&list[column],
 					 tree_store->column_headers[column],
 					 value);
     }
@@ -664,16 +977,23 @@ static gint
 gtk_tree_store_iter_n_children (GtkTreeModel *tree_model,
 				GtkTreeIter  *iter)
 {
+  GtkTreeStoreLevel *level;
+  GNode *parent;
   GNode *node;
   gint i = 0;
 
   g_return_val_if_fail (iter == NULL || iter->user_data != NULL, 0);
 
   if (iter == NULL)
-    node = G_NODE (GTK_TREE_STORE (tree_model)->root)->children;
+    parent = G_NODE (GTK_TREE_STORE (tree_model)->root);
   else
-    node = G_NODE (iter->user_data)->children;
+    parent = G_NODE (iter->user_data);
 
+  level = gtk_tree_store_lookup_level (GTK_TREE_STORE (tree_model), parent);
+  if (level)
+    return level->length;
+
+  node = parent->children;
   while (node)
     {
       i++;
@@ -700,7 +1020,12 @@ gtk_tree_store_iter_nth_child (GtkTreeModel *tree_model,
   else
     parent_node = parent->user_data;
 
-  child = g_node_nth_child (parent_node, n);
+  if (n >= LEVEL_INDEX_THRESHOLD)
+    child = gtk_tree_store_level_nth (gtk_tree_store_get_level (tree_store,
+								parent_node),
+				      n);
+  else
+    child = g_node_nth_child (parent_node, n);
 
   if (child)
     {
@@ -747,8 +1072,6 @@ gtk_tree_store_real_set_value (GtkTreeStore *tree_store,
 			       gboolean      sort)
 {
   GtkTreeDataList *list;
-  GtkTreeDataList *prev;
-  gint old_column = column;
   GValue real_value = {0, };
   gboolean converted = FALSE;
   gboolean retval = FALSE;
@@ -776,47 +1099,17 @@ gtk_tree_store_real_set_value (GtkTreeStore *tree_store,
       converted = TRUE;
     }
 
-  prev = list = G_NODE (iter->user_data)->data;
+  list = G_NODE (iter->user_data)->data;
 
-  while (list != NULL)
+  if (list == NULL)
     {
-      if (column == 0)
-	{
-	  if (converted)
-	    _gtk_tree_data_list_value_to_node (list, &real_value);
-	  else
-	    _gtk_tree_data_list_value_to_node (list, value);
-	  retval = TRUE;
-	  if (converted)
-	    g_value_unset (&real_value);
-          if (sort && GTK_TREE_STORE_IS_SORTED (tree_store))
-            gtk_tree_store_sort_iter_changed (tree_store, iter, old_column, TRUE);
-	  return retval;
-	}
-
-      column--;
-      prev = list;
-      list = list->next;
+      list = _gtk_tree_data_list_alloc (tree_store->n_columns);
+      G_NODE (iter->user_data)->data = list;
     }
 
-  if (G_NODE (iter->user_data)->data == NULL)
-    {
-      G_NODE (iter->user_data)->data = list = _gtk_tree_data_list_alloc ();
-      list->next = NULL;
-    }
-  else
-    {
-      list = prev->next = _gtk_tree_data_list_alloc ();
-      list->next = NULL;
-    }
+  _gtk_tree_data_list_invalidate_collate_key (list, tree_store->n_columns, column);
 
-  while (column != 0)
-    {
-      list->next = _gtk_tree_data_list_alloc ();
-      list = list->next;
-      list->next = NULL;
-      column --;
-    }
+  list = &list[column];
 
   if (converted)
     _gtk_tree_data_list_value_to_node (list, &real_value);
@@ -828,7 +1121,7 @@ gtk_tree_store_real_set_value (GtkTreeStore *tree_store,
     g_value_unset (&real_value);
 
   if (sort && GTK_TREE_STORE_IS_SORTED (tree_store))
-    gtk_tree_store_sort_iter_changed (tree_store, iter, old_column, TRUE);
+    gtk_tree_store_sort_iter_changed (tree_store, iter, column, TRUE);
 
   return retval;
 }
@@ -1116,9 +1409,12 @@ gtk_tree_store_remove (GtkTreeStore *tree_store,
 
   if (G_NODE (iter->user_data)->data)
     g_node_traverse (G_NODE (iter->user_data), G_POST_ORDER, G_TRAVERSE_ALL,
-		     -1, node_free, tree_store->column_headers);
+		     -1, node_free, tree_store);
 
   path = gtk_tree_store_get_path (GTK_TREE_MODEL (tree_store), iter);
+
+  gtk_tree_store_level_forget_subtree (tree_store, G_NODE (iter->user_data));
+  gtk_tree_store_level_child_removed (tree_store, G_NODE (iter->user_data));
   g_node_destroy (G_NODE (iter->user_data));
 
   gtk_tree_model_row_deleted (GTK_TREE_MODEL (tree_store), path);
@@ -1195,7 +1491,7 @@ gtk_tree_store_insert (GtkTreeStore *tree_store,
 
   iter->stamp = tree_store->stamp;
   iter->user_data = new_node;
-  g_node_insert (parent_node, position, new_node);
+  gtk_tree_store_insert_node (tree_store, parent_node, position, new_node);
 
   path = gtk_tree_store_get_path (GTK_TREE_MODEL (tree_store), iter);
   gtk_tree_model_row_inserted (GTK_TREE_MODEL (tree_store), path, iter);
@@ -1265,9 +1561,13 @@ gtk_tree_store_insert_before (GtkTreeStore *tree_store,
 
   new_node = g_node_new (NULL);
 
-  g_node_insert_before (parent_node,
-			sibling ? G_NODE (sibling->user_data) : NULL,
-                        new_node);
+  if (sibling)
+    g_node_insert_before (parent_node, G_NODE (sibling->user_data), new_node);
+  else
+    g_node_insert_after (parent_node,
+			 gtk_tree_store_last_child (tree_store, parent_node),
+			 new_node);
+  gtk_tree_store_level_child_added (tree_store, new_node);
 
   iter->stamp = tree_store->stamp;
   iter->user_data = new_node;
@@ -1349,6 +1649,7 @@ gtk_tree_store_insert_after (GtkTreeStore *tree_store,
   g_node_insert_after (parent_node,
 		       sibling ? G_NODE (sibling->user_data) : NULL,
                        new_node);
+  gtk_tree_store_level_child_added (tree_store, new_node);
 
   iter->stamp = tree_store->stamp;
   iter->user_data = new_node;
@@ -1438,7 +1739,7 @@ gtk_tree_store_insert_with_values (GtkTreeStore *tree_store,
 
   iter->stamp = tree_store->stamp;
   iter->user_data = new_node;
-  g_node_insert (parent_node, position, new_node);
+  gtk_tree_store_insert_node (tree_store, parent_node, position, new_node);
 
   va_start (var_args, position);
   gtk_tree_store_set_valist_internal (tree_store, iter,
@@ -1517,7 +1818,7 @@ gtk_tree_store_insert_with_valuesv (GtkTreeStore *tree_store,
 
   iter->stamp = tree_store->stamp;
   iter->user_data = new_node;
-  g_node_insert (parent_node, position, new_node);
+  gtk_tree_store_insert_node (tree_store, parent_node, position, new_node);
 
   gtk_tree_store_set_vector_internal (tree_store, iter,
 				      &changed, &maybe_need_sort,
@@ -1582,6 +1883,7 @@ gtk_tree_store_prepend (GtkTreeStore *tree_store,
       iter->user_data = g_node_new (NULL);
 
       g_node_prepend (parent_node, G_NODE (iter->user_data));
+      gtk_tree_store_level_child_added (tree_store, iter->user_data);
 
       path = gtk_tree_store_get_path (GTK_TREE_MODEL (tree_store), iter);
       gtk_tree_model_row_inserted (GTK_TREE_MODEL (tree_store), path, iter);
@@ -1640,6 +1942,7 @@ gtk_tree_store_append (GtkTreeStore *tree_store,
       iter->user_data = g_node_new (NULL);
 
       g_node_append (parent_node, G_NODE (iter->user_data));
+      gtk_tree_store_level_child_added (tree_store, iter->user_data);
 
       path = gtk_tree_store_get_path (GTK_TREE_MODEL (tree_store), iter);
       gtk_tree_model_row_inserted (GTK_TREE_MODEL (tree_store), path, iter);
@@ -1881,30 +2184,11 @@ copy_node_data (GtkTreeStore *tree_store,
                 GtkTreeIter  *dest_iter)
 {
   GtkTreeDataList *dl = G_NODE (src_iter->user_data)->data;
-  GtkTreeDataList *copy_head = NULL;
-  GtkTreeDataList *copy_prev = NULL;
-  GtkTreeDataList *copy_iter = NULL;
   GtkTreePath *path;
-  gint col;
-
-  col = 0;
-  while (dl)
-    {
-      copy_iter = _gtk_tree_data_list_node_copy (dl, tree_store->column_headers[col]);
-
-      if (copy_head == NULL)
-        copy_head = copy_iter;
 
-      if (copy_prev)
-        copy_prev->next = copy_iter;
-
-      copy_prev = copy_iter;
-
-      dl = dl->next;
-      ++col;
-    }
-
-  G_NODE (dest_iter->user_data)->data = copy_head;
+  G_NODE (dest_iter->user_data)->data =
+    _gtk_tree_data_list_copy (dl, tree_store->n_columns,
+                              tree_store->column_headers);
 
   path = gtk_tree_store_get_path (GTK_TREE_MODEL (tree_store), dest_iter);
   gtk_tree_model_row_changed (GTK_TREE_MODEL (tree_store), path, dest_iter);
@@ -2210,6 +2494,8 @@ gtk_tree_store_reorder (GtkTreeStore *tree_store,
   else
     G_NODE (tree_store->root)->children = sort_array[0].node;
 
+  gtk_tree_store_level_invalidate (tree_store, sort_array[0].node->parent);
+
   /* emit signal */
   if (parent)
     path = gtk_tree_store_get_path (GTK_TREE_MODEL (tree_store), parent);
@@ -2347,6 +2633,8 @@ gtk_tree_store_swap (GtkTreeStore *tree_store,
   node_b->prev = a_prev;
   node_b->next = a_next;
 
+  gtk_tree_store_level_invalidate (tree_store, parent_node);
+
   /* emit signal */
   order = g_new (gint, length);
   for (i = 0; i < length; i++)
@@ -2550,6 +2838,8 @@ gtk_tree_store_move (GtkTreeStore *tree_store,
   if (tmp_b)
     tmp_b->prev = tmp_a;
 
+  gtk_tree_store_level_invalidate (tree_store, parent);
+
   /* and reinsert the node */
   if (a)
     {
@@ -2770,7 +3060,16 @@ gtk_tree_store_compare_func (gconstpointer a,
   iter_b.stamp = tree_store->stamp;
   iter_b.user_data = node_b;
 
-  retval = (* func) (GTK_TREE_MODEL (user_data), &iter_a, &iter_b, data);
+  if (tree_store->sort_column_id != -1 &&
+      _gtk_tree_data_list_can_collate (func, data,
+				       tree_store->n_columns,
+				       tree_store->column_headers))
+    retval = _gtk_tree_data_list_collate_compare (node_a->data,
+						  node_b->data,
+						  tree_store->n_columns,
+						  GPOINTER_TO_INT (data));
+  else
+    retval = (* func) (GTK_TREE_MODEL (user_data), &iter_a, &iter_b, data);
 
   if (tree_store->order == GTK_SORT_DESCENDING)
     {
@@ -2836,6 +3135,8 @@ gtk_tree_store_sort_helper (GtkTreeStore *tree_store,
   g_array_index (sort_array, SortTuple, 0).node->prev = NULL;
   parent->children = g_array_index (sort_array, SortTuple, 0).node;
 
+  gtk_tree_store_level_invalidate (tree_store, parent);
+
   /* Let the world know about our new order */
   new_order = g_new (gint, list_length);
   for (i = 0; i < list_length; i++)
@@ -2994,6 +3295,8 @@ gtk_tree_store_sort_iter_changed (GtkTreeStore *tree_store,
   node->prev = NULL;
   node->next = NULL;
 
+  gtk_tree_store_level_invalidate (tree_store, node->parent);
+
   /* FIXME: as an optimization, we can potentially start at next */
   prev = NULL;
   node = node->parent->children;
@@ -60,6 +60,14 @@ enum
   LAST_SIGNAL
 };
 
+typedef struct _GtkTreeViewColumnAttribute GtkTreeViewColumnAttribute;
+struct _GtkTreeViewColumnAttribute
+{
+  gchar *name;
+  GParamSpec *pspec;
+  gint column;
+};
+
 typedef struct _GtkTreeViewColumnCellInfo GtkTreeViewColumnCellInfo;
 struct _GtkTreeViewColumnCellInfo
 {
@@ -680,6 +688,7 @@ gtk_tree_view_column_cell_layout_add_attribute (GtkCellLayout   *cell_layout,
 {
   GtkTreeViewColumn *tree_column;
   GtkTreeViewColumnCellInfo *info;
+  GtkTreeViewColumnAttribute *attr;
 
   g_return_if_fail (GTK_IS_TREE_VIEW_COLUMN (cell_layout));
   tree_column = GTK_TREE_VIEW_COLUMN (cell_layout);
@@ -687,8 +696,14 @@ gtk_tree_view_column_cell_layout_add_attribute (GtkCellLayout   *cell_layout,
   info = gtk_tree_view_column_get_cell_info (tree_column, cell);
   g_return_if_fail (info != NULL);
 
-  info->attributes = g_slist_prepend (info->attributes, GINT_TO_POINTER (column));
-  info->attributes = g_slist_prepend (info->attributes, g_strdup (attribute));
+  attr = g_slice_new (GtkTreeViewColumnAttribute);
+  attr->name = g_strdup (attribute);
+  attr->column = column;
+
+  /* Resolve the property once, instead of for every row */
+  attr->pspec = g_object_class_find_property (G_OBJECT_GET_CLASS (cell), attribute);
+
+  info->attributes = g_slist_prepend (info->attributes, attr);
 
   if (tree_column->tree_view)
     _gtk_tree_view_column_cell_set_dirty (tree_column, TRUE);
@@ -775,12 +790,12 @@ gtk_tree_view_column_clear_attributes_by_info (GtkTreeViewColumn *tree_column,
 {
   GSList *list;
 
-  list = info->attributes;
-
-  while (list && list->next)
+  for (list = info->attributes; list; list = list->next)
     {
-      g_free (list->data);
-      list = list->next->next;
+      GtkTreeViewColumnAttribute *attr = list->data;
+
+      g_free (attr->name);
+      g_slice_free (GtkTreeViewColumnAttribute, attr);
     }
   g_slist_free (info->attributes);
   info->attributes = NULL;
@@ -792,6 +807,55 @@ gtk_tree_view_column_clear_attributes_by_info (GtkTreeViewColumn *tree_column,
 /* Helper functions
  */
 
+/* Sets an attribute mapping on a cell renderer.  This is the same as
+ * g_object_set_property(), except that the property has already been
+ * looked up and that no notification is emitted for it: the property
+ * is set again for every row, and nobody is interested in hearing
+ * about that.
+ */
+static void
+gtk_tree_view_column_set_cell_attribute (GObject                    *cell,
+					 GtkTreeViewColumnAttribute *attr,
+					 GValue                     *value)
+{
+  GParamSpec *pspec = attr->pspec;
+  GParamSpec *redirect;
+  GObjectClass *class;
+  guint param_id;
+
+  if (G_UNLIKELY (pspec == NULL ||
+		  (pspec->flags & (G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY)) != G_PARAM_WRITABLE ||
+		  !g_value_type_compatible (G_VALUE_TYPE (value),
+					    G_PARAM_SPEC_VALUE_TYPE (pspec))))
+    {
+      /* Let GObject deal with transformations and warnings */
+      g_object_set_property (cell, attr->name, value);
+      return;
+    }
+
+  /* Overridden properties are set on the overriding class */
+  class = g_type_class_peek (pspec->owner_type);
+  param_id = pspec->param_id;
+
+  redirect = g_param_spec_get_redirect_target (pspec);
+  if (redirect)
+    pspec = redirect;
+
+  if (g_param_value_validate (pspec, value) &&
+      !(pspec->flags & G_PARAM_LAX_VALIDATION))
+    {
+      g_warning ("%s: value for property `%s' of type `%s' is invalid or out of range for property `%s' of type `%s'",
+		 G_STRLOC,
+		 attr->name,
+		 G_VALUE_TYPE_NAME (value),
+		 pspec->name,
+		 g_type_name (G_PARAM_SPEC_VALUE_TYPE (pspec)));
+      return;
+    }
+
+  class->set_property (cell, param_id, value, pspec);
+}
+
 /* Button handling code
  */
 static void
@@ -2566,8 +2630,6 @@ gtk_tree_view_column_cell_set_cell_data_with_hint (GtkTreeViewColumn   *tree_col
       GtkTreeViewColumnCellInfo *info = (GtkTreeViewColumnCellInfo *) cell_list->data;
       GObject *cell = (GObject *) info->cell;
 
-      list = info->attributes;
-
       g_object_freeze_notify (cell);
 
       if (info->cell->is_expander != is_expander)
@@ -2576,14 +2638,13 @@ gtk_tree_view_column_cell_set_cell_data_with_hint (GtkTreeViewColumn   *tree_col
       if (info->cell->is_expanded != is_expanded)
 	g_object_set (cell, "is-expanded", is_expanded, NULL);
 
-      while (list && list->next)
+      for (list = info->attributes; list; list = list->next)
 	{
-	  gtk_tree_model_get_value (tree_model, iter,
-				    GPOINTER_TO_INT (list->next->data),
-				    &value);
-	  g_object_set_property (cell, (gchar *) list->data, &value);
+	  GtkTreeViewColumnAttribute *attr = list->data;
+
+	  gtk_tree_model_get_value (tree_model, iter, attr->column, &value);
+	  gtk_tree_view_column_set_cell_attribute (cell, attr, &value);
 	  g_value_unset (&value);
-	  list = list->next->next;
 	}
 
       if (info->func)
@@ -2656,8 +2717,6 @@ gtk_tree_view_column_cell_set_cell_data (GtkTreeViewColumn *tree_column,
       GtkTreeViewColumnCellInfo *info = (GtkTreeViewColumnCellInfo *) cell_list->data;
       GObject *cell = (GObject *) info->cell;
 
-      list = info->attributes;
-
       g_object_freeze_notify (cell);
 
       if (info->cell->is_expander != is_expander)
@@ -2666,14 +2725,13 @@ gtk_tree_view_column_cell_set_cell_data (GtkTreeViewColumn *tree_column,
       if (info->cell->is_expanded != is_expanded)
 	g_object_set (cell, "is-expanded", is_expanded, NULL);
 
-      while (list && list->next)
+      for (list = info->attributes; list; list = list->next)
 	{
-	  gtk_tree_model_get_value (tree_model, iter,
-				    GPOINTER_TO_INT (list->next->data),
-				    &value);
-	  g_object_set_property (cell, (gchar *) list->data, &value);
+	  GtkTreeViewColumnAttribute *attr = list->data;
+
+	  gtk_tree_model_get_value (tree_model, iter, attr->column, &value);
+	  gtk_tree_view_column_set_cell_attribute (cell, attr, &value);
 	  g_value_unset (&value);
-	  list = list->next->next;
 	}
 
       if (info->func)
@@ -79,6 +79,7 @@ struct _Node {
   GList *uifiles;
 
   guint dirty : 1;
+  guint children_dirty : 1; /* some descendant is dirty */
   guint expand : 1;  /* used for separators */
   guint popup_accels : 1;
 };
@@ -124,6 +125,8 @@ static GtkAction * gtk_ui_manager_real_get_action (GtkUIManager      *manager,
                                                    const gchar       *path);
 static void        queue_update                   (GtkUIManager      *self);
 static void        dirty_all_nodes                (GtkUIManager      *self);
+static void        dirty_action_group_nodes       (GtkUIManager      *self,
+                                                   GtkActionGroup    *action_group);
 static void        mark_node_dirty                (GNode             *node);
 static GNode     * get_child_node                 (GtkUIManager      *self,
                                                    GNode             *parent,
@@ -733,8 +736,8 @@ gtk_ui_manager_insert_action_group (GtkUIManager   *self,
 		    "object-signal::post-activate", G_CALLBACK (cb_proxy_post_activate), self,
 		    NULL);
 
-  /* dirty all nodes, as action bindings may change */
-  dirty_all_nodes (self);
+  /* dirty the nodes whose action bindings may change */
+  dirty_action_group_nodes (self, action_group);
 
   g_signal_emit (self, ui_manager_signals[ACTIONS_CHANGED], 0);
 }
@@ -767,10 +770,10 @@ gtk_ui_manager_remove_action_group (GtkUIManager   *self,
                        "any-signal::pre-activate", G_CALLBACK (cb_proxy_pre_activate), self,
                        "any-signal::post-activate", G_CALLBACK (cb_proxy_post_activate), self, 
                        NULL);
-  g_object_unref (action_group);
 
-  /* dirty all nodes, as action bindings may change */
-  dirty_all_nodes (self);
+  /* dirty the nodes whose action bindings may change */
+  dirty_action_group_nodes (self, action_group);
+  g_object_unref (action_group);
 
   g_signal_emit (self, ui_manager_signals[ACTIONS_CHANGED], 0);
 }
@@ -2230,7 +2233,7 @@ update_node (GtkUIManager *self,
 
   info = NODE_INFO (node);
   
-  if (!info->dirty)
+  if (!info->dirty && !info->children_dirty)
     return;
 
   if (info->type == NODE_TYPE_POPUP)
@@ -2239,6 +2242,10 @@ update_node (GtkUIManager *self,
       popup_accels = info->popup_accels;
     }
 
+  /* Only the subtree has changed, leave the node itself alone */
+  if (!info->dirty)
+    goto recurse_children;
+
 #ifdef DEBUG_UI_MANAGER
   g_print ("update_node name=%s dirty=%d popup %d (", 
 	   info->name, info->dirty, in_popup);
@@ -2726,6 +2733,7 @@ update_node (GtkUIManager *self,
 
  recurse_children:
   /* process children */
+  info->children_dirty = FALSE;
   child = node->children;
   while (child)
     {
@@ -2851,14 +2859,48 @@ dirty_all_nodes (GtkUIManager *self)
   queue_update (self);
 }
 
+static gboolean
+dirty_action_group_traverse_func (GNode   *node,
+				  gpointer data)
+{
+  GtkActionGroup *action_group = data;
+  Node *info = NODE_INFO (node);
+  NodeUIReference *ref;
+
+  if (info->uifiles == NULL)
+    return FALSE;
+
+  ref = info->uifiles->data;
+  if (gtk_action_group_get_action (action_group,
+				   g_quark_to_string (ref->action_quark)))
+    mark_node_dirty (node);
+
+  return FALSE;
+}
+
+/* Only nodes referring to an action of @action_group can have
+ * their action binding changed by adding or removing the group.
+ */
+static void
+dirty_action_group_nodes (GtkUIManager   *self,
+			  GtkActionGroup *action_group)
+{
+  g_node_traverse (self->private_data->root_node,
+		   G_PRE_ORDER, G_TRAVERSE_ALL, -1,
+		   dirty_action_group_traverse_func, action_group);
+  queue_update (self);
+}
+
 static void
 mark_node_dirty (GNode *node)
 {
   GNode *p;
 
-  /* FIXME could optimize this */
-  for (p = node; p; p = p->parent)
-    NODE_INFO (p)->dirty = TRUE;  
+  NODE_INFO (node)->dirty = TRUE;
+
+  /* Ancestors only need to be visited, not updated */
+  for (p = node->parent; p; p = p->parent)
+    NODE_INFO (p)->children_dirty = TRUE;
 }
 
 static const gchar *
@@ -24,6 +24,7 @@
 #include <locale.h>
 #include <math.h>
 
+#include <glib/gstdio.h>
 #include <gtk/gtk.h>
 #include <gdk/gdkkeysyms.h>
 
@@ -2282,6 +2283,302 @@ test_add_objects (void)
   g_object_unref (builder);
 }
 
+static gboolean
+compile_file (const gchar *filename)
+{
+  gchar *argv[] = { GTK_BUILDER_COMPILE, "--quiet", NULL, NULL };
+  gint status;
+
+  argv[2] = (gchar *) filename;
+
+  if (!g_spawn_sync (NULL, argv, NULL, 0, NULL, NULL,
+                     NULL, NULL, &status, NULL))
+    return FALSE;
+
+  return status == 0;
+}
+
+static void
+test_compiled (void)
+{
+  const gchar buffer1[] =
+    "<interface>"
+    "  <object class=\"GtkWindow\" id=\"window1\">"
+    "    <property name=\"title\">Compiled</property>"
+    "    <child>"
+    "      <object class=\"GtkLabel\" id=\"label1\">"
+    "        <property name=\"label\">&lt;b&gt;bold &amp; escaped&lt;/b&gt;</property>"
+    "      </object>"
+    "    </child>"
+    "  </object>"
+    "</interface>";
+  const gchar buffer2[] =
+    "<interface>"
+    "  <object class=\"GtkWindow\" id=\"window1\">"
+    "    <property name=\"title\">Edited after compiling</property>"
+    "  </object>"
+    "</interface>";
+  GtkBuilder *builder;
+  GObject *window, *label;
+  gchar *filename, *compiled;
+  GError *error = NULL;
+
+  filename = g_build_filename (g_get_tmp_dir (), "gtkbuilder-compiled.ui", NULL);
+  compiled = g_strconcat (filename, "c", NULL);
+
+  g_file_set_contents (filename, buffer1, -1, NULL);
+  g_assert (compile_file (filename));
+  g_assert (g_file_test (compiled, G_FILE_TEST_EXISTS));
+
+  builder = gtk_builder_new ();
+  gtk_builder_add_from_file (builder, filename, &error);
+  g_assert (error == NULL);
+
+  window = gtk_builder_get_object (builder, "window1");
+  g_assert (GTK_IS_WINDOW (window));
+  g_assert_cmpstr (gtk_window_get_title (GTK_WINDOW (window)), ==, "Compiled");
+  label = gtk_builder_get_object (builder, "label1");
+  g_assert (GTK_IS_LABEL (label));
+  g_assert_cmpstr (gtk_label_get_label (GTK_LABEL (label)), ==, "<b>bold & escaped</b>");
+
+  gtk_widget_destroy (GTK_WIDGET (window));
+  g_object_unref (builder);
+
+  /* A stale compiled file must be ignored */
+  g_file_set_contents (filename, buffer2, -1, NULL);
+
+  builder = gtk_builder_new ();
+  gtk_builder_add_from_file (builder, filename, &error);
+  g_assert (error == NULL);
+
+  window = gtk_builder_get_object (builder, "window1");
+  g_assert (GTK_IS_WINDOW (window));
+  g_assert_cmpstr (gtk_window_get_title (GTK_WINDOW (window)), ==, "Edited after compiling");
+  g_assert (gtk_builder_get_object (builder, "label1") == NULL);
+
+  gtk_widget_destroy (GTK_WIDGET (window));
+  g_object_unref (builder);
+
+  g_unlink (compiled);
+  g_unlink (filename);
+  g_free (compiled);
+  g_free (filename);
+}
+
+#define N_PERF_OBJECTS 2000
+
+static gdouble
+time_add_from_file (const gchar *filename)
+{
+  GtkBuilder *builder;
+  GSList *objects, *l;
+  gdouble elapsed;
+
+  builder = gtk_builder_new ();
+
+  g_test_timer_start ();
+  gtk_builder_add_from_file (builder, filename, NULL);
+  elapsed = g_test_timer_elapsed ();
+
+  objects = gtk_builder_get_objects (builder);
+  for (l = objects; l; l = l->next)
+    if (GTK_IS_WINDOW (l->data))
+      gtk_widget_destroy (l->data);
+  g_slist_free (objects);
+  g_object_unref (builder);
+
+  return elapsed;
+}
+
+static void
+test_compiled_perf (void)
+{
+  GString *buffer;
+  gchar *filename, *compiled;
+  gdouble xml, binary;
+  gint i;
+
+  buffer = g_string_new ("<interface>\n"
+                         "  <object class=\"GtkWindow\" id=\"window\">\n"
+                         "    <child>\n"
+                         "      <object class=\"GtkVBox\" id=\"vbox\">\n");
+  for (i = 0; i < N_PERF_OBJECTS; i++)
+    g_string_append_printf (buffer,
+                            "        <child>\n"
+                            "          <object class=\"GtkLabel\" id=\"label%d\">\n"
+                            "            <property name=\"label\">Label &lt;%d&gt;</property>\n"
+                            "            <property name=\"use-markup\">False</property>\n"
+                            "            <property name=\"xalign\">0</property>\n"
+                            "          </object>\n"
+                            "          <packing>\n"
+                            "            <property name=\"expand\">False</property>\n"
+                            "          </packing>\n"
+                            "        </child>\n", i, i);
+  g_string_append (buffer,
+                   "      </object>\n"
+                   "    </child>\n"
+                   "  </object>\n"
+                   "</interface>\n");
+
+  filename = g_build_filename (g_get_tmp_dir (), "gtkbuilder-perf.ui", NULL);
+  compiled = g_strconcat (filename, "c", NULL);
+  g_file_set_contents (filename, buffer->str, buffer->len, NULL);
+  g_unlink (compiled);
+
+  xml = time_add_from_file (filename);
+  g_assert (compile_file (filename));
+  binary = time_add_from_file (filename);
+
+  g_test_message ("%d labels: XML %.2f ms, compiled %.2f ms",
+                  N_PERF_OBJECTS, xml * 1000, binary * 1000);
+  g_test_minimized_result (binary, "compiled UI definition: %.2f ms",
+                           binary * 1000);
+
+  g_unlink (compiled);
+  g_unlink (filename);
+  g_free (compiled);
+  g_free (filename);
+  g_string_free (buffer, TRUE);
+}
+
+static gint deferred = 0;
+
+void // exported for GtkBuilder
+signal_deferred (GtkWindow *window, GParamSpec spec)
+{
+  g_assert (GTK_IS_WINDOW (window));
+
+  deferred++;
+}
+
+static void
+test_deferred (void)
+{
+  GtkBuilder *builder;
+  GObject *window, *label, *entry, *mnemonic;
+  GSList *objects;
+  const gchar buffer[] =
+    "<interface>"
+    "  <object class=\"GtkWindow\" id=\"window1\" deferred=\"True\">"
+    "    <property name=\"title\">Deferred</property>"
+    "    <signal name=\"notify::title\" handler=\"signal_deferred\"/>"
+    "    <child>"
+    "      <object class=\"GtkLabel\" id=\"label1\">"
+    "        <property name=\"label\">&lt;deferred&gt;</property>"
+    "      </object>"
+    "    </child>"
+    "  </object>"
+    "  <object class=\"GtkWindow\" id=\"window2\" deferred=\"True\">"
+    "    <child>"
+    "      <object class=\"GtkEntry\" id=\"entry1\"/>"
+    "    </child>"
+    "  </object>"
+    "  <object class=\"GtkWindow\" id=\"window3\" deferred=\"True\"/>"
+    "  <object class=\"GtkLabel\" id=\"mnemonic\">"
+    "    <property name=\"mnemonic-widget\">entry1</property>"
+    "  </object>"
+    "</interface>";
+
+  builder = builder_new_from_string (buffer, -1, NULL);
+
+  /* entry1 is referenced by another object, which builds window2 */
+  objects = gtk_builder_get_objects (builder);
+  g_assert_cmpint (g_slist_length (objects), ==, 3);
+  g_slist_free (objects);
+
+  mnemonic = gtk_builder_get_object (builder, "mnemonic");
+  entry = gtk_builder_get_object (builder, "entry1");
+  g_assert (GTK_IS_ENTRY (entry));
+  g_assert (gtk_label_get_mnemonic_widget (GTK_LABEL (mnemonic)) == GTK_WIDGET (entry));
+
+  gtk_builder_connect_signals (builder, NULL);
+
+  /* Asking for an object inside a deferred one builds all of it */
+  label = gtk_builder_get_object (builder, "label1");
+  g_assert (GTK_IS_LABEL (label));
+  g_assert_cmpstr (gtk_label_get_label (GTK_LABEL (label)), ==, "<deferred>");
+  window = gtk_builder_get_object (builder, "window1");
+  g_assert (GTK_IS_WINDOW (window));
+  g_assert (gtk_widget_get_parent (GTK_WIDGET (label)) == GTK_WIDGET (window));
+  g_assert_cmpstr (gtk_window_get_title (GTK_WINDOW (window)), ==, "Deferred");
+
+  objects = gtk_builder_get_objects (builder);
+  g_assert_cmpint (g_slist_length (objects), ==, 5);
+  g_slist_free (objects);
+
+  /* Signals of deferred objects are connected when they are built */
+  gtk_window_set_title (GTK_WINDOW (window), "test");
+  g_assert_cmpint (deferred, ==, 1);
+
+  gtk_widget_destroy (GTK_WIDGET (window));
+  gtk_widget_destroy (gtk_widget_get_toplevel (GTK_WIDGET (entry)));
+  gtk_widget_destroy (GTK_WIDGET (mnemonic));
+
+  /* window3 is never built */
+  g_object_unref (builder);
+}
+
+static void
+test_deferred_duplicate (void)
+{
+  GtkBuilder *builder;
+  GError *error = NULL;
+  const gchar buffer1[] =
+    "<interface>"
+    "  <object class=\"GtkWindow\" id=\"window1\" deferred=\"True\"/>"
+    "  <object class=\"GtkWindow\" id=\"window1\" deferred=\"True\"/>"
+    "</interface>";
+  const gchar buffer2[] =
+    "<interface>"
+    "  <object class=\"GtkWindow\" id=\"window1\" deferred=\"True\">"
+    "    <child>"
+    "      <object class=\"GtkLabel\" id=\"window1\"/>"
+    "    </child>"
+    "  </object>"
+    "</interface>";
+  const gchar buffer3[] =
+    "<interface>"
+    "  <object class=\"GtkWindow\" id=\"window2\" deferred=\"True\">"
+    "    <child>"
+    "      <object class=\"GtkLabel\" id=\"label1\"/>"
+    "    </child>"
+    "  </object>"
+    "</interface>";
+  const gchar buffer4[] =
+    "<interface>"
+    "  <object class=\"GtkWindow\" id=\"label1\" deferred=\"True\"/>"
+    "</interface>";
+
+  /* Two deferred objects with the same id */
+  builder = gtk_builder_new ();
+  gtk_builder_add_from_string (builder, buffer1, -1, &error);
+  g_assert (error != NULL);
+  g_assert (error->domain == GTK_BUILDER_ERROR);
+  g_assert (error->code == GTK_BUILDER_ERROR_INVALID_VALUE);
+  g_error_free (error);
+  error = NULL;
+  g_object_unref (builder);
+
+  /* An id used twice inside one deferred object */
+  builder = gtk_builder_new ();
+  gtk_builder_add_from_string (builder, buffer2, -1, &error);
+  g_assert (error != NULL);
+  g_assert (error->code == GTK_BUILDER_ERROR_INVALID_VALUE);
+  g_error_free (error);
+  error = NULL;
+  g_object_unref (builder);
+
+  /* An id that an earlier definition deferred already */
+  builder = gtk_builder_new ();
+  gtk_builder_add_from_string (builder, buffer3, -1, &error);
+  g_assert (error == NULL);
+  gtk_builder_add_from_string (builder, buffer4, -1, &error);
+  g_assert (error != NULL);
+  g_assert (error->code == GTK_BUILDER_ERROR_INVALID_VALUE);
+  g_error_free (error);
+  g_object_unref (builder);
+}
+
 static void 
 test_file (const gchar *filename)
 {
@@ -2367,6 +2664,12 @@ main (int argc, char **argv)
   g_test_add_func ("/Builder/PangoAttributes", test_pango_attributes);
   g_test_add_func ("/Builder/Requires", test_requires);
   g_test_add_func ("/Builder/AddObjects", test_add_objects);
+  g_test_add_func ("/Builder/Compiled", test_compiled);
+  g_test_add_func ("/Builder/Deferred", test_deferred);
+  g_test_add_func ("/Builder/Deferred Duplicate", test_deferred_duplicate);
+
+  if (g_test_perf ())
+    g_test_add_func ("/Builder/Compiled Performance", test_compiled_perf);
 
   return g_test_run();
 }
@@ -0,0 +1,100 @@
+/* GtkComboBox tests.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <gtk/gtk.h>
+
+#define ROW_LIMIT 5
+
+static void
+append_rows (GtkListStore *store,
+             gint          n_rows)
+{
+  GtkTreeIter iter;
+  gint i;
+
+  for (i = 0; i < n_rows; i++)
+    gtk_list_store_insert_with_values (store, &iter, -1, 0, "row", -1);
+}
+
+/* In menu mode the popup is a menu attached to the combo box */
+static gboolean
+appears_as_menu (GtkWidget *combo)
+{
+  return gtk_menu_get_for_attach_widget (combo) != NULL;
+}
+
+/* A combo box pops up a menu as long as its model has at most
+ * menu-row-limit rows, and a list once it has more.
+ */
+static void
+test_menu_row_limit (void)
+{
+  GtkWidget *window, *combo;
+  GtkListStore *store;
+  GtkCellRenderer *cell;
+  GtkTreeIter iter;
+
+  store = gtk_list_store_new (1, G_TYPE_STRING);
+  append_rows (store, ROW_LIMIT);
+
+  window = gtk_window_new (GTK_WINDOW_TOPLEVEL);
+  combo = gtk_combo_box_new_with_model (GTK_TREE_MODEL (store));
+  cell = gtk_cell_renderer_text_new ();
+  gtk_cell_layout_pack_start (GTK_CELL_LAYOUT (combo), cell, TRUE);
+  gtk_cell_layout_set_attributes (GTK_CELL_LAYOUT (combo), cell,
+                                  "text", 0, NULL);
+  gtk_container_add (GTK_CONTAINER (window), combo);
+  gtk_widget_ensure_style (combo);
+
+  /* At the limit */
+  g_assert (appears_as_menu (combo));
+
+  /* Growing past the limit */
+  append_rows (store, 1);
+  g_assert (!appears_as_menu (combo));
+
+  /* Shrinking back to the limit */
+  gtk_tree_model_get_iter_first (GTK_TREE_MODEL (store), &iter);
+  gtk_list_store_remove (store, &iter);
+  g_assert (appears_as_menu (combo));
+
+  /* Setting a model over the limit */
+  gtk_combo_box_set_model (GTK_COMBO_BOX (combo), NULL);
+  append_rows (store, 1);
+  gtk_combo_box_set_model (GTK_COMBO_BOX (combo), GTK_TREE_MODEL (store));
+  g_assert (!appears_as_menu (combo));
+
+  gtk_widget_destroy (window);
+  g_object_unref (store);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  gtk_test_init (&argc, &argv);
+
+  gtk_rc_parse_string ("style \"row-limit\" {\n"
+                       "  GtkComboBox::menu-row-limit = " G_STRINGIFY (ROW_LIMIT) "\n"
+                       "}\n"
+                       "class \"GtkComboBox\" style \"row-limit\"\n");
+
+  g_test_add_func ("/combobox/menu-row-limit", test_menu_row_limit);
+
+  return g_test_run ();
+}
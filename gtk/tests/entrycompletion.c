@@ -0,0 +1,210 @@
+/* GtkEntryCompletion tests.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <gtk/gtk.h>
+
+static gchar *last_prefix = NULL;
+
+static gboolean
+insert_prefix (GtkEntryCompletion *completion,
+	       const gchar        *prefix,
+	       gpointer            data)
+{
+  g_free (last_prefix);
+  last_prefix = g_strdup (prefix);
+
+  /* don't touch the entry */
+  return TRUE;
+}
+
+/* Completes @text and returns the common prefix of the matches */
+static const gchar *
+complete (GtkEntryCompletion *completion,
+	  const gchar        *text)
+{
+  g_free (last_prefix);
+  last_prefix = NULL;
+
+  gtk_entry_set_text (GTK_ENTRY (gtk_entry_completion_get_entry (completion)),
+		      text);
+  gtk_entry_completion_complete (completion);
+  gtk_entry_completion_insert_prefix (completion);
+
+  return last_prefix;
+}
+
+static void
+test_narrowing (void)
+{
+  GtkWidget *entry;
+  GtkEntryCompletion *completion;
+  GtkListStore *store;
+  GtkTreeIter iter, apricot, applet, apple;
+
+  store = gtk_list_store_new (1, G_TYPE_STRING);
+  gtk_list_store_insert_with_values (store, &apple, -1, 0, "apple", -1);
+  gtk_list_store_insert_with_values (store, &iter, -1, 0, "applesauce", -1);
+  gtk_list_store_insert_with_values (store, &apricot, -1, 0, "apricot", -1);
+  gtk_list_store_insert_with_values (store, &iter, -1, 0, "banana", -1);
+
+  entry = gtk_entry_new ();
+  completion = gtk_entry_completion_new ();
+  gtk_entry_completion_set_model (completion, GTK_TREE_MODEL (store));
+  gtk_entry_completion_set_text_column (completion, 0);
+  gtk_entry_set_completion (GTK_ENTRY (entry), completion);
+  g_signal_connect (completion, "insert-prefix",
+		    G_CALLBACK (insert_prefix), NULL);
+
+  g_assert_cmpstr (complete (completion, "ap"), ==, "ap");
+  g_assert_cmpstr (complete (completion, "app"), ==, "apple");
+
+  /* Rows added or changed between keystrokes are matched */
+  gtk_list_store_insert_with_values (store, &iter, -1, 0, "appliance", -1);
+  g_assert_cmpstr (complete (completion, "appl"), ==, "appl");
+
+  gtk_list_store_set (store, &apricot, 0, "applet", -1);
+  applet = apricot;
+  g_assert_cmpstr (complete (completion, "apple"), ==, "apple");
+
+  /* ... and deleted ones are not */
+  gtk_list_store_remove (store, &applet);
+  gtk_list_store_remove (store, &apple);
+  g_assert_cmpstr (complete (completion, "apples"), ==, "applesauce");
+
+  /* Shortening the key brings back rows rejected before */
+  g_assert_cmpstr (complete (completion, "b"), ==, "banana");
+  g_assert_cmpstr (complete (completion, "a"), ==, "appl");
+
+  gtk_widget_destroy (entry);
+  g_object_unref (completion);
+  g_object_unref (store);
+}
+
+static void
+test_changed_rows (void)
+{
+  GtkWidget *entry;
+  GtkEntryCompletion *completion;
+  GtkListStore *store;
+  GtkTreeIter iter;
+  gint i;
+
+  store = gtk_list_store_new (1, G_TYPE_STRING);
+  gtk_list_store_insert_with_values (store, &iter, -1, 0, "cherry", -1);
+  gtk_list_store_insert_with_values (store, &iter, -1, 0, "date", -1);
+
+  entry = gtk_entry_new ();
+  completion = gtk_entry_completion_new ();
+  gtk_entry_completion_set_model (completion, GTK_TREE_MODEL (store));
+  gtk_entry_completion_set_text_column (completion, 0);
+  gtk_entry_set_completion (GTK_ENTRY (entry), completion);
+  g_signal_connect (completion, "insert-prefix",
+		    G_CALLBACK (insert_prefix), NULL);
+
+  g_assert_cmpstr (complete (completion, "ch"), ==, "cherry");
+
+  /* Change the row through an iter whose unused fields differ from
+   * the ones the completion has seen.
+   */
+  for (i = 0; i < 3; i++)
+    {
+      gchar *text = g_strdup_printf ("elderberry%d", i);
+
+      iter.user_data2 = GINT_TO_POINTER (0xdead + i);
+      iter.user_data3 = GINT_TO_POINTER (0xbeef + i);
+      gtk_tree_model_get_iter_first (GTK_TREE_MODEL (store), &iter);
+      gtk_list_store_set (store, &iter, 0, text, -1);
+
+      g_assert (complete (completion, "ch") == NULL);
+      g_assert_cmpstr (complete (completion, "el"), ==, text);
+      g_free (text);
+    }
+
+  /* A row taking the place of a deleted one gets its own text */
+  gtk_tree_model_get_iter_first (GTK_TREE_MODEL (store), &iter);
+  gtk_list_store_remove (store, &iter);
+  gtk_list_store_insert_with_values (store, &iter, 0, 0, "fig", -1);
+  g_assert (complete (completion, "el") == NULL);
+  g_assert_cmpstr (complete (completion, "f"), ==, "fig");
+  g_assert_cmpstr (complete (completion, "d"), ==, "date");
+
+  gtk_widget_destroy (entry);
+  g_object_unref (completion);
+  g_object_unref (store);
+}
+
+#define N_ROWS 100000
+
+static void
+test_completion_perf (void)
+{
+  GtkWidget *entry;
+  GtkEntryCompletion *completion;
+  GtkListStore *store;
+  GtkTreeIter iter;
+  const gchar *keys[] = { "c", "co", "con", "cont", "conta", "contac", "contact" };
+  gdouble elapsed;
+  guint i;
+
+  store = gtk_list_store_new (1, G_TYPE_STRING);
+  for (i = 0; i < N_ROWS; i++)
+    {
+      gchar *text = g_strdup_printf ("contact%u@example.com", i);
+
+      gtk_list_store_insert_with_values (store, &iter, -1, 0, text, -1);
+      g_free (text);
+    }
+
+  entry = gtk_entry_new ();
+  completion = gtk_entry_completion_new ();
+  gtk_entry_completion_set_model (completion, GTK_TREE_MODEL (store));
+  gtk_entry_completion_set_text_column (completion, 0);
+  gtk_entry_set_completion (GTK_ENTRY (entry), completion);
+
+  g_test_timer_start ();
+
+  for (i = 0; i < G_N_ELEMENTS (keys); i++)
+    {
+      gtk_entry_set_text (GTK_ENTRY (entry), keys[i]);
+      gtk_entry_completion_complete (completion);
+    }
+
+  elapsed = g_test_timer_elapsed ();
+  g_test_minimized_result (elapsed * 1000 / G_N_ELEMENTS (keys),
+			   "completing %d rows: %.2f msec per keystroke",
+			   N_ROWS, elapsed * 1000 / G_N_ELEMENTS (keys));
+
+  gtk_widget_destroy (entry);
+  g_object_unref (completion);
+  g_object_unref (store);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/entry-completion/narrowing", test_narrowing);
+  g_test_add_func ("/entry-completion/changed-rows", test_changed_rows);
+
+  if (g_test_perf ())
+    g_test_add_func ("/entry-completion/perf", test_completion_perf);
+
+  return g_test_run ();
+}
@@ -0,0 +1,89 @@
+/* GtkLabel tests.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <gtk/gtk.h>
+
+#define LONG_TEXT \
+  "A label with a text that is much too long to fit into the width " \
+  "that it is allocated, so it has to be shortened with an ellipsis."
+
+static void
+request_allocate (GtkWidget *widget,
+                  gint       width)
+{
+  GtkRequisition requisition;
+  GtkAllocation allocation;
+
+  gtk_widget_queue_resize (widget);
+  gtk_widget_size_request (widget, &requisition);
+
+  allocation.x = 0;
+  allocation.y = 0;
+  allocation.width = width;
+  allocation.height = requisition.height;
+  gtk_widget_size_allocate (widget, &allocation);
+}
+
+/* A wrapping label that also ellipsizes keeps the width of its
+ * allocation across size requests, and no wrap width is chosen
+ * for it.
+ */
+static void
+test_wrap_ellipsize (void)
+{
+  GtkWidget *window, *label;
+  PangoLayout *layout;
+  gint i;
+
+  window = gtk_window_new (GTK_WINDOW_TOPLEVEL);
+  label = gtk_label_new (LONG_TEXT);
+  gtk_container_add (GTK_CONTAINER (window), label);
+
+  gtk_label_set_line_wrap (GTK_LABEL (label), TRUE);
+  gtk_label_set_ellipsize (GTK_LABEL (label), PANGO_ELLIPSIZE_END);
+
+  for (i = 0; i < 3; i++)
+    {
+      request_allocate (label, 100);
+      request_allocate (label, 100);
+
+      layout = gtk_label_get_layout (GTK_LABEL (label));
+      g_assert_cmpint (pango_layout_get_width (layout), ==, 100 * PANGO_SCALE);
+      g_assert (pango_layout_is_ellipsized (layout));
+    }
+
+  /* Without ellipsizing, the label wraps again */
+  gtk_label_set_ellipsize (GTK_LABEL (label), PANGO_ELLIPSIZE_NONE);
+  request_allocate (label, 100);
+
+  layout = gtk_label_get_layout (GTK_LABEL (label));
+  g_assert (!pango_layout_is_ellipsized (layout));
+
+  gtk_widget_destroy (window);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  gtk_test_init (&argc, &argv);
+
+  g_test_add_func ("/label/wrap-ellipsize", test_wrap_ellipsize);
+
+  return g_test_run ();
+}
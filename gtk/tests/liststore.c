@@ -850,6 +850,165 @@ list_store_test_move_before_single (void)
   g_object_unref (store);
 }
 
+/* column storage */
+
+static void
+list_store_test_set_sparse (void)
+{
+  GtkListStore *store;
+  GtkTreeIter iter;
+  gchar *str = NULL;
+  gint value = -1;
+  gdouble d = -1.0;
+
+  store = gtk_list_store_new (3, G_TYPE_INT, G_TYPE_DOUBLE, G_TYPE_STRING);
+
+  /* Setting only the last column must leave the others at their
+   * default values.
+   */
+  gtk_list_store_append (store, &iter);
+  gtk_list_store_set (store, &iter, 2, "last", -1);
+
+  gtk_tree_model_get (GTK_TREE_MODEL (store), &iter,
+                      0, &value, 1, &d, 2, &str, -1);
+  g_assert_cmpint (value, ==, 0);
+  g_assert_cmpfloat (d, ==, 0.0);
+  g_assert_cmpstr (str, ==, "last");
+  g_free (str);
+
+  gtk_list_store_set (store, &iter, 0, 42, 2, "again", -1);
+
+  gtk_tree_model_get (GTK_TREE_MODEL (store), &iter,
+                      0, &value, 2, &str, -1);
+  g_assert_cmpint (value, ==, 42);
+  g_assert_cmpstr (str, ==, "again");
+  g_free (str);
+
+  /* A row that was never set reads back as defaults */
+  gtk_list_store_append (store, &iter);
+  gtk_tree_model_get (GTK_TREE_MODEL (store), &iter, 2, &str, -1);
+  g_assert (str == NULL);
+
+  g_object_unref (store);
+}
+
+#define PERF_N_ROWS    50000
+#define PERF_N_COLUMNS 8
+
+static void
+list_store_test_columns_perf (void)
+{
+  GtkListStore *store;
+  GType types[PERF_N_COLUMNS];
+  GtkTreeIter iter;
+  gboolean valid;
+  gdouble elapsed;
+  gint i;
+
+  for (i = 0; i < PERF_N_COLUMNS; i++)
+    types[i] = G_TYPE_INT;
+
+  store = gtk_list_store_newv (PERF_N_COLUMNS, types);
+
+  g_test_timer_start ();
+  for (i = 0; i < PERF_N_ROWS; i++)
+    {
+      gint j;
+
+      gtk_list_store_append (store, &iter);
+      for (j = PERF_N_COLUMNS - 1; j >= 0; j--)
+        gtk_list_store_set (store, &iter, j, g_test_rand_int (), -1);
+    }
+  elapsed = g_test_timer_elapsed ();
+  g_test_minimized_result (elapsed * 1000000 / PERF_N_ROWS,
+                           "fill %d columns: %.2f usec per row",
+                           PERF_N_COLUMNS, elapsed * 1000000 / PERF_N_ROWS);
+
+  g_test_timer_start ();
+  valid = gtk_tree_model_get_iter_first (GTK_TREE_MODEL (store), &iter);
+  while (valid)
+    {
+      gint value;
+
+      gtk_tree_model_get (GTK_TREE_MODEL (store), &iter,
+                          PERF_N_COLUMNS - 1, &value, -1);
+      valid = gtk_tree_model_iter_next (GTK_TREE_MODEL (store), &iter);
+    }
+  elapsed = g_test_timer_elapsed ();
+  g_test_minimized_result (elapsed * 1000000 / PERF_N_ROWS,
+                           "get last column: %.2f usec per row",
+                           elapsed * 1000000 / PERF_N_ROWS);
+
+  g_test_timer_start ();
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (store),
+                                        PERF_N_COLUMNS - 1,
+                                        GTK_SORT_ASCENDING);
+  elapsed = g_test_timer_elapsed ();
+  g_test_minimized_result (elapsed,
+                           "sort on last column: %.3f sec", elapsed);
+
+  g_object_unref (store);
+}
+
+static gboolean
+column_is_collated (GtkTreeModel *model,
+                    gint          column)
+{
+  GtkTreeIter iter;
+  gchar *prev = NULL;
+  gboolean sorted = TRUE;
+  gboolean valid;
+
+  valid = gtk_tree_model_get_iter_first (model, &iter);
+  while (valid)
+    {
+      gchar *str;
+
+      gtk_tree_model_get (model, &iter, column, &str, -1);
+      if (str == NULL)
+        str = g_strdup ("");
+      if (prev && g_utf8_collate (prev, str) > 0)
+        sorted = FALSE;
+      g_free (prev);
+      prev = str;
+
+      valid = gtk_tree_model_iter_next (model, &iter);
+    }
+  g_free (prev);
+
+  return sorted;
+}
+
+static void
+list_store_test_sort_collate (void)
+{
+  static const gchar *names[] = {
+    "\303\251clair", "zebra", "Apple", "eclair", "apple", "\303\204rger", "banana"
+  };
+  GtkListStore *store;
+  GtkTreeIter iter;
+  GtkTreeIter first;
+  gint i;
+
+  store = gtk_list_store_new (2, G_TYPE_STRING, G_TYPE_INT);
+  for (i = 0; i < G_N_ELEMENTS (names); i++)
+    gtk_list_store_insert_with_values (store, NULL, -1, 0, names[i], 1, i, -1);
+
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (store), 0,
+                                        GTK_SORT_ASCENDING);
+  g_assert (column_is_collated (GTK_TREE_MODEL (store), 0));
+
+  /* Changing a sorted value must not reuse its stale collation key */
+  g_assert (gtk_tree_model_get_iter_first (GTK_TREE_MODEL (store), &first));
+  gtk_list_store_set (store, &first, 0, "zzz", -1);
+  g_assert (column_is_collated (GTK_TREE_MODEL (store), 0));
+
+  gtk_list_store_append (store, &iter);
+  g_assert (column_is_collated (GTK_TREE_MODEL (store), 0));
+
+  g_object_unref (store);
+}
+
 /* main */
 
 int
@@ -958,5 +1117,15 @@ main (int    argc,
   g_test_add_func ("/list-store/move-before-single",
 		   list_store_test_move_before_single);
 
+  /* column storage */
+  g_test_add_func ("/list-store/set-sparse",
+		   list_store_test_set_sparse);
+  g_test_add_func ("/list-store/sort-collate",
+		   list_store_test_sort_collate);
+
+  if (g_test_perf ())
+    g_test_add_func ("/list-store/columns-perf",
+		     list_store_test_columns_perf);
+
   return g_test_run ();
 }
@@ -0,0 +1,120 @@
+/* GtkPrintOperation tests.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <gtk/gtk.h>
+#include <glib/gstdio.h>
+
+#define N_PAGES 20
+
+typedef struct
+{
+  GThread *main_thread;
+  GArray *pages;
+  gboolean in_main_thread;
+  gboolean in_other_thread;
+} DrawData;
+
+static void
+draw_page (GtkPrintOperation *op,
+           GtkPrintContext   *context,
+           gint               page_nr,
+           DrawData          *data)
+{
+  cairo_t *cr;
+
+  cr = gtk_print_context_get_cairo_context (context);
+  cairo_rectangle (cr, 10, 10, 100, 100);
+  cairo_fill (cr);
+
+  g_array_append_val (data->pages, page_nr);
+
+  if (g_thread_self () == data->main_thread)
+    data->in_main_thread = TRUE;
+  else
+    data->in_other_thread = TRUE;
+}
+
+static void
+export_pages (gboolean render_in_thread)
+{
+  GtkPrintOperation *op;
+  GtkPrintOperationResult result;
+  GError *error = NULL;
+  DrawData data;
+  gchar *filename;
+  gint i;
+
+  data.main_thread = g_thread_self ();
+  data.pages = g_array_new (FALSE, FALSE, sizeof (gint));
+  data.in_main_thread = FALSE;
+  data.in_other_thread = FALSE;
+
+  filename = g_build_filename (g_get_tmp_dir (), "gtk-test-printoperation.pdf", NULL);
+
+  op = gtk_print_operation_new ();
+  gtk_print_operation_set_n_pages (op, N_PAGES);
+  gtk_print_operation_set_export_filename (op, filename);
+  gtk_print_operation_set_render_in_thread (op, render_in_thread);
+  g_signal_connect (op, "draw-page", G_CALLBACK (draw_page), &data);
+
+  result = gtk_print_operation_run (op, GTK_PRINT_OPERATION_ACTION_EXPORT,
+                                    NULL, &error);
+  g_assert (error == NULL);
+  g_assert_cmpint (result, ==, GTK_PRINT_OPERATION_RESULT_APPLY);
+  g_assert (gtk_print_operation_is_finished (op));
+
+  /* The pages are rendered in order either way */
+  g_assert_cmpint (data.pages->len, ==, N_PAGES);
+  for (i = 0; i < N_PAGES; i++)
+    g_assert_cmpint (g_array_index (data.pages, gint, i), ==, i);
+
+  g_assert (data.in_main_thread == !render_in_thread);
+  g_assert (data.in_other_thread == render_in_thread);
+
+  g_assert (g_file_test (filename, G_FILE_TEST_IS_REGULAR));
+
+  g_unlink (filename);
+  g_free (filename);
+  g_array_free (data.pages, TRUE);
+  g_object_unref (op);
+}
+
+static void
+test_render_in_main_thread (void)
+{
+  export_pages (FALSE);
+}
+
+static void
+test_render_in_thread (void)
+{
+  export_pages (TRUE);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  g_thread_init (NULL);
+  gtk_test_init (&argc, &argv);
+
+  g_test_add_func ("/printoperation/render-in-main-thread", test_render_in_main_thread);
+  g_test_add_func ("/printoperation/render-in-thread", test_render_in_thread);
+
+  return g_test_run ();
+}
@@ -1284,6 +1284,581 @@ test_tag (void)
   g_object_unref (buffer);
 }
 
+static void
+count_apply_tag (GtkTextBuffer     *buffer,
+                 GtkTextTag        *tag,
+                 const GtkTextIter *start,
+                 const GtkTextIter *end,
+                 gint              *count)
+{
+  (*count)++;
+}
+
+static void
+check_same_tags (GtkTextBuffer *buffer,
+                 GtkTextBuffer *expected,
+                 GtkTextTag   **tags,
+                 GtkTextTag   **expected_tags,
+                 gint           n_tags)
+{
+  GtkTextIter iter, expected_iter;
+  gint i;
+
+  gtk_text_buffer_get_start_iter (buffer, &iter);
+  gtk_text_buffer_get_start_iter (expected, &expected_iter);
+
+  do
+    {
+      for (i = 0; i < n_tags; i++)
+        g_assert (gtk_text_iter_has_tag (&iter, tags[i]) ==
+                  gtk_text_iter_has_tag (&expected_iter, expected_tags[i]));
+
+      gtk_text_iter_forward_char (&expected_iter);
+    }
+  while (gtk_text_iter_forward_char (&iter));
+
+  g_assert (gtk_text_iter_is_end (&expected_iter));
+}
+
+static void
+test_apply_tag_spans (void)
+{
+  static const struct {
+    gint tag;
+    gint start;
+    gint end;
+  } spans[] = {
+    { 0, 0, 3 },
+    { 1, 1, 5 },
+    { 0, 2, 4 },
+    { 0, 4, 6 },
+    { 1, 8, 8 },
+    { 2, 9, 14 },
+    { 0, 10, 12 },
+    { 1, 12, 30 },
+    { 0, 12, 13 },
+    { 2, 40, 41 }
+  };
+  const gchar *text = "first line\nsecond line\n\nfourth line, a bit longer\n";
+  GtkTextBuffer *buffer, *expected;
+  GtkTextTag *tags[3], *expected_tags[3];
+  GtkTextTagSpan tag_spans[G_N_ELEMENTS (spans)];
+  GtkTextIter start, end;
+  gint count;
+  gint i;
+
+  buffer = gtk_text_buffer_new (NULL);
+  expected = gtk_text_buffer_new (NULL);
+
+  for (i = 0; i < 3; i++)
+    {
+      tags[i] = gtk_text_buffer_create_tag (buffer, NULL, NULL);
+      expected_tags[i] = gtk_text_buffer_create_tag (expected, NULL, NULL);
+    }
+
+  gtk_text_buffer_set_text (buffer, text, -1);
+  gtk_text_buffer_set_text (expected, text, -1);
+
+  /* A span inside a range that is already tagged, and one next to it */
+  gtk_text_buffer_get_iter_at_offset (buffer, &start, 20);
+  gtk_text_buffer_get_iter_at_offset (buffer, &end, 35);
+  gtk_text_buffer_apply_tag (buffer, tags[1], &start, &end);
+  gtk_text_buffer_get_iter_at_offset (expected, &start, 20);
+  gtk_text_buffer_get_iter_at_offset (expected, &end, 35);
+  gtk_text_buffer_apply_tag (expected, expected_tags[1], &start, &end);
+
+  for (i = 0; i < G_N_ELEMENTS (spans); i++)
+    {
+      tag_spans[i].tag = tags[spans[i].tag];
+      tag_spans[i].start = spans[i].start;
+      tag_spans[i].end = spans[i].end;
+
+      gtk_text_buffer_get_iter_at_offset (expected, &start, spans[i].start);
+      gtk_text_buffer_get_iter_at_offset (expected, &end, spans[i].end);
+      gtk_text_buffer_apply_tag (expected, expected_tags[spans[i].tag], &start, &end);
+    }
+
+  gtk_text_buffer_apply_tag_spans (buffer, tag_spans, G_N_ELEMENTS (tag_spans));
+  check_same_tags (buffer, expected, tags, expected_tags, 3);
+
+  /* With a handler connected, the signal is emitted per merged range */
+  gtk_text_buffer_get_bounds (buffer, &start, &end);
+  gtk_text_buffer_remove_all_tags (buffer, &start, &end);
+
+  count = 0;
+  g_signal_connect (buffer, "apply-tag", G_CALLBACK (count_apply_tag), &count);
+  gtk_text_buffer_apply_tag_spans (buffer, tag_spans, G_N_ELEMENTS (tag_spans));
+  g_assert_cmpint (count, ==, 6);
+
+  gtk_text_buffer_get_iter_at_offset (buffer, &start, 20);
+  gtk_text_buffer_get_iter_at_offset (buffer, &end, 35);
+  gtk_text_buffer_apply_tag (buffer, tags[1], &start, &end);
+  check_same_tags (buffer, expected, tags, expected_tags, 3);
+
+  g_object_unref (buffer);
+  g_object_unref (expected);
+}
+
+static void
+check_same_rich_text (GtkTextBuffer *buffer,
+                      GtkTextBuffer *expected)
+{
+  GtkTextIter iter, expected_iter;
+  GSList *tags, *expected_tags, *l, *m;
+
+  g_assert_cmpint (gtk_text_buffer_get_char_count (buffer), ==,
+                   gtk_text_buffer_get_char_count (expected));
+
+  gtk_text_buffer_get_start_iter (buffer, &iter);
+  gtk_text_buffer_get_start_iter (expected, &expected_iter);
+
+  while (!gtk_text_iter_is_end (&iter))
+    {
+      g_assert_cmpint (gtk_text_iter_get_char (&iter), ==,
+                       gtk_text_iter_get_char (&expected_iter));
+      g_assert ((gtk_text_iter_get_pixbuf (&iter) != NULL) ==
+                (gtk_text_iter_get_pixbuf (&expected_iter) != NULL));
+
+      tags = gtk_text_iter_get_tags (&iter);
+      expected_tags = gtk_text_iter_get_tags (&expected_iter);
+
+      for (l = tags, m = expected_tags; l && m; l = l->next, m = m->next)
+        g_assert_cmpstr (GTK_TEXT_TAG (l->data)->name, ==,
+                         GTK_TEXT_TAG (m->data)->name);
+      g_assert (l == NULL && m == NULL);
+
+      g_slist_free (tags);
+      g_slist_free (expected_tags);
+
+      gtk_text_iter_forward_char (&iter);
+      gtk_text_iter_forward_char (&expected_iter);
+    }
+}
+
+static GtkTextBuffer *
+create_rich_text_buffer (void)
+{
+  GtkTextBuffer *buffer;
+  GtkTextTag *tag;
+  GtkTextIter start, end;
+
+  buffer = gtk_text_buffer_new (NULL);
+  fill_buffer (buffer);
+
+  tag = gtk_text_buffer_create_tag (buffer, NULL,
+                                    "weight", PANGO_WEIGHT_BOLD,
+                                    NULL);
+  gtk_text_buffer_get_iter_at_offset (buffer, &start, 20);
+  gtk_text_buffer_get_iter_at_offset (buffer, &end, 400);
+  gtk_text_buffer_apply_tag (buffer, tag, &start, &end);
+
+  return buffer;
+}
+
+static GtkTextBuffer *
+round_trip (GtkTextBuffer *source,
+            gboolean       binary,
+            gint           start_offset,
+            gint           end_offset,
+            const gchar   *initial_text)
+{
+  GtkTextBuffer *buffer;
+  GdkAtom format;
+  GtkTextIter start, end, iter;
+  GError *error = NULL;
+  guint8 *data;
+  gsize length;
+
+  if (binary)
+    format = gtk_text_buffer_register_serialize_binary_tagset (source, NULL);
+  else
+    format = gtk_text_buffer_register_serialize_tagset (source, NULL);
+
+  gtk_text_buffer_get_iter_at_offset (source, &start, start_offset);
+  if (end_offset < 0)
+    gtk_text_buffer_get_end_iter (source, &end);
+  else
+    gtk_text_buffer_get_iter_at_offset (source, &end, end_offset);
+
+  data = gtk_text_buffer_serialize (source, source, format, &start, &end, &length);
+  g_assert (data != NULL);
+
+  buffer = gtk_text_buffer_new (NULL);
+  gtk_text_buffer_set_text (buffer, initial_text, -1);
+
+  if (binary)
+    format = gtk_text_buffer_register_deserialize_binary_tagset (buffer, NULL);
+  else
+    format = gtk_text_buffer_register_deserialize_tagset (buffer, NULL);
+  gtk_text_buffer_deserialize_set_can_create_tags (buffer, format, TRUE);
+
+  gtk_text_buffer_get_start_iter (buffer, &iter);
+  gtk_text_iter_forward_char (&iter);
+  gtk_text_buffer_deserialize (buffer, buffer, format, &iter,
+                               data, length, &error);
+  g_assert (error == NULL);
+
+  g_free (data);
+
+  return buffer;
+}
+
+static void
+test_binary_rich_text (void)
+{
+  GtkTextBuffer *source, *binary, *xml;
+  GtkTextTag *tag;
+  GtkTextIter start, end;
+  GdkAtom format;
+  GError *error;
+  guint8 *data;
+  gsize length, i;
+  gint rise;
+
+  source = create_rich_text_buffer ();
+
+  /* The whole buffer */
+  binary = round_trip (source, TRUE, 0, -1, "");
+  check_same_rich_text (binary, source);
+
+  tag = gtk_text_tag_table_lookup (gtk_text_buffer_get_tag_table (binary), "fg_red");
+  g_assert (tag != NULL);
+  g_object_get (tag, "rise", &rise, NULL);
+  g_assert_cmpint (rise, ==, -4);
+
+  xml = round_trip (source, FALSE, 0, -1, "");
+  check_same_rich_text (binary, xml);
+
+  g_object_unref (binary);
+  g_object_unref (xml);
+
+  /* A range starting and ending inside tagged text, pasted in the
+   * middle of existing text
+   */
+  binary = round_trip (source, TRUE, 25, 1000, "<>");
+  xml = round_trip (source, FALSE, 25, 1000, "<>");
+  check_same_rich_text (binary, xml);
+
+  g_object_unref (binary);
+  g_object_unref (xml);
+
+  /* Truncated data is rejected */
+  format = gtk_text_buffer_register_serialize_binary_tagset (source, NULL);
+  gtk_text_buffer_get_bounds (source, &start, &end);
+  data = gtk_text_buffer_serialize (source, source, format, &start, &end, &length);
+
+  binary = gtk_text_buffer_new (NULL);
+  format = gtk_text_buffer_register_deserialize_binary_tagset (binary, NULL);
+  gtk_text_buffer_deserialize_set_can_create_tags (binary, format, TRUE);
+
+  for (i = 1; i < length; i += 1 + i / 4)
+    {
+      error = NULL;
+      gtk_text_buffer_get_start_iter (binary, &start);
+      g_assert (!gtk_text_buffer_deserialize (binary, binary, format, &start,
+                                              data, i, &error));
+      g_assert (error != NULL);
+      g_error_free (error);
+    }
+
+  g_free (data);
+  g_object_unref (binary);
+  g_object_unref (source);
+}
+
+/* Hand-made binary sections, to check what is done with data
+ * that is corrupt inside the section
+ */
+static void
+append_be_int (GString *str,
+               gint     value)
+{
+  g_string_append_c (str, ((guint32) value >> 24) & 0xff);
+  g_string_append_c (str, ((guint32) value >> 16) & 0xff);
+  g_string_append_c (str, ((guint32) value >> 8) & 0xff);
+  g_string_append_c (str, (guint32) value & 0xff);
+}
+
+static void
+append_be_string (GString     *str,
+                  const gchar *value)
+{
+  append_be_int (str, strlen (value));
+  g_string_append (str, value);
+}
+
+static void
+put_be_int (GString *str,
+            gsize    pos,
+            gint     value)
+{
+  guchar *p = (guchar *) str->str + pos;
+
+  p[0] = ((guint32) value >> 24) & 0xff;
+  p[1] = ((guint32) value >> 16) & 0xff;
+  p[2] = ((guint32) value >> 8) & 0xff;
+  p[3] = (guint32) value & 0xff;
+}
+
+enum {
+  POS_N_TAGS,
+  POS_NAME_LEN,
+  POS_N_ATTRS,
+  POS_TEXT_LEN,
+  POS_N_PIXBUFS,
+  POS_N_RUNS,
+  POS_RUN_TAG,
+  POS_RUN_START,
+  POS_RUN_END,
+  POS_RUN2_START,
+  N_POS
+};
+
+/* One tag "t" with a weight, the text "abcd", no pixbufs and the
+ * tag on "ab" and "d"
+ */
+static GString *
+build_binary_section (gsize *pos)
+{
+  GString *contents, *data;
+
+  contents = g_string_new (NULL);
+
+  pos[POS_N_TAGS] = contents->len;
+  append_be_int (contents, 1);
+  pos[POS_NAME_LEN] = contents->len;
+  append_be_string (contents, "t");
+  pos[POS_N_ATTRS] = contents->len;
+  append_be_int (contents, 1);
+  append_be_string (contents, "weight");
+  append_be_string (contents, "gint");
+  append_be_string (contents, "700");
+
+  pos[POS_TEXT_LEN] = contents->len;
+  append_be_string (contents, "abcd");
+
+  pos[POS_N_PIXBUFS] = contents->len;
+  append_be_int (contents, 0);
+
+  pos[POS_N_RUNS] = contents->len;
+  append_be_int (contents, 2);
+  pos[POS_RUN_TAG] = contents->len;
+  append_be_int (contents, 0);
+  pos[POS_RUN_START] = contents->len;
+  append_be_int (contents, 0);
+  pos[POS_RUN_END] = contents->len;
+  append_be_int (contents, 2);
+  append_be_int (contents, 0);
+  pos[POS_RUN2_START] = contents->len;
+  append_be_int (contents, 3);
+  append_be_int (contents, 4);
+
+  data = g_string_new ("GTKTEXTBUFFERCONTENTS-0002");
+  append_be_int (data, contents->len);
+  g_string_append_len (data, contents->str, contents->len);
+  g_string_free (contents, TRUE);
+
+  return data;
+}
+
+static gboolean
+deserialize_binary (GString        *data,
+                    GtkTextBuffer **buffer,
+                    GError        **error)
+{
+  GdkAtom format;
+  GtkTextIter start;
+
+  *buffer = gtk_text_buffer_new (NULL);
+  format = gtk_text_buffer_register_deserialize_binary_tagset (*buffer, NULL);
+  gtk_text_buffer_deserialize_set_can_create_tags (*buffer, format, TRUE);
+
+  gtk_text_buffer_get_start_iter (*buffer, &start);
+
+  return gtk_text_buffer_deserialize (*buffer, *buffer, format, &start,
+                                      (guint8 *) data->str, data->len, error);
+}
+
+static void
+test_binary_rich_text_corrupt (void)
+{
+  static const struct {
+    gint pos;
+    gint value;
+  } corruptions[] = {
+    { POS_N_TAGS, G_MAXINT },
+    { POS_N_TAGS, -1 },
+    { POS_N_TAGS, 2 },
+    { POS_NAME_LEN, G_MAXINT },
+    { POS_NAME_LEN, -2 },
+    { POS_N_ATTRS, G_MAXINT },
+    { POS_N_ATTRS, -1 },
+    { POS_N_ATTRS, 2 },
+    { POS_TEXT_LEN, G_MAXINT },
+    { POS_TEXT_LEN, -1 },
+    { POS_TEXT_LEN, 5 },
+    { POS_N_PIXBUFS, G_MAXINT },
+    { POS_N_PIXBUFS, -1 },
+    { POS_N_PIXBUFS, 1 },
+    { POS_N_RUNS, G_MAXINT },
+    { POS_N_RUNS, -1 },
+    { POS_N_RUNS, 3 },
+    { POS_RUN_TAG, 1 },
+    { POS_RUN_TAG, -1 },
+    { POS_RUN_START, -1 },
+    { POS_RUN_START, 3 },
+    { POS_RUN_END, 5 },
+    { POS_RUN2_START, -1 }
+  };
+  GtkTextBuffer *buffer;
+  GtkTextTag *tag;
+  GtkTextIter iter;
+  GString *data;
+  GError *error;
+  gsize pos[N_POS];
+  guint i;
+
+  /* The data as built is fine */
+  data = build_binary_section (pos);
+  error = NULL;
+  g_assert (deserialize_binary (data, &buffer, &error));
+  g_assert (error == NULL);
+
+  g_assert_cmpint (gtk_text_tag_table_get_size (gtk_text_buffer_get_tag_table (buffer)), ==, 1);
+  tag = gtk_text_tag_table_lookup (gtk_text_buffer_get_tag_table (buffer), "t");
+  g_assert (tag != NULL);
+
+  gtk_text_buffer_get_iter_at_offset (buffer, &iter, 1);
+  g_assert (gtk_text_iter_has_tag (&iter, tag));
+  gtk_text_buffer_get_iter_at_offset (buffer, &iter, 2);
+  g_assert (!gtk_text_iter_has_tag (&iter, tag));
+  gtk_text_buffer_get_iter_at_offset (buffer, &iter, 3);
+  g_assert (gtk_text_iter_has_tag (&iter, tag));
+
+  g_object_unref (buffer);
+  g_string_free (data, TRUE);
+
+  /* Corrupt data leaves neither text nor tags behind */
+  for (i = 0; i < G_N_ELEMENTS (corruptions); i++)
+    {
+      data = build_binary_section (pos);
+      put_be_int (data, 30 + pos[corruptions[i].pos], corruptions[i].value);
+
+      error = NULL;
+      g_assert (!deserialize_binary (data, &buffer, &error));
+      g_assert (error != NULL);
+      g_error_free (error);
+
+      g_assert_cmpint (gtk_text_buffer_get_char_count (buffer), ==, 0);
+      g_assert_cmpint (gtk_text_tag_table_get_size (gtk_text_buffer_get_tag_table (buffer)), ==, 0);
+
+      g_object_unref (buffer);
+      g_string_free (data, TRUE);
+    }
+}
+
+#define N_PERF_LINES 5000
+
+static void
+time_round_trip (GtkTextBuffer *source,
+                 gboolean       binary,
+                 gdouble       *serialize,
+                 gdouble       *deserialize)
+{
+  GtkTextBuffer *buffer;
+  GdkAtom format;
+  GtkTextIter start, end;
+  guint8 *data;
+  gsize length;
+
+  if (binary)
+    format = gtk_text_buffer_register_serialize_binary_tagset (source, NULL);
+  else
+    format = gtk_text_buffer_register_serialize_tagset (source, NULL);
+
+  gtk_text_buffer_get_bounds (source, &start, &end);
+
+  g_test_timer_start ();
+  data = gtk_text_buffer_serialize (source, source, format, &start, &end, &length);
+  *serialize = g_test_timer_elapsed ();
+
+  buffer = gtk_text_buffer_new (NULL);
+
+  if (binary)
+    format = gtk_text_buffer_register_deserialize_binary_tagset (buffer, NULL);
+  else
+    format = gtk_text_buffer_register_deserialize_tagset (buffer, NULL);
+  gtk_text_buffer_deserialize_set_can_create_tags (buffer, format, TRUE);
+
+  gtk_text_buffer_get_start_iter (buffer, &start);
+
+  g_test_timer_start ();
+  gtk_text_buffer_deserialize (buffer, buffer, format, &start, data, length, NULL);
+  *deserialize = g_test_timer_elapsed ();
+
+  g_assert_cmpint (gtk_text_buffer_get_char_count (buffer), ==,
+                   gtk_text_buffer_get_char_count (source));
+
+  g_free (data);
+  g_object_unref (buffer);
+}
+
+static void
+test_binary_rich_text_perf (void)
+{
+  GtkTextBuffer *source;
+  GtkTextTag *tags[3];
+  GtkTextIter iter, start, end;
+  gdouble xml_ser, xml_deser, bin_ser, bin_deser;
+  gint i, line_start;
+
+  source = gtk_text_buffer_new (NULL);
+
+  tags[0] = gtk_text_buffer_create_tag (source, "keyword",
+                                        "weight", PANGO_WEIGHT_BOLD,
+                                        NULL);
+  tags[1] = gtk_text_buffer_create_tag (source, "string",
+                                        "style", PANGO_STYLE_ITALIC,
+                                        NULL);
+  tags[2] = gtk_text_buffer_create_tag (source, "comment",
+                                        "family", "Monospace",
+                                        NULL);
+
+  for (i = 0; i < N_PERF_LINES; i++)
+    {
+      gtk_text_buffer_get_end_iter (source, &iter);
+      line_start = gtk_text_iter_get_offset (&iter);
+      gtk_text_buffer_insert (source, &iter,
+                              "  return g_strdup (\"a <string> & more\"); /* comment */\n",
+                              -1);
+
+      gtk_text_buffer_get_iter_at_offset (source, &start, line_start + 2);
+      gtk_text_buffer_get_iter_at_offset (source, &end, line_start + 8);
+      gtk_text_buffer_apply_tag (source, tags[0], &start, &end);
+
+      gtk_text_buffer_get_iter_at_offset (source, &start, line_start + 19);
+      gtk_text_buffer_get_iter_at_offset (source, &end, line_start + 38);
+      gtk_text_buffer_apply_tag (source, tags[1], &start, &end);
+
+      gtk_text_buffer_get_iter_at_offset (source, &start, line_start + 41);
+      gtk_text_buffer_get_iter_at_offset (source, &end, line_start + 54);
+      gtk_text_buffer_apply_tag (source, tags[2], &start, &end);
+    }
+
+  time_round_trip (source, FALSE, &xml_ser, &xml_deser);
+  time_round_trip (source, TRUE, &bin_ser, &bin_deser);
+
+  g_test_message ("%d lines: XML %.2f ms + %.2f ms, binary %.2f ms + %.2f ms",
+                  N_PERF_LINES,
+                  xml_ser * 1000, xml_deser * 1000,
+                  bin_ser * 1000, bin_deser * 1000);
+  g_test_minimized_result (bin_ser + bin_deser,
+                           "binary rich text round trip: %.2f ms",
+                           (bin_ser + bin_deser) * 1000);
+
+  g_object_unref (source);
+}
+
 extern void pixbuf_init (void);
 
 int
@@ -1303,6 +1878,13 @@ main (int argc, char** argv)
   g_test_add_func ("/TextBuffer/Get and Set", test_get_set);
   g_test_add_func ("/TextBuffer/Fill and Empty", test_fill_empty);
   g_test_add_func ("/TextBuffer/Tag", test_tag);
+  g_test_add_func ("/TextBuffer/Apply tag spans", test_apply_tag_spans);
+  g_test_add_func ("/TextBuffer/Binary rich text", test_binary_rich_text);
+  g_test_add_func ("/TextBuffer/Corrupt binary rich text", test_binary_rich_text_corrupt);
+
+  if (g_test_perf ())
+    g_test_add_func ("/TextBuffer/Binary rich text performance",
+                     test_binary_rich_text_perf);
   
   return g_test_run();
 }
@@ -0,0 +1,191 @@
+/* GtkTextView tests.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <gtk/gtk.h>
+
+#define N_LINES 2000
+
+static void
+allocate_view (GtkWidget *text_view)
+{
+  GtkWidget *window;
+  GtkRequisition requisition;
+  GtkAllocation allocation;
+
+  window = gtk_widget_get_toplevel (text_view);
+
+  /* Allocating the view runs its first validation */
+  gtk_widget_size_request (window, &requisition);
+  allocation.x = 0;
+  allocation.y = 0;
+  allocation.width = 200;
+  allocation.height = 200;
+  gtk_widget_size_allocate (window, &allocation);
+}
+
+static GtkWidget *
+create_view (GtkTextBuffer *buffer,
+             gboolean       estimate)
+{
+  GtkWidget *window, *text_view;
+
+  window = gtk_window_new (GTK_WINDOW_TOPLEVEL);
+  text_view = gtk_text_view_new_with_buffer (buffer);
+  gtk_text_view_set_estimate_line_heights (GTK_TEXT_VIEW (text_view), estimate);
+  gtk_container_add (GTK_CONTAINER (window), text_view);
+  gtk_widget_show (text_view);
+
+  allocate_view (text_view);
+
+  return text_view;
+}
+
+static void
+append_lines (GtkTextBuffer *buffer,
+              gint           n_lines)
+{
+  GString *text;
+  GtkTextIter end;
+  gint i;
+
+  text = g_string_new (NULL);
+  for (i = 0; i < n_lines; i++)
+    g_string_append_printf (text, "\nLine %d", i);
+
+  gtk_text_buffer_get_end_iter (buffer, &end);
+  gtk_text_buffer_insert (buffer, &end, text->str, text->len);
+  g_string_free (text, TRUE);
+}
+
+/* Lines below the screen get an estimated height on the first
+ * validation, which the real height replaces once they are
+ * validated.
+ */
+static void
+test_estimate_line_heights (void)
+{
+  GtkTextBuffer *buffer;
+  GtkTextTag *tag;
+  GtkTextIter start, end;
+  GtkWidget *estimated, *reference;
+  gint y, height, estimated_y, estimated_height;
+  gint i;
+
+  buffer = gtk_text_buffer_new (NULL);
+
+  for (i = 0; i < N_LINES; i++)
+    {
+      gchar *text;
+
+      text = g_strdup_printf ("%sLine %d", i > 0 ? "\n" : "", i);
+      gtk_text_buffer_get_end_iter (buffer, &end);
+      gtk_text_buffer_insert (buffer, &end, text, -1);
+      g_free (text);
+    }
+
+  /* The estimate only knows the default font, so make the
+   * last line's real height differ from it
+   */
+  tag = gtk_text_buffer_create_tag (buffer, NULL, "scale", 4.0, NULL);
+  gtk_text_buffer_get_end_iter (buffer, &end);
+  start = end;
+  gtk_text_iter_set_line_offset (&start, 0);
+  gtk_text_buffer_apply_tag (buffer, tag, &start, &end);
+
+  estimated = create_view (buffer, TRUE);
+  reference = create_view (buffer, FALSE);
+
+  gtk_text_buffer_get_end_iter (buffer, &end);
+
+  gtk_text_view_get_line_yrange (GTK_TEXT_VIEW (reference), &end, &y, &height);
+  g_assert_cmpint (height, ==, 0);
+
+  gtk_text_view_get_line_yrange (GTK_TEXT_VIEW (estimated), &end,
+                                 &estimated_y, &estimated_height);
+  g_assert_cmpint (estimated_y, >, 0);
+  g_assert_cmpint (estimated_height, >, 0);
+
+  /* Let the idle validation run to the end */
+  while (gtk_events_pending ())
+    gtk_main_iteration ();
+
+  gtk_text_view_get_line_yrange (GTK_TEXT_VIEW (reference), &end, &y, &height);
+  g_assert_cmpint (height, >, estimated_height);
+
+  gtk_text_view_get_line_yrange (GTK_TEXT_VIEW (estimated), &end,
+                                 &estimated_y, &estimated_height);
+  g_assert_cmpint (estimated_y, ==, y);
+  g_assert_cmpint (estimated_height, ==, height);
+
+  gtk_widget_destroy (gtk_widget_get_toplevel (estimated));
+  gtk_widget_destroy (gtk_widget_get_toplevel (reference));
+  g_object_unref (buffer);
+}
+
+/* Estimating a buffer that is partly validated skips the valid
+ * subtrees; the btree consistency checks must accept that.
+ */
+static void
+test_estimate_after_insert (void)
+{
+  GtkTextBuffer *buffer;
+  GtkTextIter end;
+  GtkWidget *text_view;
+  guint debug_flags;
+  gint y, height;
+
+  debug_flags = gtk_debug_flags;
+  gtk_debug_flags |= GTK_DEBUG_TEXT;
+
+  buffer = gtk_text_buffer_new (NULL);
+  gtk_text_buffer_set_text (buffer, "Line", -1);
+  append_lines (buffer, 200);
+
+  text_view = create_view (buffer, TRUE);
+
+  while (gtk_events_pending ())
+    gtk_main_iteration ();
+
+  append_lines (buffer, N_LINES);
+  allocate_view (text_view);
+
+  gtk_text_buffer_get_end_iter (buffer, &end);
+  gtk_text_view_get_line_yrange (GTK_TEXT_VIEW (text_view), &end, &y, &height);
+  g_assert_cmpint (y, >, 0);
+  g_assert_cmpint (height, >, 0);
+
+  while (gtk_events_pending ())
+    gtk_main_iteration ();
+
+  gtk_widget_destroy (gtk_widget_get_toplevel (text_view));
+  g_object_unref (buffer);
+
+  gtk_debug_flags = debug_flags;
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  gtk_test_init (&argc, &argv);
+
+  g_test_add_func ("/textview/estimate-line-heights", test_estimate_line_heights);
+  g_test_add_func ("/textview/estimate-after-insert", test_estimate_after_insert);
+
+  return g_test_run ();
+}
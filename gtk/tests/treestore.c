@@ -853,6 +853,191 @@ tree_store_test_move_before_single (void)
   g_object_unref (store);
 }
 
+/* column storage */
+
+static void
+tree_store_test_set_sparse (void)
+{
+  GtkTreeStore *store;
+  GtkTreeIter iter;
+  gchar *str = NULL;
+  gint value = -1;
+  gdouble d = -1.0;
+
+  store = gtk_tree_store_new (3, G_TYPE_INT, G_TYPE_DOUBLE, G_TYPE_STRING);
+
+  /* Setting only the last column must leave the others at their
+   * default values.
+   */
+  gtk_tree_store_append (store, &iter, NULL);
+  gtk_tree_store_set (store, &iter, 2, "last", -1);
+
+  gtk_tree_model_get (GTK_TREE_MODEL (store), &iter,
+                      0, &value, 1, &d, 2, &str, -1);
+  g_assert_cmpint (value, ==, 0);
+  g_assert_cmpfloat (d, ==, 0.0);
+  g_assert_cmpstr (str, ==, "last");
+  g_free (str);
+
+  gtk_tree_store_set (store, &iter, 0, 42, 2, "again", -1);
+
+  gtk_tree_model_get (GTK_TREE_MODEL (store), &iter,
+                      0, &value, 2, &str, -1);
+  g_assert_cmpint (value, ==, 42);
+  g_assert_cmpstr (str, ==, "again");
+  g_free (str);
+
+  /* A row that was never set reads back as defaults */
+  gtk_tree_store_append (store, &iter, NULL);
+  gtk_tree_model_get (GTK_TREE_MODEL (store), &iter, 2, &str, -1);
+  g_assert (str == NULL);
+
+  g_object_unref (store);
+}
+
+#define PERF_N_ROWS    50000
+#define PERF_N_COLUMNS 8
+
+static void
+tree_store_test_columns_perf (void)
+{
+  GtkTreeStore *store;
+  GType types[PERF_N_COLUMNS];
+  GtkTreeIter iter;
+  gboolean valid;
+  gdouble elapsed;
+  gint i;
+
+  for (i = 0; i < PERF_N_COLUMNS; i++)
+    types[i] = G_TYPE_INT;
+
+  store = gtk_tree_store_newv (PERF_N_COLUMNS, types);
+
+  g_test_timer_start ();
+  for (i = 0; i < PERF_N_ROWS; i++)
+    {
+      gint j;
+
+      gtk_tree_store_append (store, &iter, NULL);
+      for (j = PERF_N_COLUMNS - 1; j >= 0; j--)
+        gtk_tree_store_set (store, &iter, j, g_test_rand_int (), -1);
+    }
+  elapsed = g_test_timer_elapsed ();
+  g_test_minimized_result (elapsed * 1000000 / PERF_N_ROWS,
+                           "fill %d columns: %.2f usec per row",
+                           PERF_N_COLUMNS, elapsed * 1000000 / PERF_N_ROWS);
+
+  g_test_timer_start ();
+  valid = gtk_tree_model_get_iter_first (GTK_TREE_MODEL (store), &iter);
+  while (valid)
+    {
+      gint value;
+
+      gtk_tree_model_get (GTK_TREE_MODEL (store), &iter,
+                          PERF_N_COLUMNS - 1, &value, -1);
+      valid = gtk_tree_model_iter_next (GTK_TREE_MODEL (store), &iter);
+    }
+  elapsed = g_test_timer_elapsed ();
+  g_test_minimized_result (elapsed * 1000000 / PERF_N_ROWS,
+                           "get last column: %.2f usec per row",
+                           elapsed * 1000000 / PERF_N_ROWS);
+
+  g_test_timer_start ();
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (store),
+                                        PERF_N_COLUMNS - 1,
+                                        GTK_SORT_ASCENDING);
+  elapsed = g_test_timer_elapsed ();
+  g_test_minimized_result (elapsed,
+                           "sort on last column: %.3f sec", elapsed);
+
+  g_object_unref (store);
+}
+
+/* long levels */
+
+static void
+check_level (GtkTreeStore *store,
+             GtkTreeIter  *parent)
+{
+  GtkTreeModel *model = GTK_TREE_MODEL (store);
+  GtkTreeIter iter;
+  gboolean valid;
+  gint n = 0;
+
+  valid = gtk_tree_model_iter_children (model, &iter, parent);
+  while (valid)
+    {
+      GtkTreeIter nth;
+      GtkTreePath *path;
+
+      path = gtk_tree_model_get_path (model, &iter);
+      g_assert (path != NULL);
+      g_assert_cmpint (gtk_tree_path_get_indices (path)[gtk_tree_path_get_depth (path) - 1], ==, n);
+      gtk_tree_path_free (path);
+
+      g_assert (gtk_tree_model_iter_nth_child (model, &nth, parent, n));
+      g_assert (nth.user_data == iter.user_data);
+
+      valid = gtk_tree_model_iter_next (model, &iter);
+      n++;
+    }
+
+  g_assert_cmpint (gtk_tree_model_iter_n_children (model, parent), ==, n);
+  g_assert (!gtk_tree_model_iter_nth_child (model, &iter, parent, n));
+}
+
+static void
+tree_store_test_long_level (void)
+{
+  GtkTreeStore *store;
+  GtkTreeIter parent;
+  GtkTreeIter iter;
+  GtkTreeIter child;
+  gint i;
+
+  store = gtk_tree_store_new (1, G_TYPE_INT);
+  gtk_tree_store_append (store, &parent, NULL);
+
+  for (i = 0; i < 500; i++)
+    gtk_tree_store_insert_with_values (store, &iter, &parent, -1, 0, i, -1);
+  check_level (store, &parent);
+
+  for (i = 0; i < 100; i++)
+    gtk_tree_store_prepend (store, &iter, &parent);
+  check_level (store, &parent);
+
+  /* a grandchild, so removing its parent drops a nested level */
+  g_assert (gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (store),
+                                           &iter, &parent, 300));
+  gtk_tree_store_append (store, &child, &iter);
+
+  gtk_tree_store_insert (store, &iter, &parent, 250);
+  check_level (store, &parent);
+
+  g_assert (gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (store),
+                                           &iter, &parent, 0));
+  gtk_tree_store_remove (store, &iter);
+  g_assert (gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (store),
+                                           &iter, &parent, 599));
+  gtk_tree_store_remove (store, &iter);
+  g_assert (gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (store),
+                                           &iter, &parent, 300));
+  gtk_tree_store_remove (store, &iter);
+  check_level (store, &parent);
+
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (store), 0,
+                                        GTK_SORT_DESCENDING);
+  check_level (store, &parent);
+
+  g_assert (gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (store),
+                                           &iter, &parent, 400));
+  gtk_tree_store_set (store, &iter, 0, 10000, -1);
+  check_level (store, &parent);
+
+  gtk_tree_store_clear (store);
+  g_object_unref (store);
+}
+
 /* main */
 
 int
@@ -961,5 +1146,15 @@ main (int    argc,
   g_test_add_func ("/tree-store/move-before-single",
 		   tree_store_test_move_before_single);
 
+  /* column storage */
+  g_test_add_func ("/tree-store/set-sparse",
+		   tree_store_test_set_sparse);
+  g_test_add_func ("/tree-store/long-level",
+		   tree_store_test_long_level);
+
+  if (g_test_perf ())
+    g_test_add_func ("/tree-store/columns-perf",
+		     tree_store_test_columns_perf);
+
   return g_test_run ();
 }
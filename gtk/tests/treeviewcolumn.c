@@ -0,0 +1,175 @@
+/* GtkTreeViewColumn tests.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <gtk/gtk.h>
+
+#define N_COLUMNS 10
+#define N_ROWS 10000
+
+static void
+notify_count (GObject    *object,
+	      GParamSpec *pspec,
+	      gint       *count)
+{
+  (*count)++;
+}
+
+static void
+test_cell_data_attributes (void)
+{
+  GtkListStore *store;
+  GtkWidget *view;
+  GtkTreeViewColumn *column;
+  GtkCellRenderer *cell;
+  GtkTreeIter iter;
+  gchar *text;
+  gint weight;
+  gfloat xalign;
+  gboolean visible;
+  gint notifies = 0;
+
+  store = gtk_list_store_new (4, G_TYPE_STRING, G_TYPE_INT,
+			      G_TYPE_DOUBLE, G_TYPE_BOOLEAN);
+  gtk_list_store_insert_with_values (store, &iter, 0,
+				     0, "first",
+				     1, PANGO_WEIGHT_BOLD,
+				     2, 0.25,
+				     3, FALSE,
+				     -1);
+
+  view = gtk_tree_view_new_with_model (GTK_TREE_MODEL (store));
+  cell = gtk_cell_renderer_text_new ();
+  /* "xalign" is a float, so the double column needs a transformation */
+  column = gtk_tree_view_column_new_with_attributes ("Test", cell,
+						     "text", 0,
+						     "weight", 1,
+						     "xalign", 2,
+						     "visible", 3,
+						     NULL);
+  gtk_tree_view_append_column (GTK_TREE_VIEW (view), column);
+
+  g_signal_connect (cell, "notify::visible",
+		    G_CALLBACK (notify_count), &notifies);
+
+  gtk_tree_view_column_cell_set_cell_data (column, GTK_TREE_MODEL (store),
+					   &iter, FALSE, FALSE);
+
+  g_object_get (cell,
+		"text", &text,
+		"weight", &weight,
+		"xalign", &xalign,
+		"visible", &visible,
+		NULL);
+  g_assert_cmpstr (text, ==, "first");
+  g_assert_cmpint (weight, ==, PANGO_WEIGHT_BOLD);
+  g_assert_cmpfloat (xalign, ==, 0.25);
+  g_assert (visible == FALSE);
+  g_free (text);
+
+  /* Setting cell data does not emit notification for mapped attributes */
+  g_assert_cmpint (notifies, ==, 0);
+
+  gtk_list_store_set (store, &iter, 0, "second", -1);
+  gtk_tree_view_column_cell_set_cell_data (column, GTK_TREE_MODEL (store),
+					   &iter, FALSE, FALSE);
+
+  g_object_get (cell, "text", &text, NULL);
+  g_assert_cmpstr (text, ==, "second");
+  g_free (text);
+
+  gtk_widget_destroy (view);
+  g_object_unref (store);
+}
+
+static void
+test_cell_data_perf (void)
+{
+  GtkListStore *store;
+  GtkWidget *view;
+  GtkTreeViewColumn *columns[N_COLUMNS];
+  GType types[N_COLUMNS];
+  GtkTreeIter iter;
+  gboolean valid;
+  gdouble elapsed;
+  gint i;
+
+  for (i = 0; i < N_COLUMNS; i++)
+    types[i] = G_TYPE_STRING;
+
+  store = gtk_list_store_newv (N_COLUMNS, types);
+  for (i = 0; i < N_ROWS; i++)
+    {
+      gint j;
+
+      gtk_list_store_append (store, &iter);
+      for (j = 0; j < N_COLUMNS; j++)
+	{
+	  gchar *text = g_strdup_printf ("Row %d, column %d", i, j);
+
+	  gtk_list_store_set (store, &iter, j, text, -1);
+	  g_free (text);
+	}
+    }
+
+  view = gtk_tree_view_new_with_model (GTK_TREE_MODEL (store));
+  for (i = 0; i < N_COLUMNS; i++)
+    {
+      columns[i] = gtk_tree_view_column_new_with_attributes ("Column",
+							      gtk_cell_renderer_text_new (),
+							      "text", i,
+							      NULL);
+      gtk_tree_view_append_column (GTK_TREE_VIEW (view), columns[i]);
+    }
+
+  g_test_timer_start ();
+
+  valid = gtk_tree_model_get_iter_first (GTK_TREE_MODEL (store), &iter);
+  while (valid)
+    {
+      for (i = 0; i < N_COLUMNS; i++)
+	gtk_tree_view_column_cell_set_cell_data (columns[i],
+						 GTK_TREE_MODEL (store),
+						 &iter, FALSE, FALSE);
+
+      valid = gtk_tree_model_iter_next (GTK_TREE_MODEL (store), &iter);
+    }
+
+  elapsed = g_test_timer_elapsed ();
+  g_test_minimized_result (elapsed * 1000000 / N_ROWS,
+			   "set cell data for %d columns: %.2f usec per row",
+			   N_COLUMNS, elapsed * 1000000 / N_ROWS);
+
+  gtk_widget_destroy (view);
+  g_object_unref (store);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/tree-view-column/cell-data-attributes",
+		   test_cell_data_attributes);
+
+  if (g_test_perf ())
+    g_test_add_func ("/tree-view-column/cell-data-perf",
+		     test_cell_data_perf);
+
+  return g_test_run ();
+}
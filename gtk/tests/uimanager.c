@@ -0,0 +1,114 @@
+/* GtkUIManager tests.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <gtk/gtk.h>
+
+static const gchar base_ui[] =
+  "<ui>"
+  "  <menubar name='menubar'>"
+  "    <menu action='file'>"
+  "      <menuitem action='open'/>"
+  "      <placeholder name='plugins'/>"
+  "    </menu>"
+  "  </menubar>"
+  "</ui>";
+
+static const gchar plugin_ui[] =
+  "<ui>"
+  "  <menubar name='menubar'>"
+  "    <menu action='file'>"
+  "      <placeholder name='plugins'>"
+  "        <menuitem action='plugin'/>"
+  "      </placeholder>"
+  "    </menu>"
+  "  </menubar>"
+  "</ui>";
+
+static const GtkActionEntry entries[] = {
+  { "file", NULL, "_File" },
+  { "open", NULL, "_Open" }
+};
+
+static const GtkActionEntry plugin_entries[] = {
+  { "plugin", NULL, "_Plugin" }
+};
+
+static void
+test_merge_remove (void)
+{
+  GtkUIManager *manager;
+  GtkActionGroup *group, *plugin_group;
+  GtkWidget *open_item, *plugin_item;
+  guint merge_id;
+  gint i;
+
+  manager = gtk_ui_manager_new ();
+
+  group = gtk_action_group_new ("base");
+  gtk_action_group_add_actions (group, entries, G_N_ELEMENTS (entries), NULL);
+  gtk_ui_manager_insert_action_group (manager, group, 0);
+
+  gtk_ui_manager_add_ui_from_string (manager, base_ui, -1, NULL);
+  gtk_ui_manager_ensure_update (manager);
+
+  open_item = gtk_ui_manager_get_widget (manager, "/menubar/file/open");
+  g_assert (GTK_IS_MENU_ITEM (open_item));
+
+  for (i = 0; i < 3; i++)
+    {
+      /* The manager holds the only reference to the plugin group, so
+       * removing it finalizes the group.
+       */
+      plugin_group = gtk_action_group_new ("plugin");
+      gtk_action_group_add_actions (plugin_group, plugin_entries,
+				    G_N_ELEMENTS (plugin_entries), NULL);
+      gtk_ui_manager_insert_action_group (manager, plugin_group, 0);
+      g_object_unref (plugin_group);
+
+      merge_id = gtk_ui_manager_add_ui_from_string (manager, plugin_ui, -1, NULL);
+      gtk_ui_manager_ensure_update (manager);
+
+      plugin_item = gtk_ui_manager_get_widget (manager, "/menubar/file/plugins/plugin");
+      g_assert (GTK_IS_MENU_ITEM (plugin_item));
+      g_assert (gtk_widget_get_parent (plugin_item) ==
+		gtk_widget_get_parent (open_item));
+
+      gtk_ui_manager_remove_ui (manager, merge_id);
+      gtk_ui_manager_remove_action_group (manager, plugin_group);
+      gtk_ui_manager_ensure_update (manager);
+
+      g_assert (gtk_ui_manager_get_widget (manager, "/menubar/file/plugins/plugin") == NULL);
+
+      /* Untouched parts of the UI keep their widgets */
+      g_assert (gtk_ui_manager_get_widget (manager, "/menubar/file/open") == open_item);
+    }
+
+  g_object_unref (group);
+  g_object_unref (manager);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/ui-manager/merge-remove", test_merge_remove);
+
+  return g_test_run ();
+}
@@ -345,6 +345,15 @@ static GailTreeViewCellInfo* find_cell_info             (GailTreeView
 static AtkObject *       get_header_from_column         (GtkTreeViewColumn      *tv_col);
 static gboolean          idle_garbage_collect_cell_data (gpointer data);
 static gboolean          garbage_collect_cell_data      (gpointer data);
+static guint             cell_key_hash                  (gconstpointer          v);
+static gboolean          cell_key_equal                 (gconstpointer          a,
+                                                         gconstpointer          b);
+static void              cell_key_free                  (gpointer               data);
+static void              cell_info_index_add            (GailTreeView           *view,
+                                                         GailTreeViewCellInfo   *cell_info);
+static void              cell_info_index_remove         (GailTreeView           *view,
+                                                         GailTreeViewCellInfo   *cell_info);
+static void              cell_info_index_invalidate     (GailTreeView           *view);
 
 static GQuark quark_column_desc_object = 0;
 static GQuark quark_column_header_object = 0;
@@ -368,6 +377,18 @@ struct _GailTreeViewCellInfo
   gboolean in_use;
 };
 
+/*
+ * Key of the cell_positions table: the path of the row the cell
+ * is on and the column it is in.  Paths move when rows are inserted,
+ * deleted or reordered, so the table is dropped on those model
+ * signals and rebuilt the next time a cell is looked up by index.
+ */
+typedef struct
+{
+  GtkTreePath *path;
+  GtkTreeViewColumn *column;
+} GailTreeViewCellKey;
+
 G_DEFINE_TYPE_WITH_CODE (GailTreeView, gail_tree_view, GAIL_TYPE_CONTAINER,
                          G_IMPLEMENT_INTERFACE (ATK_TYPE_TABLE, atk_table_interface_init)
                          G_IMPLEMENT_INTERFACE (ATK_TYPE_SELECTION, atk_selection_interface_init)
@@ -434,6 +455,8 @@ gail_tree_view_real_initialize (AtkObject *obj,
   view->row_data = NULL;
   view->col_data = NULL;
   view->cell_data = NULL;
+  view->cell_infos = g_hash_table_new (g_direct_hash, g_direct_equal);
+  view->cell_positions = NULL;
   view->focus_cell = NULL;
   view->old_hadj = NULL;
   view->old_vadj = NULL;
@@ -620,6 +643,9 @@ gail_tree_view_finalize (GObject	    *object)
 
   clear_cached_data (view);
 
+  if (view->cell_infos)
+    g_hash_table_destroy (view->cell_infos);
+
   /* remove any idle handlers still pending */
   if (view->idle_garbage_collect_id)
     g_source_remove (view->idle_garbage_collect_id);
@@ -2877,6 +2903,8 @@ model_row_inserted (GtkTreeModel *tree_model,
       if (gailview->idle_expand_path) 
 	  gtk_tree_path_free (gailview->idle_expand_path);
     }
+  cell_info_index_invalidate (gailview);
+
   /* Check to see if row is visible */
   row = get_row_from_tree_path (tree_view, path);
 
@@ -2966,6 +2994,8 @@ model_row_deleted (GtkTreeModel *tree_model,
       gtk_tree_path_free (gailview->idle_expand_path);
       gailview->idle_expand_id = 0;
     }
+  cell_info_index_invalidate (gailview);
+
   /* Check to see if row is visible */
   clean_rows (gailview);
 
@@ -3046,6 +3076,7 @@ model_rows_reordered (GtkTreeModel *tree_model,
       gtk_tree_path_free (gailview->idle_expand_path);
       gailview->idle_expand_id = 0;
     }
+  cell_info_index_invalidate (gailview);
   traverse_cells (gailview, NULL, TRUE, FALSE);
 
   g_signal_emit_by_name (atk_obj, "row_reordered");
@@ -3564,6 +3595,7 @@ clean_cell_info (GailTreeView *gailview,
       
       gail_cell_add_state (cell_info->cell, ATK_STATE_DEFUNCT, TRUE);
       g_object_weak_unref (obj, (GWeakNotify) cell_destroyed, cell_info);
+      cell_info_index_remove (gailview, cell_info);
       cell_info->in_use = FALSE; 
       if (!gailview->garbage_collection_pending) {
 	  gailview->garbage_collection_pending = TRUE;
@@ -3701,12 +3733,11 @@ static gboolean
 garbage_collect_cell_data (gpointer data)
 {
       GailTreeView *tree_view;
-      GList *temp_list, *list;
+      GList *temp_list, *next;
       GailTreeViewCellInfo *cell_info;
 
       g_assert (GAIL_IS_TREE_VIEW (data));
       tree_view = (GailTreeView *)data;
-      list = g_list_copy (tree_view->cell_data);
 
       tree_view->garbage_collection_pending = FALSE;
       if (tree_view->idle_garbage_collect_id != 0) 
@@ -3715,23 +3746,23 @@ garbage_collect_cell_data (gpointer data)
 	  tree_view->idle_garbage_collect_id = 0;
       }
 
-      /* Must loop through them all */
-      temp_list = list;
+      /* Must loop through them all, unlinking dead entries in place */
+      temp_list = tree_view->cell_data;
       while (temp_list != NULL)
       {
           cell_info = temp_list->data;
+          next = temp_list->next;
 	  if (!cell_info->in_use)
 	  {
 	      /* g_object_unref (cell_info->cell); */
-	      tree_view->cell_data = g_list_remove (tree_view->cell_data, 
-						    cell_info);
+	      tree_view->cell_data = g_list_delete_link (tree_view->cell_data, 
+							 temp_list);
 	      if (cell_info->cell_row_ref)
 		  gtk_tree_row_reference_free (cell_info->cell_row_ref);
 	      g_free (cell_info);
 	  }
-          temp_list = temp_list->next;
+          temp_list = next;
       }
-      g_list_free (list);
 
       return tree_view->garbage_collection_pending;
 }
@@ -4122,6 +4153,7 @@ cell_destroyed (gpointer data)
 
   gail_return_if_fail (cell_info);
   if (cell_info->in_use) {
+      cell_info_index_remove (cell_info->view, cell_info);
       cell_info->in_use = FALSE;
 
       g_assert (GAIL_IS_TREE_VIEW (cell_info->view));
@@ -4185,7 +4217,8 @@ cell_info_new (GailTreeView      *gailview,
   cell_info->cell = cell;
   cell_info->in_use = TRUE; /* if we've created it, assume it's in use */
   cell_info->view = gailview;
-  gailview->cell_data = g_list_append (gailview->cell_data, cell_info);
+  gailview->cell_data = g_list_prepend (gailview->cell_data, cell_info);
+  cell_info_index_add (gailview, cell_info);
       
   /* Setup weak reference notification */
 
@@ -4199,37 +4232,149 @@ find_cell (GailTreeView *gailview,
            gint         index)
 {
   GailTreeViewCellInfo *info;
+  GailTreeViewCellKey key;
   GtkTreeView *tree_view;
-  GList *cell_list;
   GList *l;
-  gint real_index;
-  gboolean needs_cleaning = FALSE;
-  GailCell *retval = NULL;
+  GtkTreePath *path;
+  GtkTreeViewColumn *tv_col;
+
+  if (gailview->cell_data == NULL)
+    return NULL;
 
   tree_view = GTK_TREE_VIEW (GTK_ACCESSIBLE (gailview)->widget);
-  cell_list = gailview->cell_data;
+  if (!get_path_column_from_index (tree_view, index, &path, &tv_col))
+    return NULL;
 
-  for (l = cell_list; l; l = l->next)
+  if (gailview->cell_positions == NULL)
     {
-      info = (GailTreeViewCellInfo *) (l->data);
-      if (info->in_use)
-      {
-	  cell_info_get_index (tree_view, info, &real_index);
-	  if (index == real_index)
-	  {
-	      retval =  info->cell;
-	      break;
-	  }
-      }
-      else
-      {
-	  needs_cleaning = TRUE;
-      }
+      gailview->cell_positions = g_hash_table_new_full (cell_key_hash,
+                                                        cell_key_equal,
+                                                        cell_key_free,
+                                                        NULL);
+     /*
+      * cell_data is kept newest first; walk it from the oldest entry so
+      * that a container cell, which is created before its children,
+      * claims its position.
+      */
+      for (l = g_list_last (gailview->cell_data); l; l = l->prev)
+        {
+          info = (GailTreeViewCellInfo *) (l->data);
+          if (info->in_use)
+            cell_info_index_add (gailview, info);
+        }
     }
-  if (needs_cleaning)
-     garbage_collect_cell_data (gailview);
 
-  return retval;
+  key.path = path;
+  key.column = tv_col;
+  info = g_hash_table_lookup (gailview->cell_positions, &key);
+  gtk_tree_path_free (path);
+
+  return info ? info->cell : NULL;
+}
+
+static guint
+cell_key_hash (gconstpointer v)
+{
+  const GailTreeViewCellKey *key = v;
+  gint *indices;
+  gint depth, i;
+  guint hash;
+
+  hash = g_direct_hash (key->column);
+  indices = gtk_tree_path_get_indices (key->path);
+  depth = gtk_tree_path_get_depth (key->path);
+  for (i = 0; i < depth; i++)
+    hash = (hash << 5) - hash + indices[i];
+
+  return hash;
+}
+
+static gboolean
+cell_key_equal (gconstpointer a,
+                gconstpointer b)
+{
+  const GailTreeViewCellKey *key_a = a;
+  const GailTreeViewCellKey *key_b = b;
+
+  return key_a->column == key_b->column &&
+         gtk_tree_path_compare (key_a->path, key_b->path) == 0;
+}
+
+static void
+cell_key_free (gpointer data)
+{
+  GailTreeViewCellKey *key = data;
+
+  gtk_tree_path_free (key->path);
+  g_free (key);
+}
+
+/*
+ * Record a live cell in the lookup tables.  The cell_positions table
+ * is only maintained while it exists; it is built on demand by
+ * find_cell().  The first cell registered for a position keeps it.
+ */
+static void
+cell_info_index_add (GailTreeView         *view,
+                     GailTreeViewCellInfo *cell_info)
+{
+  GailTreeViewCellKey *key;
+  GtkTreePath *path;
+
+  if (!g_hash_table_lookup (view->cell_infos, cell_info->cell))
+    g_hash_table_insert (view->cell_infos, cell_info->cell, cell_info);
+
+  if (view->cell_positions == NULL)
+    return;
+
+  path = gtk_tree_row_reference_get_path (cell_info->cell_row_ref);
+  if (path == NULL)
+    return;
+
+  key = g_new (GailTreeViewCellKey, 1);
+  key->path = path;
+  key->column = cell_info->cell_col_ref;
+  if (g_hash_table_lookup (view->cell_positions, key))
+    cell_key_free (key);
+  else
+    g_hash_table_insert (view->cell_positions, key, cell_info);
+}
+
+static void
+cell_info_index_remove (GailTreeView         *view,
+                        GailTreeViewCellInfo *cell_info)
+{
+  GailTreeViewCellKey key;
+
+  if (view->cell_infos &&
+      g_hash_table_lookup (view->cell_infos, cell_info->cell) == cell_info)
+    g_hash_table_remove (view->cell_infos, cell_info->cell);
+
+  if (view->cell_positions == NULL)
+    return;
+
+  key.path = gtk_tree_row_reference_get_path (cell_info->cell_row_ref);
+  if (key.path == NULL)
+    return;
+  key.column = cell_info->cell_col_ref;
+
+  /*
+   * Another live cell (e.g. the child of a container cell) may share
+   * the position, so let find_cell() rebuild the table.
+   */
+  if (g_hash_table_lookup (view->cell_positions, &key) == cell_info)
+    cell_info_index_invalidate (view);
+  gtk_tree_path_free (key.path);
+}
+
+static void
+cell_info_index_invalidate (GailTreeView *view)
+{
+  if (view->cell_positions)
+    {
+      g_hash_table_destroy (view->cell_positions);
+      view->cell_positions = NULL;
+    }
 }
 
 static void
@@ -4334,6 +4479,7 @@ clear_cached_data (GailTreeView  *view)
       g_list_free (view->cell_data);
   
   view->cell_data = NULL;
+  cell_info_index_invalidate (view);
 }
 
 /*
@@ -4689,6 +4835,9 @@ find_cell_info (GailTreeView *view,
   GList *temp_list;
   GailTreeViewCellInfo *cell_info;
 
+  if (live_only && list == NULL)
+    return g_hash_table_lookup (view->cell_infos, cell);
+
   for (temp_list = view->cell_data; temp_list; temp_list = temp_list->next)
     {
       cell_info = (GailTreeViewCellInfo *) temp_list->data;
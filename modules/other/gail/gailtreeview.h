@@ -46,6 +46,8 @@ struct _GailTreeView
   GArray*       col_data;
   GArray*	row_data;
   GList*        cell_data;
+  GHashTable    *cell_infos;
+  GHashTable    *cell_positions;
   GtkTreeModel  *tree_model;
   AtkObject     *focus_cell;
   GtkAdjustment *old_hadj;
@@ -1332,3 +1332,63 @@ gtk_cups_connection_test_free (GtkCupsConnectionTest *test)
 #endif
   g_free (test);
 }
+
+#ifdef HAVE_CUPS_API_1_2
+/* Goes through the events of a Get-Notifications response. Each
+ * event is a group of its own; job events with a state are passed
+ * to job_func. sequence_number is moved past the last event, so
+ * the next request only gets newer ones.
+ *
+ * Returns TRUE if there was a printer event.
+ */
+gboolean
+gtk_cups_parse_notifications (ipp_t               *response,
+                              gint                *sequence_number,
+                              GtkCupsJobEventFunc  job_func,
+                              gpointer             user_data)
+{
+  ipp_attribute_t *attr;
+  gboolean printers_changed;
+  gint job_id, job_state;
+
+  printers_changed = FALSE;
+  job_id = 0;
+  job_state = 0;
+  for (attr = response->attrs; ; attr = attr->next)
+    {
+      if (attr == NULL || attr->name == NULL)
+        {
+          if (job_id != 0 && job_state != 0)
+            job_func (job_id, job_state, user_data);
+
+          job_id = 0;
+          job_state = 0;
+
+          if (attr == NULL)
+            break;
+
+          continue;
+        }
+
+      if (attr->group_tag != IPP_TAG_EVENT_NOTIFICATION)
+        continue;
+
+      if (!g_ascii_strcasecmp (attr->name, "notify-sequence-number"))
+        {
+          if (attr->values[0].integer >= *sequence_number)
+            *sequence_number = attr->values[0].integer + 1;
+        }
+      else if (!g_ascii_strcasecmp (attr->name, "notify-subscribed-event"))
+        {
+          if (g_str_has_prefix (attr->values[0].string.text, "printer-"))
+            printers_changed = TRUE;
+        }
+      else if (!g_ascii_strcasecmp (attr->name, "job-id"))
+        job_id = attr->values[0].integer;
+      else if (!g_ascii_strcasecmp (attr->name, "job-state"))
+        job_state = attr->values[0].integer;
+    }
+
+  return printers_changed;
+}
+#endif
@@ -66,6 +66,10 @@ typedef enum
   GTK_CUPS_CONNECTION_IN_PROGRESS  
 } GtkCupsConnectionState;
 
+typedef void (* GtkCupsJobEventFunc) (gint     job_id,
+                                      gint     job_state,
+                                      gpointer user_data);
+
 struct _GtkCupsRequest 
 {
   GtkCupsRequestType type;
@@ -158,6 +162,12 @@ const char            * gtk_cups_result_get_error_string   (GtkCupsResult      *
 GtkCupsConnectionTest * gtk_cups_connection_test_new       (const char            *server);
 GtkCupsConnectionState  gtk_cups_connection_test_get_state (GtkCupsConnectionTest *test);
 void                    gtk_cups_connection_test_free      (GtkCupsConnectionTest *test);
+#ifdef HAVE_CUPS_API_1_2
+gboolean                gtk_cups_parse_notifications       (ipp_t                 *response,
+							    gint                  *sequence_number,
+							    GtkCupsJobEventFunc    job_func,
+							    gpointer               user_data);
+#endif
 
 G_END_DECLS
 #endif 
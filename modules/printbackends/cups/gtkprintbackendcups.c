@@ -25,6 +25,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <stdlib.h>
+#include <time.h>
 
 #include <cups/cups.h>
 #include <cups/language.h>
@@ -59,6 +60,15 @@ typedef struct _GtkPrintBackendCupsClass GtkPrintBackendCupsClass;
 #define _CUPS_MAX_ATTEMPTS 10 
 #define _CUPS_MAX_CHUNK_SIZE 8192
 
+/* Seconds a printer list stays valid while the subscription
+ * reports no changes, and lease of the subscription itself.
+ * Each backend has its own subscription, which is renewed while
+ * it is polled; a short lease keeps the server from holding on
+ * to the subscriptions of processes that went away.
+ */
+#define PRINTER_LIST_TTL 30
+#define SUBSCRIPTION_LEASE_DURATION 60
+
 /* define this to see warnings about ignored ppd options */
 #undef PRINT_IGNORED_OPTIONS
 
@@ -109,6 +119,17 @@ struct _GtkPrintBackendCups
   guint default_printer_poll;
   GtkCupsConnectionTest *cups_connection_test;
 
+  time_t printer_list_time;
+
+  /* Server side subscription to printer and job events */
+  gint subscription_id;
+  gint notify_sequence_number;
+  time_t subscription_time;
+  guint subscription_pending : 1;
+  guint subscription_failed  : 1;
+  GList *notified_jobs;
+  guint notify_poll;
+
   char **covers;
   char  *default_cover_before;
   char  *default_cover_after;
@@ -146,6 +167,7 @@ static GList *              cups_printer_list_papers               (GtkPrinter
 static GtkPageSetup *       cups_printer_get_default_page_size     (GtkPrinter                        *printer);
 static void                 cups_printer_request_details           (GtkPrinter                        *printer);
 static gboolean             cups_request_default_printer           (GtkPrintBackendCups               *print_backend);
+static gboolean             cups_request_printer_list              (GtkPrintBackendCups               *print_backend);
 static void                 cups_request_ppd                       (GtkPrinter                        *printer);
 static void                 cups_printer_get_hard_margins          (GtkPrinter                        *printer,
 								    double                            *top,
@@ -159,6 +181,14 @@ static void                 cups_begin_polling_info                (GtkPrintBack
 								    GtkPrintJob                       *job,
 								    int                                job_id);
 static gboolean             cups_job_info_poll_timeout             (gpointer                           user_data);
+static void                 cups_job_poll_data_free                (gpointer                           data);
+#ifdef HAVE_CUPS_API_1_2
+static void                 cups_cancel_subscription               (GtkPrintBackendCups               *print_backend);
+static void                 cups_cancel_subscription_sync          (GtkPrintBackendCups               *print_backend);
+static void                 cups_request_notified_job_info         (GtkPrintBackendCups               *print_backend,
+								    gint                               job_id);
+static void                 cups_start_notify_poll                 (GtkPrintBackendCups               *print_backend);
+#endif
 static void                 gtk_print_backend_cups_print_stream    (GtkPrintBackend                   *backend,
 								    GtkPrintJob                       *job,
 								    GIOChannel                        *data_io,
@@ -541,6 +571,14 @@ gtk_print_backend_cups_finalize (GObject *object)
   gtk_cups_connection_test_free (backend_cups->cups_connection_test);
   backend_cups->cups_connection_test = NULL;
 
+#ifdef HAVE_CUPS_API_1_2
+  /* Dispose cancels the subscription; should one still be around,
+   * don't leave it to the lease, even if the request has to block
+   */
+  if (backend_cups->subscription_id != 0)
+    cups_cancel_subscription_sync (backend_cups);
+#endif
+
   backend_parent_class->finalize (object);
 }
 
@@ -562,6 +600,10 @@ gtk_print_backend_cups_dispose (GObject *object)
     g_source_remove (backend_cups->default_printer_poll);
   backend_cups->default_printer_poll = 0;
 
+#ifdef HAVE_CUPS_API_1_2
+  cups_cancel_subscription (backend_cups);
+#endif
+
   backend_parent_class->dispose (object);
 }
 
@@ -874,14 +916,43 @@ job_object_died	(gpointer  user_data,
 }
 
 static void
-cups_job_poll_data_free (CupsJobPollData *data)
+cups_job_poll_data_free (gpointer user_data)
 {
+  CupsJobPollData *data = user_data;
+
   if (data->job)
     g_object_weak_unref (G_OBJECT (data->job), job_object_died, data);
     
   g_free (data);
 }
 
+/* Returns TRUE if the job is done */
+static gboolean
+cups_job_set_status_from_state (GtkPrintJob *job,
+                                gint         state)
+{
+  switch (state)
+    {
+    case IPP_JOB_PENDING:
+    case IPP_JOB_HELD:
+    case IPP_JOB_STOPPED:
+      gtk_print_job_set_status (job, GTK_PRINT_STATUS_PENDING);
+      return FALSE;
+    case IPP_JOB_PROCESSING:
+      gtk_print_job_set_status (job, GTK_PRINT_STATUS_PRINTING);
+      return FALSE;
+    default:
+    case IPP_JOB_CANCELLED:
+    case IPP_JOB_ABORTED:
+      gtk_print_job_set_status (job, GTK_PRINT_STATUS_FINISHED_ABORTED);
+      return TRUE;
+    case 0:
+    case IPP_JOB_COMPLETED:
+      gtk_print_job_set_status (job, GTK_PRINT_STATUS_FINISHED);
+      return TRUE;
+    }
+}
+
 static void
 cups_request_job_info_cb (GtkPrintBackendCups *print_backend,
 			  GtkCupsResult       *result,
@@ -914,33 +985,7 @@ cups_request_job_info_cb (GtkPrintBackendCups *print_backend,
       _CUPS_MAP_ATTR_INT (attr, state, "job-state");
     }
   
-  done = FALSE;
-  switch (state)
-    {
-    case IPP_JOB_PENDING:
-    case IPP_JOB_HELD:
-    case IPP_JOB_STOPPED:
-      gtk_print_job_set_status (data->job,
-				GTK_PRINT_STATUS_PENDING);
-      break;
-    case IPP_JOB_PROCESSING:
-      gtk_print_job_set_status (data->job,
-				GTK_PRINT_STATUS_PRINTING);
-      break;
-    default:
-    case IPP_JOB_CANCELLED:
-    case IPP_JOB_ABORTED:
-      gtk_print_job_set_status (data->job,
-				GTK_PRINT_STATUS_FINISHED_ABORTED);
-      done = TRUE;
-      break;
-    case 0:
-    case IPP_JOB_COMPLETED:
-      gtk_print_job_set_status (data->job,
-				GTK_PRINT_STATUS_FINISHED);
-      done = TRUE;
-      break;
-    }
+  done = cups_job_set_status_from_state (data->job, state);
 
   if (!done && data->job != NULL)
     {
@@ -1016,9 +1061,530 @@ cups_begin_polling_info (GtkPrintBackendCups *print_backend,
 
   g_object_weak_ref (G_OBJECT (job), job_object_died, data);
 
+#ifdef HAVE_CUPS_API_1_2
+  /* While there is a subscription, the job state changes come in
+   * with the other events. The events sent before the job got here
+   * may already have been fetched, so ask for the state once.
+   */
+  if (print_backend->subscription_id != 0)
+    {
+      print_backend->notified_jobs = g_list_prepend (print_backend->notified_jobs, data);
+      cups_request_notified_job_info (print_backend, job_id);
+      cups_start_notify_poll (print_backend);
+      return;
+    }
+#endif
+
   cups_request_job_info (data);
 }
 
+#ifdef HAVE_CUPS_API_1_2
+static const char * const subscription_events[] =
+  {
+    "printer-added",
+    "printer-deleted",
+    "printer-modified",
+    "printer-state-changed",
+    "printer-config-changed",
+    "job-state-changed",
+    "job-completed"
+  };
+
+/* Builds an ipp URI for resource on the server the requests go to */
+static void
+cups_get_server_uri (gchar       *uri,
+                     gsize        size,
+                     const gchar *resource)
+{
+  const gchar *server;
+
+  server = cupsServer ();
+
+  /* A domain socket is reached as localhost */
+  if (server == NULL || server[0] == '/')
+    server = "localhost";
+
+  httpAssembleURIf (HTTP_URI_CODING_ALL,
+                    uri,
+                    size,
+                    "ipp",
+                    NULL,
+                    server,
+                    ippPort (),
+                    "%s",
+                    resource);
+}
+
+/* Events may have been lost; go back to polling the jobs
+ * we followed through the subscription, and to getting the
+ * whole printer list.
+ */
+static void
+cups_drop_subscription (GtkPrintBackendCups *print_backend)
+{
+  GList *l;
+
+  print_backend->subscription_id = 0;
+  print_backend->printer_list_time = 0;
+
+  for (l = print_backend->notified_jobs; l != NULL; l = l->next)
+    {
+      CupsJobPollData *data = l->data;
+
+      if (data->job == NULL)
+        cups_job_poll_data_free (data);
+      else
+        cups_request_job_info (data);
+    }
+
+  g_list_free (print_backend->notified_jobs);
+  print_backend->notified_jobs = NULL;
+}
+
+static void
+cups_create_subscription_cb (GtkPrintBackendCups *print_backend,
+                             GtkCupsResult       *result,
+                             gpointer             user_data)
+{
+  ipp_attribute_t *attr;
+  ipp_t *response;
+
+  GDK_THREADS_ENTER ();
+
+  print_backend->subscription_pending = FALSE;
+
+  if (gtk_cups_result_is_error (result))
+    {
+      GTK_NOTE (PRINTING,
+                g_warning ("CUPS Backend: Error creating subscription: %s",
+                           gtk_cups_result_get_error_string (result)));
+      goto done;
+    }
+
+  response = gtk_cups_result_get_response (result);
+  attr = ippFindAttribute (response, "notify-subscription-id", IPP_TAG_INTEGER);
+
+  if (response->request.status.status_code <= IPP_OK_CONFLICT && attr != NULL)
+    {
+      print_backend->subscription_id = attr->values[0].integer;
+
+      /* The backend went away in the meantime */
+      if (print_backend->subscription_failed)
+        {
+          cups_cancel_subscription (print_backend);
+          goto done;
+        }
+
+      print_backend->subscription_time = time (NULL);
+      print_backend->notify_sequence_number = 1;
+    }
+  else
+    {
+      /* The server doesn't allow subscriptions, keep polling */
+      print_backend->subscription_failed = TRUE;
+    }
+
+done:
+  GDK_THREADS_LEAVE ();
+}
+
+static void
+cups_create_subscription (GtkPrintBackendCups *print_backend)
+{
+  GtkCupsRequest *request;
+  gchar uri[HTTP_MAX_URI];
+
+  print_backend->subscription_pending = TRUE;
+
+  request = gtk_cups_request_new (NULL,
+                                  GTK_CUPS_POST,
+                                  IPP_CREATE_PRINTER_SUBSCRIPTION,
+                                  NULL,
+                                  NULL,
+                                  NULL);
+
+  cups_get_server_uri (uri, sizeof (uri), "/");
+  gtk_cups_request_ipp_add_string (request, IPP_TAG_OPERATION, IPP_TAG_URI,
+                                   "printer-uri", NULL, uri);
+  gtk_cups_request_ipp_add_strings (request, IPP_TAG_SUBSCRIPTION, IPP_TAG_KEYWORD,
+                                    "notify-events", G_N_ELEMENTS (subscription_events),
+                                    NULL, subscription_events);
+  gtk_cups_request_ipp_add_string (request, IPP_TAG_SUBSCRIPTION, IPP_TAG_KEYWORD,
+                                   "notify-pull-method", NULL, "ippget");
+  ippAddInteger (request->ipp_request, IPP_TAG_SUBSCRIPTION, IPP_TAG_INTEGER,
+                 "notify-lease-duration", SUBSCRIPTION_LEASE_DURATION);
+
+  cups_request_execute (print_backend,
+                        request,
+                        (GtkPrintCupsResponseCallbackFunc) cups_create_subscription_cb,
+                        NULL,
+                        NULL);
+}
+
+static void
+cups_renew_subscription_cb (GtkPrintBackendCups *print_backend,
+                            GtkCupsResult       *result,
+                            gpointer             user_data)
+{
+  GDK_THREADS_ENTER ();
+
+  print_backend->subscription_pending = FALSE;
+
+  if (gtk_cups_result_is_error (result) ||
+      gtk_cups_result_get_response (result)->request.status.status_code > IPP_OK_CONFLICT)
+    cups_drop_subscription (print_backend);
+  else
+    print_backend->subscription_time = time (NULL);
+
+  GDK_THREADS_LEAVE ();
+}
+
+static void
+cups_renew_subscription (GtkPrintBackendCups *print_backend)
+{
+  GtkCupsRequest *request;
+  gchar uri[HTTP_MAX_URI];
+
+  print_backend->subscription_pending = TRUE;
+
+  request = gtk_cups_request_new (NULL,
+                                  GTK_CUPS_POST,
+                                  IPP_RENEW_SUBSCRIPTION,
+                                  NULL,
+                                  NULL,
+                                  NULL);
+
+  cups_get_server_uri (uri, sizeof (uri), "/");
+  gtk_cups_request_ipp_add_string (request, IPP_TAG_OPERATION, IPP_TAG_URI,
+                                   "printer-uri", NULL, uri);
+  ippAddInteger (request->ipp_request, IPP_TAG_OPERATION, IPP_TAG_INTEGER,
+                 "notify-subscription-id", print_backend->subscription_id);
+  ippAddInteger (request->ipp_request, IPP_TAG_SUBSCRIPTION, IPP_TAG_INTEGER,
+                 "notify-lease-duration", SUBSCRIPTION_LEASE_DURATION);
+
+  cups_request_execute (print_backend,
+                        request,
+                        (GtkPrintCupsResponseCallbackFunc) cups_renew_subscription_cb,
+                        NULL,
+                        NULL);
+}
+
+static void
+cups_check_subscription_lease (GtkPrintBackendCups *print_backend)
+{
+  if (!print_backend->subscription_pending &&
+      time (NULL) - print_backend->subscription_time > SUBSCRIPTION_LEASE_DURATION / 2)
+    cups_renew_subscription (print_backend);
+}
+
+static void
+cups_update_notified_job (GtkPrintBackendCups *print_backend,
+                          gint                 job_id,
+                          gint                 state)
+{
+  GList *l, *next;
+
+  for (l = print_backend->notified_jobs; l != NULL; l = next)
+    {
+      CupsJobPollData *data = l->data;
+
+      next = l->next;
+
+      if (data->job != NULL &&
+          (data->job_id != job_id ||
+           !cups_job_set_status_from_state (data->job, state)))
+        continue;
+
+      print_backend->notified_jobs = g_list_delete_link (print_backend->notified_jobs, l);
+      cups_job_poll_data_free (data);
+    }
+}
+
+static void
+cups_notified_job_event (gint     job_id,
+                         gint     job_state,
+                         gpointer user_data)
+{
+  cups_update_notified_job (GTK_PRINT_BACKEND_CUPS (user_data), job_id, job_state);
+}
+
+static void
+cups_request_notifications_cb (GtkPrintBackendCups *print_backend,
+                               GtkCupsResult       *result,
+                               gpointer             user_data)
+{
+  ipp_t *response;
+  gboolean printers_changed;
+
+  GDK_THREADS_ENTER ();
+
+  print_backend->list_printers_pending = FALSE;
+
+  if (gtk_cups_result_is_error (result))
+    {
+      GTK_NOTE (PRINTING,
+                g_warning ("CUPS Backend: Error getting notifications: %s",
+                           gtk_cups_result_get_error_string (result)));
+      goto done;
+    }
+
+  response = gtk_cups_result_get_response (result);
+
+  if (response->request.status.status_code > IPP_OK_CONFLICT)
+    {
+      /* Most likely the subscription expired */
+      cups_drop_subscription (print_backend);
+      goto done;
+    }
+
+  printers_changed = gtk_cups_parse_notifications (response,
+                                                   &print_backend->notify_sequence_number,
+                                                   cups_notified_job_event,
+                                                   print_backend);
+
+  if (printers_changed)
+    {
+      print_backend->printer_list_time = 0;
+      if (print_backend->list_printers_poll != 0)
+        cups_request_printer_list (print_backend);
+    }
+
+done:
+  GDK_THREADS_LEAVE ();
+}
+
+static void
+cups_request_notifications (GtkPrintBackendCups *print_backend)
+{
+  GtkCupsRequest *request;
+  gchar uri[HTTP_MAX_URI];
+
+  print_backend->list_printers_pending = TRUE;
+
+  request = gtk_cups_request_new (NULL,
+                                  GTK_CUPS_POST,
+                                  IPP_GET_NOTIFICATIONS,
+                                  NULL,
+                                  NULL,
+                                  NULL);
+
+  cups_get_server_uri (uri, sizeof (uri), "/");
+  gtk_cups_request_ipp_add_string (request, IPP_TAG_OPERATION, IPP_TAG_URI,
+                                   "printer-uri", NULL, uri);
+  ippAddInteger (request->ipp_request, IPP_TAG_OPERATION, IPP_TAG_INTEGER,
+                 "notify-subscription-ids", print_backend->subscription_id);
+  ippAddInteger (request->ipp_request, IPP_TAG_OPERATION, IPP_TAG_INTEGER,
+                 "notify-sequence-numbers", print_backend->notify_sequence_number);
+
+  cups_request_execute (print_backend,
+                        request,
+                        (GtkPrintCupsResponseCallbackFunc) cups_request_notifications_cb,
+                        NULL,
+                        NULL);
+}
+
+static void
+cups_request_notified_job_info_cb (GtkPrintBackendCups *print_backend,
+                                   GtkCupsResult       *result,
+                                   gpointer             user_data)
+{
+  ipp_attribute_t *attr;
+  ipp_t *response;
+  gint state;
+
+  GDK_THREADS_ENTER ();
+
+  /* The events will tell */
+  if (gtk_cups_result_is_error (result))
+    goto done;
+
+  response = gtk_cups_result_get_response (result);
+
+  state = 0;
+  for (attr = response->attrs; attr != NULL; attr = attr->next)
+    {
+      if (!attr->name)
+        continue;
+
+      _CUPS_MAP_ATTR_INT (attr, state, "job-state");
+    }
+
+  /* Like cups_request_job_info_cb(), a job the server
+   * doesn't know anymore is done
+   */
+  cups_update_notified_job (print_backend, GPOINTER_TO_INT (user_data), state);
+
+done:
+  GDK_THREADS_LEAVE ();
+}
+
+static void
+cups_request_notified_job_info (GtkPrintBackendCups *print_backend,
+                                gint                 job_id)
+{
+  GtkCupsRequest *request;
+  gchar *resource;
+  gchar uri[HTTP_MAX_URI];
+
+  request = gtk_cups_request_new (NULL,
+                                  GTK_CUPS_POST,
+                                  IPP_GET_JOB_ATTRIBUTES,
+                                  NULL,
+                                  NULL,
+                                  NULL);
+
+  resource = g_strdup_printf ("/jobs/%d", job_id);
+  cups_get_server_uri (uri, sizeof (uri), resource);
+  g_free (resource);
+
+  gtk_cups_request_ipp_add_string (request, IPP_TAG_OPERATION, IPP_TAG_URI,
+                                   "job-uri", NULL, uri);
+
+  cups_request_execute (print_backend,
+                        request,
+                        (GtkPrintCupsResponseCallbackFunc) cups_request_notified_job_info_cb,
+                        GINT_TO_POINTER (job_id),
+                        NULL);
+}
+
+static gboolean
+cups_notify_poll_timeout (gpointer user_data)
+{
+  GtkPrintBackendCups *print_backend = user_data;
+
+  if (print_backend->notified_jobs == NULL)
+    {
+      print_backend->notify_poll = 0;
+      return FALSE;
+    }
+
+  /* While the printer list is polled, that asks for the events */
+  if (print_backend->list_printers_poll == 0 &&
+      !print_backend->list_printers_pending)
+    {
+      cups_check_subscription_lease (print_backend);
+      cups_request_notifications (print_backend);
+    }
+
+  return TRUE;
+}
+
+/* Keeps the events coming while jobs wait for them, also
+ * when nobody is looking at the printer list
+ */
+static void
+cups_start_notify_poll (GtkPrintBackendCups *print_backend)
+{
+  if (print_backend->notify_poll == 0)
+    print_backend->notify_poll = gdk_threads_add_timeout_seconds (1,
+                                                                  cups_notify_poll_timeout,
+                                                                  print_backend);
+}
+
+static void
+cups_cancel_subscription_cb (GtkPrintBackendCups *print_backend,
+                             GtkCupsResult       *result,
+                             gpointer             user_data)
+{
+  if (gtk_cups_result_is_error (result))
+    GTK_NOTE (PRINTING,
+              g_warning ("CUPS Backend: Error cancelling subscription: %s",
+                         gtk_cups_result_get_error_string (result)));
+}
+
+/* Called on dispose: gives up the subscription and leaves the
+ * jobs that were still followed through it in a final state
+ */
+static void
+cups_cancel_subscription (GtkPrintBackendCups *print_backend)
+{
+  GtkCupsRequest *request;
+  gchar uri[HTTP_MAX_URI];
+  GList *l;
+
+  if (print_backend->notify_poll > 0)
+    g_source_remove (print_backend->notify_poll);
+  print_backend->notify_poll = 0;
+
+  for (l = print_backend->notified_jobs; l != NULL; l = l->next)
+    {
+      CupsJobPollData *data = l->data;
+
+      /* The server accepted the job, we can't follow it any further */
+      if (data->job != NULL)
+        gtk_print_job_set_status (data->job, GTK_PRINT_STATUS_FINISHED);
+
+      cups_job_poll_data_free (data);
+    }
+
+  g_list_free (print_backend->notified_jobs);
+  print_backend->notified_jobs = NULL;
+
+  /* Don't create a new subscription, and cancel one that is
+   * still being created once it arrives
+   */
+  print_backend->subscription_failed = TRUE;
+
+  if (print_backend->subscription_id == 0)
+    return;
+
+  request = gtk_cups_request_new (NULL,
+                                  GTK_CUPS_POST,
+                                  IPP_CANCEL_SUBSCRIPTION,
+                                  NULL,
+                                  NULL,
+                                  NULL);
+
+  cups_get_server_uri (uri, sizeof (uri), "/");
+  gtk_cups_request_ipp_add_string (request, IPP_TAG_OPERATION, IPP_TAG_URI,
+                                   "printer-uri", NULL, uri);
+  ippAddInteger (request->ipp_request, IPP_TAG_OPERATION, IPP_TAG_INTEGER,
+                 "notify-subscription-id", print_backend->subscription_id);
+
+  print_backend->subscription_id = 0;
+
+  cups_request_execute (print_backend,
+                        request,
+                        (GtkPrintCupsResponseCallbackFunc) cups_cancel_subscription_cb,
+                        NULL,
+                        NULL);
+}
+
+/* Called on finalize, where no request can be dispatched
+ * anymore since it would keep a reference on the backend
+ */
+static void
+cups_cancel_subscription_sync (GtkPrintBackendCups *print_backend)
+{
+  http_t *http;
+  ipp_t *request, *response;
+  gchar uri[HTTP_MAX_URI];
+
+  http = httpConnectEncrypt (cupsServer (), ippPort (), cupsEncryption ());
+  if (http != NULL)
+    {
+      request = ippNewRequest (IPP_CANCEL_SUBSCRIPTION);
+
+      cups_get_server_uri (uri, sizeof (uri), "/");
+      ippAddString (request, IPP_TAG_OPERATION, IPP_TAG_URI,
+                    "printer-uri", NULL, uri);
+      ippAddString (request, IPP_TAG_OPERATION, IPP_TAG_NAME,
+                    "requesting-user-name", NULL, cupsUser ());
+      ippAddInteger (request, IPP_TAG_OPERATION, IPP_TAG_INTEGER,
+                     "notify-subscription-id", print_backend->subscription_id);
+
+      /* cupsDoRequest() frees the request */
+      response = cupsDoRequest (http, request, "/");
+      if (response != NULL)
+        ippDelete (response);
+
+      httpClose (http);
+    }
+
+  print_backend->subscription_id = 0;
+}
+#endif /* HAVE_CUPS_API_1_2 */
+
 static void
 mark_printer_inactive (GtkPrinter      *printer, 
                        GtkPrintBackend *backend)
@@ -1066,6 +1632,8 @@ cups_request_printer_list_cb (GtkPrintBackendCups *cups_backend,
       goto done;
     }
   
+  cups_backend->printer_list_time = time (NULL);
+
   /* Gather the names of the printers in the current queue
    * so we may check to see if they were removed 
    */
@@ -1546,6 +2114,26 @@ cups_request_printer_list (GtkPrintBackendCups *cups_backend)
   if (state == GTK_CUPS_CONNECTION_IN_PROGRESS || state == GTK_CUPS_CONNECTION_NOT_AVAILABLE)
     return TRUE;
 
+#ifdef HAVE_CUPS_API_1_2
+  /* With a subscription, only ask for the events since the last
+   * poll and get the whole list again when a printer changed.
+   */
+  if (cups_backend->subscription_id != 0)
+    {
+      cups_check_subscription_lease (cups_backend);
+
+      if (cups_backend->printer_list_time != 0 &&
+          time (NULL) - cups_backend->printer_list_time < PRINTER_LIST_TTL)
+        {
+          cups_request_notifications (cups_backend);
+          return TRUE;
+        }
+    }
+  else if (!cups_backend->subscription_pending &&
+           !cups_backend->subscription_failed)
+    cups_create_subscription (cups_backend);
+#endif
+
   cups_backend->list_printers_pending = TRUE;
 
   request = gtk_cups_request_new (NULL,
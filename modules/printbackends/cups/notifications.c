@@ -0,0 +1,190 @@
+/* Tests for parsing the CUPS subscription events.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "config.h"
+#include <gtk/gtk.h>
+#include "gtkcupsutils.h"
+
+#ifdef HAVE_CUPS_API_1_2
+
+typedef struct
+{
+  gint job_id;
+  gint job_state;
+} JobEvent;
+
+static void
+record_job_event (gint     job_id,
+                  gint     job_state,
+                  gpointer user_data)
+{
+  GArray *events = user_data;
+  JobEvent event;
+
+  event.job_id = job_id;
+  event.job_state = job_state;
+  g_array_append_val (events, event);
+}
+
+/* Builds a Get-Notifications response the way ippRead() would,
+ * starting with the operation attributes
+ */
+static ipp_t *
+new_response (void)
+{
+  ipp_t *response;
+
+  response = ippNew ();
+  ippAddString (response, IPP_TAG_OPERATION, IPP_TAG_CHARSET,
+                "attributes-charset", NULL, "utf-8");
+  ippAddInteger (response, IPP_TAG_OPERATION, IPP_TAG_INTEGER,
+                 "job-id", 99);
+
+  return response;
+}
+
+static void
+add_event (ipp_t       *response,
+           gint         sequence_number,
+           const gchar *event,
+           gint         job_id,
+           gint         job_state)
+{
+  ippAddSeparator (response);
+  ippAddInteger (response, IPP_TAG_EVENT_NOTIFICATION, IPP_TAG_INTEGER,
+                 "notify-sequence-number", sequence_number);
+  ippAddString (response, IPP_TAG_EVENT_NOTIFICATION, IPP_TAG_KEYWORD,
+                "notify-subscribed-event", NULL, event);
+  if (job_id != 0)
+    ippAddInteger (response, IPP_TAG_EVENT_NOTIFICATION, IPP_TAG_INTEGER,
+                   "job-id", job_id);
+  if (job_state != 0)
+    ippAddInteger (response, IPP_TAG_EVENT_NOTIFICATION, IPP_TAG_ENUM,
+                   "job-state", job_state);
+}
+
+static void
+test_job_events (void)
+{
+  ipp_t *response;
+  GArray *events;
+  JobEvent *event;
+  gint sequence_number;
+  gboolean printers_changed;
+
+  response = new_response ();
+  add_event (response, 3, "job-state-changed", 10, IPP_JOB_PROCESSING);
+  add_event (response, 4, "job-state-changed", 12, 0);
+  add_event (response, 5, "job-completed", 11, IPP_JOB_COMPLETED);
+
+  events = g_array_new (FALSE, FALSE, sizeof (JobEvent));
+  sequence_number = 1;
+  printers_changed = gtk_cups_parse_notifications (response, &sequence_number,
+                                                   record_job_event, events);
+
+  g_assert (!printers_changed);
+  g_assert_cmpint (sequence_number, ==, 6);
+
+  /* An event without a state says nothing about the job, and the
+   * job-id outside of the events isn't one
+   */
+  g_assert_cmpint (events->len, ==, 2);
+  event = &g_array_index (events, JobEvent, 0);
+  g_assert_cmpint (event->job_id, ==, 10);
+  g_assert_cmpint (event->job_state, ==, IPP_JOB_PROCESSING);
+  event = &g_array_index (events, JobEvent, 1);
+  g_assert_cmpint (event->job_id, ==, 11);
+  g_assert_cmpint (event->job_state, ==, IPP_JOB_COMPLETED);
+
+  g_array_free (events, TRUE);
+  ippDelete (response);
+}
+
+static void
+test_printer_events (void)
+{
+  ipp_t *response;
+  GArray *events;
+  gint sequence_number;
+  gboolean printers_changed;
+
+  response = new_response ();
+  add_event (response, 7, "printer-state-changed", 0, 0);
+
+  events = g_array_new (FALSE, FALSE, sizeof (JobEvent));
+  sequence_number = 1;
+  printers_changed = gtk_cups_parse_notifications (response, &sequence_number,
+                                                   record_job_event, events);
+
+  g_assert (printers_changed);
+  g_assert_cmpint (sequence_number, ==, 8);
+  g_assert_cmpint (events->len, ==, 0);
+
+  g_array_free (events, TRUE);
+  ippDelete (response);
+}
+
+/* Events that were fetched already don't move the sequence back */
+static void
+test_sequence_number (void)
+{
+  ipp_t *response;
+  GArray *events;
+  gint sequence_number;
+
+  response = new_response ();
+  add_event (response, 3, "job-state-changed", 10, IPP_JOB_PROCESSING);
+
+  events = g_array_new (FALSE, FALSE, sizeof (JobEvent));
+  sequence_number = 10;
+  gtk_cups_parse_notifications (response, &sequence_number,
+                                record_job_event, events);
+
+  g_assert_cmpint (sequence_number, ==, 10);
+
+  g_array_free (events, TRUE);
+  ippDelete (response);
+
+  /* An empty response has no events at all */
+  response = new_response ();
+  events = g_array_new (FALSE, FALSE, sizeof (JobEvent));
+  g_assert (!gtk_cups_parse_notifications (response, &sequence_number,
+                                           record_job_event, events));
+  g_assert_cmpint (sequence_number, ==, 10);
+  g_assert_cmpint (events->len, ==, 0);
+
+  g_array_free (events, TRUE);
+  ippDelete (response);
+}
+
+#endif /* HAVE_CUPS_API_1_2 */
+
+int
+main (int   argc,
+      char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#ifdef HAVE_CUPS_API_1_2
+  g_test_add_func ("/cups/notifications/job-events", test_job_events);
+  g_test_add_func ("/cups/notifications/printer-events", test_printer_events);
+  g_test_add_func ("/cups/notifications/sequence-number", test_sequence_number);
+#endif
+
+  return g_test_run ();
+}
@@ -33,7 +33,12 @@
 #include <cairo-pdf.h>
 #include <cairo-ps.h>
 
+#ifdef HAVE_SYS_SENDFILE_H
+#include <sys/sendfile.h>
+#endif
+
 #include <glib/gi18n-lib.h>
+#include <glib/gstdio.h>
 
 #include "gtk/gtk.h"
 #include "gtk/gtkprinter-private.h"
@@ -47,6 +52,12 @@ typedef struct _GtkPrintBackendFileClass GtkPrintBackendFileClass;
 #define GTK_PRINT_BACKEND_FILE_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), GTK_TYPE_PRINT_BACKEND_FILE, GtkPrintBackendFileClass))
 
 #define _STREAM_MAX_CHUNK_SIZE 8192
+#define _COPY_CHUNK_SIZE (1024 * 1024)
+
+/* Name of the temporary file next to the output file that the
+ * cairo surface writes to, set as data on the job's settings
+ */
+#define SPOOL_FILE_KEY "gtk-print-backend-file-spool"
 
 static GType print_backend_file_type = 0;
 
@@ -288,6 +299,112 @@ _cairo_write (void                *closure,
   return CAIRO_STATUS_SUCCESS;
 }
 
+static cairo_status_t
+_cairo_write_fd (void                *closure,
+                 const unsigned char *data,
+                 unsigned int         length)
+{
+  gint fd = GPOINTER_TO_INT (closure);
+
+  while (length > 0) 
+    {
+      gssize written;
+
+      written = write (fd, data, length);
+      if (written < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+
+	  GTK_NOTE (PRINTING,
+                    g_print ("FILE Backend: Error writting to spool file, %s\n", g_strerror (errno)));
+
+	  return CAIRO_STATUS_WRITE_ERROR;
+	}
+
+      data += written;
+      length -= written;
+    }
+
+  return CAIRO_STATUS_SUCCESS;
+}
+
+static void
+spool_fd_close (void *data)
+{
+  close (GPOINTER_TO_INT (data));
+}
+
+static void
+spool_file_free (gpointer data)
+{
+  gchar *spool_name = data;
+
+  g_unlink (spool_name);
+  g_free (spool_name);
+}
+
+/* Creates a temporary file in the directory of the output file, so
+ * that the surface can write the job to it directly and print_stream
+ * only has to rename it.
+ */
+static gint
+create_spool_file (GtkPrintSettings  *settings,
+                   gchar            **spool_name)
+{
+  gchar *uri, *filename, *dirname, *basename;
+  struct stat st;
+  gint fd, i;
+
+  *spool_name = NULL;
+
+  uri = output_file_from_settings (settings, NULL);
+  filename = g_filename_from_uri (uri, NULL, NULL);
+  g_free (uri);
+
+  if (filename == NULL)
+    return -1;
+
+  dirname = g_path_get_dirname (filename);
+  basename = g_path_get_basename (filename);
+
+  /* g_mkstemp() would create the file readable by the owner only;
+   * opening it ourselves gives a new output file the mode from the
+   * umask, as writing it directly would.
+   */
+  fd = -1;
+  for (i = 0; i < 100 && fd < 0; i++)
+    {
+      gchar *name;
+
+      name = g_strdup_printf (".%s.%08x", basename, g_random_int ());
+      *spool_name = g_build_filename (dirname, name, NULL);
+      g_free (name);
+
+      fd = g_open (*spool_name, O_WRONLY | O_CREAT | O_EXCL, 0666);
+      if (fd < 0)
+        {
+          gint errsv = errno;
+
+          g_free (*spool_name);
+          *spool_name = NULL;
+
+          if (errsv != EEXIST)
+            break;
+        }
+    }
+
+  g_free (basename);
+  g_free (dirname);
+
+  /* A file that is replaced keeps its mode */
+  if (fd >= 0 && g_stat (filename, &st) == 0 && S_ISREG (st.st_mode))
+    fchmod (fd, st.st_mode & 07777);
+
+  g_free (filename);
+
+  return fd;
+}
 
 static cairo_surface_t *
 file_printer_create_cairo_surface (GtkPrinter       *printer,
@@ -296,15 +413,43 @@ file_printer_create_cairo_surface (GtkPrinter       *printer,
 				   gdouble           height,
 				   GIOChannel       *cache_io)
 {
+  static cairo_user_data_key_t spool_fd_key;
   cairo_surface_t *surface;
   OutputFormat format;
+  cairo_write_func_t write_func;
+  gpointer closure;
+  gchar *spool_name;
+  gint fd;
 
   format = format_from_settings (settings);
 
+  fd = create_spool_file (settings, &spool_name);
+  if (fd >= 0)
+    {
+      write_func = _cairo_write_fd;
+      closure = GINT_TO_POINTER (fd);
+    }
+  else
+    {
+      write_func = _cairo_write;
+      closure = cache_io;
+    }
+
   if (format == FORMAT_PS)
-    surface = cairo_ps_surface_create_for_stream (_cairo_write, cache_io, width, height);
+    surface = cairo_ps_surface_create_for_stream (write_func, closure, width, height);
   else
-    surface = cairo_pdf_surface_create_for_stream (_cairo_write, cache_io, width, height);
+    surface = cairo_pdf_surface_create_for_stream (write_func, closure, width, height);
+
+  if (fd >= 0)
+    {
+      if (cairo_surface_set_user_data (surface, &spool_fd_key,
+                                       GINT_TO_POINTER (fd),
+                                       spool_fd_close) != CAIRO_STATUS_SUCCESS)
+        close (fd);
+
+      g_object_set_data_full (G_OBJECT (settings), SPOOL_FILE_KEY,
+                              spool_name, spool_file_free);
+    }
 
   /* TODO: DPI from settings object? */
   cairo_surface_set_fallback_resolution (surface, 300, 300);
@@ -319,6 +464,10 @@ typedef struct {
   GIOChannel *target_io;
   gpointer user_data;
   GDestroyNotify dnotify;
+
+  GIOChannel *source_io;
+  gint source_fd;
+  GError *error;
 } _PrintStreamData;
 
 static void
@@ -333,6 +482,9 @@ file_print_cb (GtkPrintBackendFile *print_backend,
   if (ps->target_io != NULL)
     g_io_channel_unref (ps->target_io);
 
+  if (ps->source_io != NULL)
+    g_io_channel_unref (ps->source_io);
+
   if (ps->callback)
     ps->callback (ps->job, ps->user_data, error);
 
@@ -402,6 +554,110 @@ file_write (GIOChannel   *source,
   return TRUE;
 }
 
+static gboolean
+file_print_idle (gpointer user_data)
+{
+  _PrintStreamData *ps = (_PrintStreamData *) user_data;
+  GError *error = ps->error;
+
+  file_print_cb (GTK_PRINT_BACKEND_FILE (ps->backend), error, ps);
+
+  if (error != NULL)
+    {
+      GTK_NOTE (PRINTING,
+                g_print ("FILE Backend: %s\n", error->message));
+
+      g_error_free (error);
+    }
+
+  return FALSE;
+}
+
+/* Copies the spooled job to the target file outside of the
+ * main loop, with sendfile() where the kernel supports it
+ * between regular files.
+ */
+static gpointer
+file_copy_thread (gpointer user_data)
+{
+  _PrintStreamData *ps = (_PrintStreamData *) user_data;
+  gint target_fd;
+  gchar *buf;
+  gssize n;
+
+  target_fd = g_io_channel_unix_get_fd (ps->target_io);
+
+#ifdef HAVE_SYS_SENDFILE_H
+  do
+    n = sendfile (target_fd, ps->source_fd, NULL, _COPY_CHUNK_SIZE);
+  while (n > 0 || (n < 0 && errno == EINTR));
+
+  if (n == 0)
+    goto out;
+
+  if (errno != EINVAL && errno != ENOSYS)
+    {
+      gint errsv = errno;
+
+      g_set_error_literal (&ps->error, G_FILE_ERROR,
+                           g_file_error_from_errno (errsv),
+                           g_strerror (errsv));
+      goto out;
+    }
+#endif
+
+  buf = g_malloc (_COPY_CHUNK_SIZE);
+
+  while ((n = read (ps->source_fd, buf, _COPY_CHUNK_SIZE)) != 0)
+    {
+      gchar *p = buf;
+
+      if (n < 0)
+        {
+          if (errno == EINTR)
+            continue;
+          break;
+        }
+
+      while (n > 0)
+        {
+          gssize written;
+
+          written = write (target_fd, p, n);
+          if (written < 0)
+            {
+              if (errno == EINTR)
+                continue;
+              break;
+            }
+
+          p += written;
+          n -= written;
+        }
+
+      if (n > 0)
+        break;
+    }
+
+  if (n != 0)
+    {
+      gint errsv = errno;
+
+      g_set_error_literal (&ps->error, G_FILE_ERROR,
+                           g_file_error_from_errno (errsv),
+                           g_strerror (errsv));
+    }
+
+  g_free (buf);
+
+#ifdef HAVE_SYS_SENDFILE_H
+ out:
+#endif
+  g_idle_add (file_print_idle, ps);
+
+  return NULL;
+}
+
 static void
 gtk_print_backend_file_print_stream (GtkPrintBackend        *print_backend,
 				     GtkPrintJob            *job,
@@ -414,7 +670,8 @@ gtk_print_backend_file_print_stream (GtkPrintBackend        *print_backend,
   GtkPrinter *printer;
   _PrintStreamData *ps;
   GtkPrintSettings *settings;
-  gchar *uri, *filename;
+  gchar *uri, *filename, *spool_name;
+  struct stat st;
 
   printer = gtk_print_job_get_printer (job);
   settings = gtk_print_job_get_settings (job);
@@ -426,13 +683,72 @@ gtk_print_backend_file_print_stream (GtkPrintBackend        *print_backend,
   ps->job = g_object_ref (job);
   ps->backend = print_backend;
 
+  spool_name = g_object_steal_data (G_OBJECT (settings), SPOOL_FILE_KEY);
+
   internal_error = NULL;
   uri = output_file_from_settings (settings, NULL);
   filename = g_filename_from_uri (uri, NULL, &internal_error);
   g_free (uri);
 
   if (filename == NULL)
-    goto error;
+    {
+      if (spool_name != NULL)
+        spool_file_free (spool_name);
+      goto error;
+    }
+
+  /* rename() would replace a symlink or a special file instead of
+   * writing through it, so copy the spool file into those
+   */
+  if (spool_name != NULL &&
+      g_lstat (filename, &st) == 0 && !S_ISREG (st.st_mode))
+    {
+      gint fd;
+
+      fd = g_open (spool_name, O_RDONLY, 0);
+      g_unlink (spool_name);
+      g_free (spool_name);
+      spool_name = NULL;
+
+      if (fd < 0)
+        {
+          gint errsv = errno;
+
+          g_set_error_literal (&internal_error, G_FILE_ERROR,
+                               g_file_error_from_errno (errsv),
+                               g_strerror (errsv));
+          g_free (filename);
+          goto error;
+        }
+
+      ps->source_io = g_io_channel_unix_new (fd);
+      g_io_channel_set_close_on_unref (ps->source_io, TRUE);
+      g_io_channel_set_encoding (ps->source_io, NULL, NULL);
+      data_io = ps->source_io;
+    }
+
+  if (spool_name != NULL)
+    {
+      /* The surface wrote the job next to the output file already */
+      if (g_rename (spool_name, filename) < 0)
+        {
+          gint errsv = errno;
+
+          g_set_error_literal (&internal_error, G_FILE_ERROR,
+                               g_file_error_from_errno (errsv),
+                               g_strerror (errsv));
+          g_unlink (spool_name);
+        }
+
+      g_free (spool_name);
+      g_free (filename);
+
+      if (internal_error != NULL)
+        goto error;
+
+      g_idle_add (file_print_idle, ps);
+      return;
+    }
 
   ps->target_io = g_io_channel_new_file (filename, "w", &internal_error);
 
@@ -451,6 +767,14 @@ error:
       return;
     }
 
+  if (g_thread_supported ())
+    {
+      ps->source_fd = g_io_channel_unix_get_fd (data_io);
+
+      if (g_thread_create (file_copy_thread, ps, FALSE, NULL) != NULL)
+        return;
+    }
+
   g_io_add_watch (data_io, 
                   G_IO_IN | G_IO_PRI | G_IO_ERR | G_IO_HUP,
                   (GIOFunc) file_write,
@@ -23,6 +23,7 @@
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
 #include <fcntl.h>
 #include <stdlib.h>
 #include <string.h>
@@ -310,6 +311,54 @@ lpr_write (GIOChannel   *source,
 
 #define LPR_COMMAND "lpr"
 
+/* The job is done when lpr has read all of the spool file and
+ * exited, and failed if it exited with an error.
+ */
+static void
+lpr_child_watch (GPid     pid,
+                 gint     status,
+                 gpointer user_data)
+{
+  _PrintStreamData *ps = (_PrintStreamData *) user_data;
+  GError *error = NULL;
+
+  GDK_THREADS_ENTER ();
+
+  g_spawn_close_pid (pid);
+
+  if (!WIFEXITED (status))
+    error = g_error_new (gtk_print_error_quark (),
+                         GTK_PRINT_ERROR_GENERAL,
+                         _("Error printing: the print command was terminated"));
+  else if (WEXITSTATUS (status) != 0)
+    error = g_error_new (gtk_print_error_quark (),
+                         GTK_PRINT_ERROR_GENERAL,
+                         _("Error printing: the print command exited with status %d"),
+                         WEXITSTATUS (status));
+
+  if (error != NULL)
+    GTK_NOTE (PRINTING,
+              g_print ("LPR Backend: %s\n", error->message));
+
+  lpr_print_cb (GTK_PRINT_BACKEND_LPR (ps->backend), error, ps);
+
+  if (error != NULL)
+    g_error_free (error);
+
+  GDK_THREADS_LEAVE ();
+}
+
+/* Runs in the child: lpr reads the spooled job straight from
+ * the spool file instead of from a pipe we have to feed.
+ */
+static void
+lpr_child_setup (gpointer user_data)
+{
+  gint fd = GPOINTER_TO_INT (user_data);
+
+  dup2 (fd, 0);
+}
+
 static void
 gtk_print_backend_lpr_print_stream (GtkPrintBackend        *print_backend,
 				    GtkPrintJob            *job,
@@ -324,6 +373,8 @@ gtk_print_backend_lpr_print_stream (GtkPrintBackend        *print_backend,
   GtkPrintSettings *settings;
   gint argc;  
   gint in_fd;
+  gint data_fd;
+  GPid pid;
   gchar **argv = NULL;
   const char *cmd_line;
   
@@ -339,12 +390,32 @@ gtk_print_backend_lpr_print_stream (GtkPrintBackend        *print_backend,
   ps->user_data = user_data;
   ps->dnotify = dnotify;
   ps->job = g_object_ref (job);
+  ps->backend = print_backend;
   ps->in = NULL;
 
- /* spawn lpr with pipes and pipe ps file to lpr */
   if (!g_shell_parse_argv (cmd_line, &argc, &argv, &print_error))
     goto out; 
 
+  /* If the spooled job is a regular file, give it to lpr as its
+   * standard input, so the data is never copied through us.
+   */
+  data_fd = g_io_channel_unix_get_fd (data_io);
+  if (lseek (data_fd, 0, SEEK_SET) == 0)
+    {
+      if (g_spawn_async (NULL,
+                         argv,
+                         NULL,
+                         G_SPAWN_SEARCH_PATH | G_SPAWN_DO_NOT_REAP_CHILD,
+                         lpr_child_setup,
+                         GINT_TO_POINTER (data_fd),
+                         &pid,
+                         &print_error))
+        g_child_watch_add (pid, lpr_child_watch, ps);
+
+      goto out;
+    }
+
+ /* spawn lpr with pipes and pipe ps file to lpr */
   if (!g_spawn_async_with_pipes (NULL,
                                  argv,
                                  NULL,